@@ -0,0 +1,158 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#ifndef SWRI_CONSOLE_BAG_INDEX_H_
+#define SWRI_CONSOLE_BAG_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include <QStringList>
+#include <ros/time.h>
+#include <swri_console/log_decoder.h>
+
+namespace swri_console
+{
+/*
+ * Summary of the log messages in a set of bag files, built from the
+ * bags' indexes without reading any message data.
+ */
+struct BagIndex
+{
+  QStringList filenames;
+  ros::Time begin_time;
+  ros::Time end_time;
+  size_t msg_count;
+
+  // Number of messages in each of density.size() equally sized time
+  // bins between begin_time and end_time.
+  std::vector<size_t> density;
+
+  BagIndex() : msg_count(0) {}
+
+  // Estimates the number of messages between start and end from the
+  // density bins.
+  size_t estimateCount(const ros::Time &start, const ros::Time &end) const
+  {
+    if (density.empty() || end < start) {
+      return 0;
+    }
+
+    const double span = (end_time - begin_time).toSec();
+    if (span <= 0.0) {
+      return msg_count;
+    }
+
+    const double bin_size = span / density.size();
+    double count = 0.0;
+    for (size_t i = 0; i < density.size(); i++) {
+      double bin_start = i * bin_size;
+      double bin_end = bin_start + bin_size;
+      double lo = std::max(bin_start, (start - begin_time).toSec());
+      double hi = std::min(bin_end, (end - begin_time).toSec());
+      if (hi > lo) {
+        count += density[i] * (hi - lo) / bin_size;
+      }
+    }
+    return static_cast<size_t>(count + 0.5);
+  }
+};
+
+/*
+ * The part of a set of bag files to load.  The time range is used to
+ * query the bags, so messages outside of it are never read, and the
+ * filter is applied while decoding, so rejected messages are never
+ * turned into LogEntries.
+ */
+struct BagQuery
+{
+  ros::Time start;
+  ros::Time end;
+  LogDecodeFilter filter;
+
+  BagQuery() {}
+  BagQuery(const ros::Time &start, const ros::Time &end)
+    : start(start), end(end) {}
+};
+
+/*
+ * Snapshot of the progress of a bag load.
+ */
+struct BagLoadProgress
+{
+  // Messages read from the bags, including those rejected by the
+  // query's filter.
+  size_t msgs_read;
+  // Estimated number of messages in the query's time range.
+  size_t msgs_total;
+  // Messages delivered to the database.
+  size_t msgs_kept;
+  // Serialized size of the messages read.
+  uint64_t bytes_read;
+  // Seconds since the load started.
+  double elapsed;
+
+  BagLoadProgress()
+    : msgs_read(0), msgs_total(0), msgs_kept(0), bytes_read(0), elapsed(0.0) {}
+
+  double fraction() const
+  {
+    if (msgs_total == 0) {
+      return 0.0;
+    }
+    return std::min(1.0, static_cast<double>(msgs_read) / msgs_total);
+  }
+
+  double messagesPerSecond() const
+  {
+    return elapsed > 0.0 ? msgs_read / elapsed : 0.0;
+  }
+
+  double megabytesPerSecond() const
+  {
+    return elapsed > 0.0 ? bytes_read / elapsed / (1024.0 * 1024.0) : 0.0;
+  }
+
+  // Estimated seconds until the load is finished, or a negative value
+  // if there is not enough information yet.
+  double remainingSeconds() const
+  {
+    if (msgs_read == 0 || msgs_total == 0) {
+      return -1.0;
+    }
+    double rate = messagesPerSecond();
+    if (rate <= 0.0) {
+      return -1.0;
+    }
+    return (msgs_total - std::min(msgs_read, msgs_total)) / rate;
+  }
+};
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_BAG_INDEX_H_
@@ -0,0 +1,80 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_BAG_INDEX_CACHE_H_
+#define SWRI_CONSOLE_BAG_INDEX_CACHE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <QString>
+
+namespace swri_console
+{
+/*
+ * A per-message index of the log messages in a bag, which is saved
+ * in the user's cache directory the first time a bag is read in full.
+ * When the bag is opened again, its summary comes from the cache
+ * instead of a scan, and loads with a filter only read the time
+ * ranges that hold matching messages.
+ *
+ * A cache entry belongs to a bag's canonical path and is only used if
+ * the bag's size, modification time and a hash of its first block
+ * (the bag header, which points at the bag's index) are unchanged.
+ */
+struct BagIndexRecord
+{
+  // Receipt time in the bag, which the bag's own index is sorted by
+  // and rosbag::View time ranges select on.
+  uint64_t time;
+  // The message's header stamp.
+  uint64_t stamp;
+  // Index into BagMessageIndex::nodes.
+  uint16_t node;
+  uint8_t level;
+  uint8_t reserved[5];
+};
+
+struct BagMessageIndex
+{
+  std::string topic;
+  std::vector<std::string> nodes;
+  // Every log message in the bag, in receipt time order.
+  std::vector<BagIndexRecord> records;
+};
+
+// Loads the cached index of a bag.  Returns false if there is none or
+// the bag has changed since it was saved.
+bool loadBagMessageIndex(const QString &bag_filename, BagMessageIndex *index);
+
+// Saves the index of a bag to the cache.  Returns false on failure.
+bool saveBagMessageIndex(const QString &bag_filename, const BagMessageIndex &index);
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_BAG_INDEX_CACHE_H_
@@ -0,0 +1,96 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_BAG_LOAD_DIALOG_H_
+#define SWRI_CONSOLE_BAG_LOAD_DIALOG_H_
+
+#include <QDialog>
+#include <ros/time.h>
+#include <swri_console/bag_index.h>
+
+class QComboBox;
+class QDoubleSpinBox;
+class QLabel;
+class QLineEdit;
+
+namespace swri_console
+{
+class BagDensityWidget;
+class BagSource;
+
+/*
+ * BagLoadDialog summarizes the index of a bag file and lets the user
+ * choose which part of it to load.  The range can be entered as
+ * offsets from the start of the bag, or dragged out on a histogram of
+ * the message density.  The messages can also be limited to a set of
+ * nodes and a minimum severity.
+ *
+ * The dialog is meant to be shown with open() rather than exec().
+ * Rejecting it cancels the source, and it deletes itself when it is
+ * closed or when the source is destroyed.  Whoever shows it starts
+ * the load when it is accepted.
+ */
+class BagLoadDialog : public QDialog
+{
+  Q_OBJECT;
+
+ public:
+  BagLoadDialog(const BagIndex &index, BagSource *source, QWidget *parent = NULL);
+
+  BagSource* source() const { return source_; }
+
+  ros::Time startTime() const;
+  ros::Time endTime() const;
+
+  // The time range and predicates chosen by the user.
+  BagQuery query() const;
+
+ public Q_SLOTS:
+  // Sets the selected range as offsets (in seconds) from the start of
+  // the bag.
+  void setRange(double start, double end);
+
+ private Q_SLOTS:
+  void loadAll();
+  void updateSummary();
+
+ private:
+  BagIndex index_;
+  BagSource *source_;
+
+  QLabel *summary_label_;
+  BagDensityWidget *density_widget_;
+  QDoubleSpinBox *start_spin_;
+  QDoubleSpinBox *end_spin_;
+  QLineEdit *nodes_edit_;
+  QComboBox *severity_combo_;
+};  // class BagLoadDialog
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_BAG_LOAD_DIALOG_H_
@@ -0,0 +1,63 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_BAG_PROGRESS_DIALOG_H_
+#define SWRI_CONSOLE_BAG_PROGRESS_DIALOG_H_
+
+#include <QProgressDialog>
+#include <swri_console/bag_index.h>
+
+namespace swri_console
+{
+class BagSource;
+
+/*
+ * BagProgressDialog shows the progress and throughput of a bag load.
+ * Pressing cancel cancels the load.  The dialog deletes itself when
+ * the source is destroyed.
+ */
+class BagProgressDialog : public QProgressDialog
+{
+  Q_OBJECT;
+
+ public:
+  BagProgressDialog(BagSource *source, QWidget *parent = NULL);
+
+  // Formats a progress snapshot as a short, human readable summary.
+  static QString formatProgress(const BagLoadProgress &progress);
+
+ private Q_SLOTS:
+  void updateProgress(const swri_console::BagLoadProgress &progress);
+
+ private:
+  QString name_;
+};  // class BagProgressDialog
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_BAG_PROGRESS_DIALOG_H_
@@ -30,38 +30,73 @@
 #ifndef SWRI_CONSOLE_BAG_SOURCE_H_
 #define SWRI_CONSOLE_BAG_SOURCE_H_
 
+#include <vector>
+#include <QAtomicInt>
 #include <QObject>
+#include <boost/shared_ptr.hpp>
+#include <QStringList>
 #include <QThread>
 #include <rosgraph_msgs/Log.h>
+#include <swri_console/bag_index.h>
+#include <swri_console/log_database.h>
+#include <swri_console/log_source.h>
 
 namespace swri_console
 {
 class BagSourceBackend;
 
-class BagSource : public QObject
+class BagSource : public LogSource
 {
   Q_OBJECT;
 
  public:
-  BagSource(const QString &filename);
+  // Reads a set of bag files as one merged stream.  Entries from
+  // filenames[i] are tagged with sources[i].
+  BagSource(const QStringList &filenames, const std::vector<uint16_t> &sources);
   ~BagSource();
 
+  // Reads the bags' index.  Messages are not read until load() is
+  // called.
   void start();
+
+  // Starts reading the messages that match query.  Must be called
+  // after indexRead() has been emitted, and only once.
+  void load(const BagQuery &query);
   
-  const QString &filename() const { return filename_; }
+  const QStringList &filenames() const { return filenames_; }
+  QString name() const;
+
+  bool isCancelled() const { return cancelled_->fetchAndAddOrdered(0) != 0; }
+
+  // The most recent progress reported by the backend.  The backend
+  // always reports progress before it finishes a load.
+  const BagLoadProgress &lastProgress() const { return last_progress_; }
   
 
  Q_SIGNALS:
-  void finished(const QString &name, bool success, size_t msg_count, const QString &error_msg);
-  void logRead(const rosgraph_msgs::LogConstPtr &msg);
+  void indexRead(const swri_console::BagIndex &index);
+  void progress(const swri_console::BagLoadProgress &progress);
+
+  // Internal signal used to forward load() to the backend thread.
+  void loadRequested(const swri_console::BagQuery &query);
+
+ protected:
+  // Asks the backend to stop.  It may still be finishing a slice
+  // when the source finishes.
+  void halt();
 
  private Q_SLOTS:
   void handleFinished(bool success, size_t msg_count, QString error_msg);
-  void handleLogRead(const rosgraph_msgs::LogConstPtr &msg);
+  void handleBatchRead(const swri_console::LogBatchPtr &batch);
+  void handleProgress(const swri_console::BagLoadProgress &progress);
 
  private:
-  const QString filename_;  
+  const QStringList filenames_;
+  const std::vector<uint16_t> sources_;
   BagSourceBackend *backend_;
+  // Shared with the backend, which may already be deleted.
+  boost::shared_ptr<QAtomicInt> cancelled_;
+  BagLoadProgress last_progress_;
   QThread thread_;
 };  // class BagSource
 }  // namespace swri_console
@@ -30,24 +30,73 @@
 #ifndef SWRI_CONSOLE_BAG_SOURCE_BACKEND_H_
 #define SWRI_CONSOLE_BAG_SOURCE_BACKEND_H_
 
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
 #include <QObject>
+#include <QMutex>
+#include <QStringList>
+#include <boost/shared_ptr.hpp>
 #include <rosgraph_msgs/Log.h>
 #include <rosbag/bag.h>
 #include <rosbag/view.h>
+#include <swri_console/bag_index.h>
+#include <swri_console/bag_index_cache.h>
+#include <swri_console/log_database.h>
 
 namespace swri_console
 {
+/*
+ * BagSourceBackend reads the log messages from one or more bag files
+ * as a single job.
+ *
+ * When started, the backend only reads the index of each bag and
+ * reports a combined index with indexRead().  Message data is not read
+ * until load() is called.  The requested range of each bag is
+ * divided into time slices, and the slices of all bags are read
+ * concurrently on the global thread pool, each with its own
+ * rosbag::Bag.  The output of the bags is merged by stamp into a
+ * single stream, and every entry is tagged with the source id of the
+ * bag it came from.
+ *
+ * Bags with an entry in the index cache (see bag_index_cache.h) are
+ * opened without scanning them, and their slices only cover the time
+ * ranges with messages that pass the query's filter.  A load of the
+ * whole of an uncached bag records its index and saves it to the
+ * cache when it finishes.
+ */
 class BagSourceBackend : public QObject
 {
   Q_OBJECT;
   
  public:
-  BagSourceBackend(const QString &filename);
+  // filenames and sources must be the same size.  sources are the ids
+  // the entries from the corresponding bag are tagged with.
+  //
+  // Setting cancelled (from any thread) asks the backend and its
+  // workers to stop.  A running load then finishes with an error soon
+  // after; the backend does nothing while it is waiting for load().
+  //
+  // The size of every batch is added to backlog, which the source
+  // takes off as it delivers them.  Merging pauses while it is at
+  // LogSource::MAX_BACKLOG.
+  BagSourceBackend(const QStringList &filenames,
+                   const std::vector<uint16_t> &sources,
+                   const boost::shared_ptr<QAtomicInt> &cancelled,
+                   const boost::shared_ptr<QAtomicInt> &backlog);
   ~BagSourceBackend();
   
  Q_SIGNALS:
   void finished(bool success, size_t msg_count, QString error_msg);
-  void logRead(const rosgraph_msgs::LogConstPtr &msg);
+  void indexRead(const swri_console::BagIndex &index);
+  void batchRead(const swri_console::LogBatchPtr &batch);
+  void progress(const swri_console::BagLoadProgress &progress);
+
+ public Q_SLOTS:
+  void load(const swri_console::BagQuery &query);
 
  protected:
   void timerEvent(QTimerEvent *);
@@ -67,19 +116,89 @@ class BagSourceBackend : public QObject
     Result(ResultStatus status, const QString &error_msg="")
       : status(status), error_msg(error_msg) {}
   };
+
+  // A time range of a bag that is read by a worker thread.  The
+  // worker appends batches as it reads them, and the backend takes
+  // them from the front.  Access to everything but start, end,
+  // cancelled and record must hold the mutex.
+  struct Slice {
+    ros::Time start;
+    ros::Time end;
+    // Shared by all slices of a backend.  The worker stops reading
+    // when it is set.
+    boost::shared_ptr<QAtomicInt> cancelled;
+
+    QMutex mutex;
+    std::deque<LogBatchPtr> batches;
+    bool done;
+    QString error_msg;
+    size_t msgs_read;
+    uint64_t bytes_read;
+
+    // If set, the worker adds every message it reads to records, with
+    // node ids that index nodes.  The worker clears it if it can't.
+    bool record;
+    std::vector<BagIndexRecord> records;
+    std::vector<std::string> nodes;
+
+    Slice() : done(false), msgs_read(0), bytes_read(0), record(false) {}
+  };
+  typedef boost::shared_ptr<Slice> SlicePtr;
+
+  // One of the bags being read, along with its position in the merge.
+  struct BagState {
+    QString filename;
+    uint16_t source;
+    std::string topic;
+    BagIndex index;
+    // The bag's cached index, if it had one.
+    boost::shared_ptr<BagMessageIndex> cache;
+    // Whether the load reads the whole bag and records its index.
+    bool record;
+
+    std::vector<SlicePtr> slices;
+    size_t current_slice;
+    // Batches taken from the current slice that have not been merged
+    // yet.  The entry at the front of the merge is
+    // (*pending.front())[pending_pos].
+    std::deque<LogBatchPtr> pending;
+    size_t pending_pos;
+    bool done;
+
+    BagState() : source(0), record(false), current_slice(0), pending_pos(0), done(false) {}
+  };
+
+  static void readSlice(std::string filename, std::string topic,
+                        uint16_t source, LogDecodeFilter filter,
+                        SlicePtr slice);
   
   Result open();
-  Result read(size_t msgs_to_read);
-  void close();
+  Result read();
+  void planSlices(BagState &bag, const ros::Time &start, const ros::Time &end);
+  void planCachedSlices(BagState &bag, const ros::Time &start, const ros::Time &end);
+  void startSlices(BagState &bag);
+  void saveCaches();
+  bool fillBag(BagState &bag, QString *error_msg);
+  bool isCancelled() const;
+  bool isBackedUp() const;
+  void emitBatch(const LogBatchPtr &batch);
+  BagLoadProgress currentProgress() const;
   
  private:
-  const QString filename_;
   int timer_id_;
   bool opened_;
-  rosbag::Bag bag_;
-  rosbag::View *view_;
-  rosbag::View::const_iterator iter_;
+  bool loading_;
+  BagIndex index_;
+  LogDecodeFilter filter_;
+  std::vector<BagState> bags_;
   size_t msg_count_;
+
+  boost::shared_ptr<QAtomicInt> cancelled_;
+  boost::shared_ptr<QAtomicInt> backlog_;
+  // Started when load() is called.
+  QElapsedTimer load_timer_;
+  qint64 last_progress_;
+  size_t msgs_total_;
 };
 }  // namespace swri_console
 #endif  // SWRI_CONSOLE_BAG_SOURCE_BACKEND_H_
@@ -36,6 +36,7 @@
 #include <QList>
 #include <QFont>
 #include <rosgraph_msgs/Log.h>
+#include <swri_console/bag_index.h>
 #include <swri_console/log_database.h>
 #include <swri_console/ros_source.h>
 
@@ -43,7 +44,12 @@ namespace swri_console
 {
 typedef std::vector<rosgraph_msgs::LogConstPtr> MessageList;
 
+class BagSource;
 class ConsoleWindow;
+class LogServerSource;
+class RemoteRosSource;
+class SyslogSource;
+class TextLogTailSource;
 class ConsoleMaster : public QObject
 {
   Q_OBJECT;
@@ -52,16 +58,77 @@ class ConsoleMaster : public QObject
   ConsoleMaster();
   virtual ~ConsoleMaster();
 
+  // Starts following the ROS master.  This is not needed when the
+  // console attaches to a recorder instead.
+  void startRosSource();
+
  public Q_SLOTS:
   void createNewWindow();
   void fontSelectionChanged(const QFont &font);
   void selectFont();
-  void readBagFile(const QString &name);
+  // Reads log files.  Bag files are read together as one job, and
+  // session files (*.swrilog) and text logs (*.log) are read
+  // individually.  If choose_query is set, the user picks the time
+  // range, nodes and severity of the bags to load (see
+  // BagLoadDialog); otherwise that is only offered for large bags.
+  void readBagFiles(const QStringList &filenames, bool choose_query = false);
+  void readSessionFile(const QString &filename);
+  void readTextLogFile(const QString &filename);
+  // Follows the text logs in a directory as they are written.
+  void followLogDirectory(const QString &directory);
+  // Follows the logs of additional ROS masters.  Their node names are
+  // prefixed with "label:".  The list is saved in the settings and
+  // restored on startup.
+  void addRosMaster(const QString &label, const QString &master_uri);
+  void removeRosMaster(const QString &label);
+  // Takes the live logs from a headless recorder (see
+  // headless_recorder.h) instead of following the ROS master.  The
+  // recorder is detached like an additional master, with
+  // removeRosMaster().
+  void attachToRecorder(const QString &server_name);
+  // Receives syslog messages over UDP on address ("[host:]port").
+  // The list is saved in the settings and restored on startup, and a
+  // listener is removed like an additional master, with
+  // removeRosMaster().
+  void listenForSyslog(const QString &address);
+
+ private Q_SLOTS:
+  void remoteSourceStatusChanged();
+  void recorderStatusChanged();
+  void syslogSourceStatusChanged();
+  void syslogSourceFinished(const QString &name, bool success,
+                            size_t msg_count, const QString &error_msg);
+  void bagIndexRead(const swri_console::BagIndex &index);
+  void bagQueryChosen();
+  void bagLoadFinished(const QString &name, bool success,
+                       size_t msg_count, const QString &error_msg);
+  void fileLoadFinished(const QString &name, bool success,
+                        size_t msg_count, const QString &error_msg);
+  void tailSourceFinished(const QString &name, bool success,
+                          size_t msg_count, const QString &error_msg);
 
  Q_SIGNALS:
   void fontChanged(const QFont &font);
+  // An empty status means the source was removed.
+  void sourceStatusChanged(const QString &label, const QString &status,
+                           const QString &details);
+  // A summary of a finished load, for the windows' status bars.
+  void statusMessage(const QString &message);
 
  private:
+  bool startRemoteSource(const QString &label, const QString &master_uri);
+  void saveRemoteMasters() const;
+  bool startSyslogSource(const QString &address);
+  void saveSyslogAddresses() const;
+  QString syslogLabel(const SyslogSource *source) const;
+  // Sends the entries of a source to the database.
+  void connectSource(LogSource *source);
+  // Reads a file with a source that deletes itself when it is done.
+  void readFile(LogSource *source);
+  void connectRosSource(bool connect);
+  void loadBag(BagSource *source, const BagQuery &query);
+  QString recorderLabel() const;
+
   // All ROS operations are done on a separate thread to ensure they do not
   // cause the GUI thread to block.
   RosSource ros_source_;  
@@ -72,6 +139,14 @@ class ConsoleMaster : public QObject
 
   LogDatabase db_;
 
+  // Bag loads whose index has not been read yet, for which the user
+  // asked to choose what to load.
+  QList<BagSource*> query_bag_sources_;
+  QList<TextLogTailSource*> tail_sources_;
+  QList<RemoteRosSource*> remote_sources_;
+  QList<SyslogSource*> syslog_sources_;
+  LogServerSource *recorder_source_;
+
   QFont window_font_;
 };  // class ConsoleMaster
 }  // namespace swri_console
@@ -33,8 +33,11 @@
 
 #include <QtGui/QMainWindow>
 #include <QColor>
+#include <QMap>
 #include <QPushButton>
 #include <QSettings>
+#include <QProgressDialog>
+#include <swri_console/ingest_monitor.h>
 #include "ui_console_window.h"
 
 namespace swri_console
@@ -53,7 +56,12 @@ class ConsoleWindow : public QMainWindow {
 
  Q_SIGNALS:
   void createNewWindow();
-  void readBagFile(const QString &filename);
+  void readBagFiles(const QStringList &filenames, bool choose_query = false);
+  void followLogDirectory(const QString &directory);
+  void addRosMaster(const QString &label, const QString &master_uri);
+  void removeRosMaster(const QString &label);
+  void attachToRecorder(const QString &server_name);
+  void listenForSyslog(const QString &address);
   void selectFont();
 
                    
@@ -62,16 +70,30 @@ class ConsoleWindow : public QMainWindow {
   void clearAll();
   void clearMessages();
   void saveLogs();
+  void exportFinished(bool success, const QString &error_msg);
   void rosConnected(bool connected, const QString &master_uri);
+  void ingestStatsUpdated(const swri_console::IngestStats &stats);
+  // Shows the status of an additional source in the status bar.  An
+  // empty status removes it.
+  void setSourceStatus(const QString &label, const QString &status,
+                       const QString &details);
+  // Shows a message in the status bar until the next one replaces it.
+  void showStatusMessage(const QString &message);
   void setSeverityFilter();
   void nodeSelectionChanged();
   void messagesAdded();
   void showLogContextMenu(const QPoint& point);
+  void toggleMessageExpanded(size_t row);
+  void showLogDetails();
+  void promptForMaxLineLength();
   void selectAllLogs();
   void copyLogs();
   void copyExtendedLogs();
+  void selectionCopyFinished(const QString &text, bool completed);
   void setFollowNewest(bool);
   void toggleAlternateRowColors(bool);
+  void togglePreviewLargeBags(bool);
+  void toggleRawRosoutSubscription(bool);
   
   void userScrolled(int);
 
@@ -89,8 +111,15 @@ class ConsoleWindow : public QMainWindow {
   void setFatalColor();
 
   void promptForBagFile();
+  void promptForFilteredBagFile();
+  void promptForLogDirectory();
+  void promptForRosMaster();
+  void promptToRemoveRosMaster();
+  void promptForRecorder();
+  void promptForSyslog();
   
 private:
+  void copySelection(bool extended);
   void chooseButtonColor(QPushButton* widget);
   QColor getButtonColor(const QPushButton* button) const;
   void updateButtonColor(QPushButton* widget, const QColor& color);
@@ -112,6 +141,9 @@ private:
   NodeListModel *node_list_model_;
 
   QLabel *connection_status_;
+  QLabel *ingest_status_;
+  QMap<QString, QLabel*> source_status_;
+  QProgressDialog *copy_progress_;
 };  // class ConsoleWindow
 }  // namespace swri_console
 
@@ -0,0 +1,124 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#ifndef SWRI_CONSOLE_HEADLESS_RECORDER_H_
+#define SWRI_CONSOLE_HEADLESS_RECORDER_H_
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QString>
+#include <swri_console/log_database.h>
+#include <swri_console/log_server.h>
+#include <swri_console/ros_source.h>
+
+class QSocketNotifier;
+
+namespace swri_console
+{
+/*
+ * HeadlessRecorder runs the console's ingest pipeline without a GUI:
+ * "swri_console --headless [--socket NAME] [--spill FILE]".  It
+ * records the ROS master's logs into a LogDatabase, serves them to
+ * consoles that attach with "swri_console --attach NAME" (see
+ * LogServer), and periodically appends the new entries to a spill
+ * file.  The spill file is read back when the recorder starts, so the
+ * logs survive a restart.
+ *
+ * The spill file is a short magic string followed by the same frames
+ * that LogServer sends its clients: each spill appends the entries
+ * recorded since the last one as SERVER_ENTRIES blocks in the session
+ * file format.  Each run of the recorder first appends a SERVER_HELLO
+ * frame with its LogServer's instance id, so that consoles that were
+ * attached to an earlier run can resume without receiving its entries
+ * again (see LogServer::setHistory()).  A block left incomplete by a
+ * crash is discarded when the file is read.
+ */
+class HeadlessRecorder : public QObject
+{
+  Q_OBJECT;
+
+ public:
+  explicit HeadlessRecorder(const QString &spill_file);
+  ~HeadlessRecorder();
+
+  // Starts listening on server_name, reads the spill file and starts
+  // the ROS source.  Returns false if the server could not listen.
+  bool start(const QString &server_name);
+
+  const QString& errorString() const { return error_msg_; }
+  // Number of entries in the spill file.  Right after start(), these
+  // are the entries that were read back from it.
+  size_t spilledCount() const { return spilled_; }
+
+ private Q_SLOTS:
+  void spillFinished();
+  void handleSignal();
+  // roscpp installs its own SIGINT handler every time it connects to
+  // the master, so the recorder's handlers are installed again
+  // afterwards.
+  void installSignalHandlers();
+
+ protected:
+  void timerEvent(QTimerEvent *event);
+
+ private:
+  void loadSpillFile();
+  std::vector<LogBatchPtr> unspilledBlocks();
+  void spill();
+  void shutdown();
+
+  const QString spill_file_;
+  QString error_msg_;
+
+  RosSource ros_source_;
+  LogDatabase db_;
+  LogServer server_;
+
+  // Set once this run's SERVER_HELLO frame is in the spill file.
+  bool hello_spilled_;
+  // Number of database entries that are in the spill file.
+  size_t spilled_;
+  // Number of database entries that will be in the spill file when
+  // the running spill succeeds.  Equal to spilled_ when no spill is
+  // running.
+  size_t spilling_;
+  QFutureWatcher<QString> spill_watcher_;
+  int spill_timer_id_;
+
+  QSocketNotifier *signal_notifier_;
+};  // class HeadlessRecorder
+
+// Command line argument that runs the headless recorder instead of
+// the GUI.
+extern const char HEADLESS_ARGUMENT[];
+
+// Runs the headless recorder.  Returns the process's exit code.
+int runHeadless(int argc, char **argv);
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_HEADLESS_RECORDER_H_
@@ -0,0 +1,112 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_INGEST_MONITOR_H_
+#define SWRI_CONSOLE_INGEST_MONITOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+
+namespace swri_console
+{
+/*
+ * Counts of live log messages that did not make it into the database.
+ */
+struct IngestStats
+{
+  // Messages missing from the sequence numbers of each publisher of
+  // /rosout_agg (normally just /rosout).  These were lost before they
+  // reached the console, e.g. by a full subscriber queue.
+  std::map<std::string, uint64_t> lost;
+  // Messages from each node that were discarded by load shedding.
+  std::map<std::string, uint64_t> shed;
+
+  uint64_t totalLost() const { return total(lost); }
+  uint64_t totalShed() const { return total(shed); }
+
+ private:
+  static uint64_t total(const std::map<std::string, uint64_t> &counts)
+  {
+    uint64_t sum = 0;
+    for (std::map<std::string, uint64_t>::const_iterator it = counts.begin();
+         it != counts.end(); ++it) {
+      sum += it->second;
+    }
+    return sum;
+  }
+};
+
+/*
+ * IngestMonitor tracks sequence gaps in the live messages and decides
+ * which messages to shed when the console falls behind.
+ *
+ * Shedding depends only on the backlog of messages waiting to be added
+ * to the database, so it degrades predictably:
+ *
+ *  - Below SHED_THRESHOLD, everything is kept.
+ *  - Above it, INFO messages are sampled and DEBUG messages are sampled
+ *    twice as hard.  The sampling interval grows with the backlog.
+ *  - Above DROP_THRESHOLD, all DEBUG and INFO messages are discarded.
+ *  - WARN, ERROR and FATAL messages are always kept.
+ *
+ * Sampling keeps every Nth message of a level, rather than random ones,
+ * so bursts from a single node are thinned out evenly.
+ */
+class IngestMonitor
+{
+ public:
+  static const size_t SHED_THRESHOLD = 20000;
+  static const size_t SHED_STEP = 10000;
+  static const size_t DROP_THRESHOLD = 100000;
+
+  IngestMonitor();
+
+  // Records a message's sequence number from publisher.  Returns true
+  // if a gap was found.
+  bool trackSequence(const std::string &publisher, uint32_t seq);
+
+  // Returns true if a message should be kept, given the number of
+  // messages waiting ahead of it.  Discarded messages are counted as
+  // shed for node.
+  bool keep(const std::string &node, uint8_t level, size_t backlog);
+
+  const IngestStats& stats() const { return stats_; }
+
+ private:
+  IngestStats stats_;
+  std::map<std::string, uint32_t> last_seq_;
+  // Messages seen while shedding, by level, for sampling.
+  uint64_t debug_count_;
+  uint64_t info_count_;
+};
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_INGEST_MONITOR_H_
@@ -36,6 +36,10 @@
 #include <QStringList>
 #include <rosgraph_msgs/Log.h>
 #include <deque>
+#include <map>
+#include <set>
+#include <vector>
+#include <boost/shared_ptr.hpp>
 #include <ros/time.h>
 
 namespace swri_console
@@ -50,8 +54,24 @@ struct LogEntry
   uint32_t line;
   QStringList text;
   uint32_t seq;
+  // Id of the source the entry came from.  See LogDatabase::addSource().
+  uint16_t source;
+
+  LogEntry() : level(0), line(0), seq(0), source(LIVE_SOURCE) {}
+
+  // Source id of messages received from the ROS master.
+  static const uint16_t LIVE_SOURCE = 0;
 };
 
+// Converts a rosgraph_msgs/Log message into a LogEntry.  This is safe
+// to call from any thread, so sources can do the conversion before
+// handing entries to the database.
+void convertLogMessage(const rosgraph_msgs::Log &msg, LogEntry *entry);
+
+// Sources that produce many messages deliver them in batches to avoid
+// the overhead of a queued signal per message.
+typedef boost::shared_ptr<std::vector<LogEntry> > LogBatchPtr;
+
 class LogDatabase : public QObject
 {
   Q_OBJECT
@@ -66,6 +86,17 @@ public:
 
   const std::map<std::string, size_t>& messageCounts() const { return msg_counts_; }
 
+  // Names of the nodes that received messages in the most recent
+  // batch.  This is valid while messagesAdded() is being handled so
+  // that views can update only the affected nodes.
+  const std::set<std::string>& changedNodes() const { return changed_nodes_; }
+
+  // Registers a named source of log entries (e.g. a bag file) and
+  // returns the id entries from it should be tagged with.  Ids stay
+  // valid when the database is cleared.
+  uint16_t addSource(const QString &name);
+  QString sourceName(uint16_t source) const;
+
  Q_SIGNALS:
   void databaseCleared();
   void messagesAdded();
@@ -73,15 +104,24 @@ public:
 
 public Q_SLOTS:
   void queueMessage(const rosgraph_msgs::LogConstPtr msg);
+  // The entries are moved out of the batch when the queue is
+  // processed, so the database must be the batch's only receiver.
+  void queueBatch(const swri_console::LogBatchPtr &batch);
   void processQueue();
 
  protected:
   void timerEvent(QTimerEvent *);
   
 private:  
+  void countMessages(const std::string &node, size_t count);
+
+
   std::map<std::string, size_t> msg_counts_;
   std::deque<LogEntry> log_;
-  std::deque<LogEntry> new_msgs_;
+  std::deque<LogBatchPtr> new_batches_;
+  std::set<std::string> pending_nodes_;
+  std::set<std::string> changed_nodes_;
+  std::vector<QString> sources_;
 
   ros::Time min_time_;
 };  // class LogDatabase
@@ -37,14 +37,15 @@
 #include <set>
 #include <string>
 #include <deque>
+#include <vector>
 #include <QStringList>
 #include <QRegExp>
+#include <swri_console/log_database.h>
+#include <swri_console/log_filter.h>
+#include <swri_console/log_formatter.h>
 
 namespace swri_console
 {
-
-class LogDatabase;
-class LogEntry;
 class LogDatabaseProxyModel : public QAbstractListModel
 {
   Q_OBJECT
@@ -54,6 +55,21 @@ class LogDatabaseProxyModel : public QAbstractListModel
     ExtendedLogRole = Qt::UserRole + 0
   };
 
+  // Default number of characters of a line that are displayed before
+  // it is elided.
+  static const int DEFAULT_MAX_LINE_LENGTH = 1000;
+
+  // An inclusive range of rows.  Selections are passed around as
+  // lists of ranges so that large selections never have to be
+  // expanded into individual model indices.
+  struct RowRange {
+    size_t first;
+    size_t last;
+
+    RowRange() : first(0), last(0) {}
+    RowRange(size_t first, size_t last) : first(first), last(last) {}
+  };
+
   LogDatabaseProxyModel(LogDatabase *db);
   ~LogDatabaseProxyModel();
 
@@ -68,6 +84,7 @@ class LogDatabaseProxyModel : public QAbstractListModel
   void setWarnColor(const QColor& warn_color);
   void setErrorColor(const QColor& error_color);
   void setFatalColor(const QColor& fatal_color);
+  int maxLineLength() const { return max_line_length_; }
   bool isIncludeValid() const;
   bool isExcludeValid() const;
 
@@ -75,12 +92,43 @@ class LogDatabaseProxyModel : public QAbstractListModel
   virtual int rowCount(const QModelIndex &parent) const;
   virtual QVariant data(const QModelIndex &index, int role) const;
 
+  // Row based accessors used by LogListWidget.  These avoid creating
+  // model indices and QVariants for every painted row.  lineText()
+  // and lineToolTip() elide lines longer than maxLineLength(); use
+  // selectionText() to get the full text.
+  size_t lineCount() const { return msg_mapping_.size(); }
+  QString lineText(size_t row) const;
+  QColor lineColor(size_t row) const;
+  QString lineToolTip(size_t row) const;
+
   void reset();
 
-  void saveToFile(const QString& filename) const;
+  // Copies the log entries that pass the current filters, in display
+  // order, so they can be processed off the GUI thread.
+  LogBatchPtr snapshotEntries() const;
+
+  // Returns a formatter with the current display settings.
+  LogFormatter formatter() const;
+
+  // Formats the rows in the given ranges into a single string.  Rows
+  // are formatted as they are displayed unless extended is true, in
+  // which case each message is formatted with its metadata.
+  QString selectionText(const std::vector<RowRange> &ranges, bool extended) const;
+
+  // Same as selectionText(), but the rows are formatted in small
+  // chunks while the event loop is idle.  Progress is reported by
+  // selectionCopyProgress() and the result by selectionCopyFinished().
+  // Starting a new copy cancels the one in progress.
+  void startSelectionCopy(const std::vector<RowRange> &ranges, bool extended);
+
+  // When multi-line messages are collapsed, this expands or collapses
+  // the message shown at row.
+  void toggleExpanded(size_t row);
 
  Q_SIGNALS:
   void messagesAdded();
+  void selectionCopyProgress(int percent);
+  void selectionCopyFinished(const QString &text, bool completed);
 
  public Q_SLOTS:
   void handleDatabaseCleared();
@@ -91,23 +139,32 @@ class LogDatabaseProxyModel : public QAbstractListModel
   void setAbsoluteTime(bool absolute);
   void setColorizeLogs(bool colorize_logs);
   void setUseRegularExpressions(bool useRegexps);
+  void setCollapseMultiline(bool collapse);
+  void setMaxLineLength(int length);
+  void cancelSelectionCopy();
+
+ private Q_SLOTS:
+  void processSelectionCopy();
 
  private:
   LogDatabase *db_;
 
-  void saveBagFile(const QString& filename) const;
-  void saveTextFile(const QString& filename) const;
   void scheduleIdleProcessing();
   
-  bool acceptLogEntry(const LogEntry &item);
-  bool testIncludeFilter(const LogEntry &item);
-  
-  std::set<std::string> names_;
-  uint8_t severity_mask_;
+  LogFilter filter_;
   bool colorize_logs_;
   bool display_time_;
   bool display_absolute_time_;
-  bool use_regular_expressions_;
+
+  // When collapse_multiline_ is set, multi-line messages are shown as
+  // a single row unless the user has expanded them.  expanded_logs_
+  // holds the log indices of the expanded messages.
+  bool collapse_multiline_;
+  std::set<size_t> expanded_logs_;
+
+  // Number of characters of each line that are displayed, or -1 to
+  // display everything.
+  int max_line_length_;
 
   // For performance reasons, the proxy model presents single line
   // items, while the underlying log database stores multi-line
@@ -127,10 +184,35 @@ class LogDatabaseProxyModel : public QAbstractListModel
   size_t earliest_log_index_;
   std::deque<LineMap> early_mapping_;
 
-  QRegExp include_regexp_;
-  QRegExp exclude_regexp_;
-  QStringList include_strings_;
-  QStringList exclude_strings_;
+  // Total number of rows inserted at the front of msg_mapping_.  Used
+  // to keep row numbers stable while an incremental copy is running.
+  size_t rows_prepended_;
+
+  struct CopyJob {
+    bool active;
+    bool extended;
+    std::vector<RowRange> ranges;
+    size_t range_index;
+    size_t next_row;
+    size_t row_offset;
+    size_t rows_done;
+    size_t rows_total;
+    bool has_output;
+    size_t prev_log;
+    QString buffer;
+
+    CopyJob() : active(false), extended(false), range_index(0), next_row(0),
+                row_offset(0), rows_done(0), rows_total(0), has_output(false),
+                prev_log(0) {}
+  };
+  CopyJob copy_job_;
+
+  bool isCollapsed(size_t log_index, const LogEntry &item) const;
+  int visibleLineCount(size_t log_index, const LogEntry &item) const;
+  void appendDisplayText(QString &buffer, const LineMap &line_idx, int max_length = -1) const;
+  void appendExtendedText(QString &buffer, const LogEntry &item) const;
+  void initCopyJob(CopyJob &job, const std::vector<RowRange> &ranges, bool extended) const;
+  void appendCopyRows(CopyJob &job, size_t max_rows) const;
 
   QColor debug_color_;
   QColor info_color_;
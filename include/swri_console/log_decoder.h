@@ -0,0 +1,98 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_LOG_DECODER_H_
+#define SWRI_CONSOLE_LOG_DECODER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <set>
+#include <string>
+
+namespace swri_console
+{
+struct LogEntry;
+
+/*
+ * Predicates that are checked while a message is decoded, before the
+ * expensive parts of the LogEntry (the message text) are built.
+ */
+struct LogDecodeFilter
+{
+  // Messages with a lower level are rejected.  rosgraph_msgs/Log
+  // levels are bit values, so this also works as a minimum severity.
+  uint8_t min_level;
+  // If not empty, only messages from these nodes are accepted.
+  std::set<std::string> nodes;
+
+  LogDecodeFilter() : min_level(0) {}
+};
+
+// Returns false if nsec is not a valid nanoseconds field of a stamp.
+// ros::Time carries a larger value into the seconds and throws if
+// they overflow, so stamps from untrusted data are checked first.
+inline bool isValidNsec(uint32_t nsec) { return nsec < 1000000000; }
+
+enum DecodeStatus
+{
+  DECODE_ACCEPTED,
+  DECODE_REJECTED,
+  DECODE_INVALID
+};
+
+/*
+ * Decodes a serialized rosgraph_msgs/Log message directly into a
+ * LogEntry, without creating an intermediate rosgraph_msgs::Log.
+ * Returns false if the buffer is not a complete message or its stamp
+ * is invalid.
+ *
+ * This is safe to call from any thread.
+ */
+bool decodeLogMessage(const uint8_t *data, size_t size, LogEntry *entry);
+
+/*
+ * Same as above, but stops decoding as soon as the message fails one
+ * of the filter's predicates.  The contents of entry are undefined
+ * unless DECODE_ACCEPTED is returned.
+ */
+DecodeStatus decodeLogMessage(const uint8_t *data, size_t size,
+                              const LogDecodeFilter &filter,
+                              LogEntry *entry);
+
+/*
+ * Decodes only the sequence number, stamp, level and node name of a
+ * serialized rosgraph_msgs/Log message, which are at the front of it.
+ * Returns false if the buffer is too short or the stamp is invalid.
+ */
+bool decodeLogHeader(const uint8_t *data, size_t size,
+                     uint32_t *seq, uint32_t *sec, uint32_t *nsec,
+                     uint8_t *level, std::string *node);
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_LOG_DECODER_H_
@@ -0,0 +1,126 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_LOG_EXPORTER_H_
+#define SWRI_CONSOLE_LOG_EXPORTER_H_
+
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QString>
+#include <boost/shared_ptr.hpp>
+#include <swri_console/log_database.h>
+#include <swri_console/log_formatter.h>
+
+namespace swri_console
+{
+/*
+ * LogExporter writes a snapshot of log entries to a file on the
+ * global thread pool, so that exporting a large session does not
+ * block the GUI.  Progress is reported with progress() and the result
+ * with finished().
+ *
+ * Text formats are formatted in chunks on several threads and written
+ * in order with large buffered writes.
+ */
+class LogExporter : public QObject
+{
+  Q_OBJECT;
+
+ public:
+  enum Format {
+    BAG,
+    BAG_BZ2,
+    BAG_LZ4,
+    // Every line of every message, as displayed with formatter.
+    TEXT,
+    // One JSON object with all fields per message.
+    NDJSON,
+    // swri_console's native session format.  See session_file.h.
+    SESSION
+  };
+
+  // entries must not be modified while the export is running.
+  LogExporter(const QString &filename,
+              const LogBatchPtr &entries,
+              Format format,
+              const LogFormatter &formatter = LogFormatter(),
+              QObject *parent = NULL);
+  // Cancels the export and waits for the worker to stop.
+  ~LogExporter();
+
+  void start();
+
+  const QString &filename() const { return filename_; }
+  bool isCancelled() const { return state_->cancelled.fetchAndAddOrdered(0) != 0; }
+
+ Q_SIGNALS:
+  void progress(int percent);
+  // A partially written file is removed if the export failed or was
+  // cancelled.
+  void finished(bool success, const QString &error_msg);
+
+ public Q_SLOTS:
+  void cancel();
+
+ protected:
+  void timerEvent(QTimerEvent *);
+
+ private Q_SLOTS:
+  void handleFinished();
+
+ private:
+  // Shared between the exporter and its worker.
+  struct State {
+    QAtomicInt written;
+    QAtomicInt cancelled;
+  };
+  typedef boost::shared_ptr<State> StatePtr;
+
+  static QString write(QString filename, LogBatchPtr entries, Format format,
+                       LogFormatter formatter, StatePtr state);
+  static QString writeBag(const QString &filename, const LogBatchPtr &entries,
+                          Format format, const StatePtr &state);
+  static QString writeText(const QString &filename, const LogBatchPtr &entries,
+                           Format format, const LogFormatter &formatter,
+                           const StatePtr &state);
+  static QByteArray formatChunk(LogBatchPtr entries, size_t begin, size_t end,
+                                Format format, LogFormatter formatter);
+
+  QString filename_;
+  LogBatchPtr entries_;
+  Format format_;
+  LogFormatter formatter_;
+  StatePtr state_;
+  QFutureWatcher<QString> watcher_;
+  int timer_id_;
+};  // class LogExporter
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_LOG_EXPORTER_H_
@@ -0,0 +1,90 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#ifndef SWRI_CONSOLE_LOG_FILTER_H_
+#define SWRI_CONSOLE_LOG_FILTER_H_
+
+#include <stdint.h>
+#include <set>
+#include <string>
+#include <QRegExp>
+#include <QStringList>
+#include <swri_console/log_database.h>
+#include <swri_console/log_decoder.h>
+
+namespace swri_console
+{
+/*
+ * The filters of the log view: the selected nodes, a severity mask,
+ * and include and exclude filters that are either lists of
+ * case-insensitive strings or regular expressions.  A LogFilter is a
+ * plain value, so it can be copied to worker threads.  QRegExp keeps
+ * the state of the last match, so each thread needs its own copy.
+ */
+class LogFilter
+{
+ public:
+  LogFilter();
+
+  // Only entries from these nodes pass.  Entries from all nodes pass
+  // until this is called.
+  void setNodeFilter(const std::set<std::string> &names);
+  // A mask of rosgraph_msgs/Log levels.
+  void setSeverityFilter(uint8_t severity_mask);
+  void setIncludeFilters(const QStringList &list);
+  void setExcludeFilters(const QStringList &list);
+  void setIncludeRegexpPattern(const QString &pattern);
+  void setExcludeRegexpPattern(const QString &pattern);
+  // Selects whether the regexp patterns or the string lists are used.
+  void setUseRegularExpressions(bool use_regexps);
+
+  bool useRegularExpressions() const { return use_regular_expressions_; }
+  bool isIncludeValid() const;
+  bool isExcludeValid() const;
+
+  bool accept(const LogEntry &item) const;
+
+  // The part of the filter that can be checked while a serialized
+  // message is decoded.  Entries that pass it still need accept().
+  LogDecodeFilter decodeFilter() const;
+
+ private:
+  bool testIncludeFilter(const LogEntry &item) const;
+
+  bool filter_nodes_;
+  std::set<std::string> names_;
+  uint8_t severity_mask_;
+  bool use_regular_expressions_;
+  QRegExp include_regexp_;
+  QRegExp exclude_regexp_;
+  QStringList include_strings_;
+  QStringList exclude_strings_;
+};  // class LogFilter
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_LOG_FILTER_H_
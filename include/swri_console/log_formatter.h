@@ -0,0 +1,71 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_LOG_FORMATTER_H_
+#define SWRI_CONSOLE_LOG_FORMATTER_H_
+
+#include <string>
+#include <QString>
+#include <ros/time.h>
+#include <swri_console/log_database.h>
+
+namespace swri_console
+{
+/*
+ * Formats log entries as text.  A LogFormatter only holds a copy of
+ * the display settings, so it can be copied to and used from any
+ * thread.
+ */
+struct LogFormatter
+{
+  bool display_time;
+  bool absolute_time;
+  // Relative timestamps are measured from this time.
+  ros::Time min_time;
+
+  LogFormatter() : display_time(true), absolute_time(false) {}
+
+  // Appends one line of a message as it is displayed in the log list.
+  // Lines after the first get a blank header so that they line up
+  // with the first.  Lines longer than max_length characters are
+  // elided, unless max_length is negative.
+  void appendLine(QString &buffer, const LogEntry &item, int line, int max_length = -1) const;
+
+  // Appends a message as a single line of JSON with all of its fields.
+  // The stamp is written as the integer fields "sec" and "nsec".  If
+  // source is not empty, it is added as the "source" field.  No
+  // newline is appended.
+  static void appendJson(std::string &buffer, const LogEntry &item,
+                         const std::string &source = std::string());
+
+  static void appendElided(QString &buffer, const QString &text, int max_length);
+};
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_LOG_FORMATTER_H_
@@ -0,0 +1,131 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_LOG_LIST_WIDGET_H_
+#define SWRI_CONSOLE_LOG_LIST_WIDGET_H_
+
+#include <stddef.h>
+#include <vector>
+#include <QAbstractScrollArea>
+#include <QModelIndex>
+#include <swri_console/log_database_proxy_model.h>
+
+namespace swri_console
+{
+/*
+ * LogListWidget is a lightweight replacement for QListView that is
+ * specialized for displaying a LogDatabaseProxyModel.
+ *
+ * Only the rows that are visible are ever queried from the model.
+ * Rows are addressed with size_t, the scroll bar scrolls by rows
+ * instead of pixels (and is scaled when there are more rows than it
+ * can represent), and the selection is stored as a sorted list of row
+ * ranges, so the cost of scrolling and selecting does not depend on
+ * the number of rows.
+ */
+class LogListWidget : public QAbstractScrollArea
+{
+  Q_OBJECT;
+
+ public:
+  typedef LogDatabaseProxyModel::RowRange RowRange;
+
+  LogListWidget(QWidget *parent = NULL);
+  ~LogListWidget();
+
+  void setModel(LogDatabaseProxyModel *model);
+
+  bool alternatingRowColors() const { return alternating_row_colors_; }
+  void setAlternatingRowColors(bool enable);
+
+  // Returns the selected rows as sorted, non-overlapping ranges.
+  const std::vector<RowRange>& selectedRanges() const { return selection_; }
+  bool isRowSelected(size_t row) const;
+
+  // Returns the row at the given viewport position, or false if
+  // there isn't a row there.
+  bool rowAt(const QPoint &pos, size_t *row) const;
+
+ Q_SIGNALS:
+  void rowDoubleClicked(size_t row);
+
+ public Q_SLOTS:
+  void selectAll();
+  void clearSelection();
+  void scrollToBottom();
+  void scrollToRow(size_t row);
+
+ protected:
+  virtual void paintEvent(QPaintEvent *event);
+  virtual void resizeEvent(QResizeEvent *event);
+  virtual void changeEvent(QEvent *event);
+  virtual void scrollContentsBy(int dx, int dy);
+  virtual bool viewportEvent(QEvent *event);
+  virtual void wheelEvent(QWheelEvent *event);
+  virtual void mousePressEvent(QMouseEvent *event);
+  virtual void mouseMoveEvent(QMouseEvent *event);
+  virtual void mouseDoubleClickEvent(QMouseEvent *event);
+  virtual void keyPressEvent(QKeyEvent *event);
+
+ private Q_SLOTS:
+  void handleVerticalScroll(int value);
+  void handleRowsInserted(const QModelIndex &parent, int first, int last);
+  void handleRowsRemoved(const QModelIndex &parent, int first, int last);
+  void handleModelReset();
+  void handleDataChanged();
+
+ private:
+  int rowHeight() const;
+  size_t visibleRowCount() const;
+  size_t maxTopRow() const;
+  void updateScrollBars();
+  void setTopRow(size_t row);
+
+  void selectRange(size_t first, size_t last);
+  void toggleRow(size_t row);
+  void setCurrentRow(size_t row, Qt::KeyboardModifiers modifiers);
+
+  LogDatabaseProxyModel *model_;
+
+  // Index of the first visible row.
+  size_t top_row_;
+  // Set while we are changing the scroll bar ourselves so that the
+  // resulting valueChanged() does not move top_row_.
+  bool updating_scroll_bar_;
+  // Widest line painted so far, used for the horizontal scroll bar.
+  int max_line_width_;
+  bool alternating_row_colors_;
+
+  std::vector<RowRange> selection_;
+  size_t anchor_row_;
+  size_t current_row_;
+};  // class LogListWidget
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_LOG_LIST_WIDGET_H_
@@ -0,0 +1,139 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#ifndef SWRI_CONSOLE_LOG_QUERY_H_
+#define SWRI_CONSOLE_LOG_QUERY_H_
+
+#include <stdio.h>
+#include <deque>
+#include <string>
+#include <vector>
+#include <QByteArray>
+#include <QFuture>
+#include <QObject>
+#include <QStringList>
+#include <boost/shared_ptr.hpp>
+#include <swri_console/bag_index.h>
+#include <swri_console/log_database.h>
+#include <swri_console/log_filter.h>
+#include <swri_console/log_formatter.h>
+
+namespace swri_console
+{
+/*
+ * LogQuery filters log files without a GUI or a database:
+ * "swri_console --query [options] FILE...".  Bags, session files and
+ * text logs are read with the same sources as in the GUI, several
+ * files at a time.  The batches they deliver are filtered with a
+ * LogFilter and formatted on the global thread pool, and the results
+ * are written to a stream in the order the batches arrived.  The
+ * lines of each file are in order, but the lines of files that are
+ * read at the same time are interleaved batch by batch.
+ */
+class LogQuery : public QObject
+{
+  Q_OBJECT;
+
+ public:
+  enum Format {
+    // Lines as displayed in the log list.
+    TEXT,
+    // One JSON object per message.
+    NDJSON
+  };
+
+  LogQuery(const QStringList &filenames,
+           const LogFilter &filter,
+           const LogFormatter &formatter,
+           Format format,
+           FILE *output);
+  // Waits for any batches that are still being formatted.
+  ~LogQuery();
+
+  void start();
+
+  size_t matchCount() const { return match_count_; }
+  // Number of files that could not be read.
+  size_t errorCount() const { return error_count_; }
+
+ Q_SIGNALS:
+  void finished();
+
+ private Q_SLOTS:
+  void handleBatch(const swri_console::LogBatchPtr &batch);
+  void bagIndexRead(const swri_console::BagIndex &index);
+  void fileFinished(const QString &name, bool success,
+                    size_t msg_count, const QString &error_msg);
+
+ protected:
+  void timerEvent(QTimerEvent *event);
+
+ private:
+  struct Output
+  {
+    QByteArray data;
+    size_t match_count;
+
+    Output() : match_count(0) {}
+  };
+
+  typedef boost::shared_ptr<const std::vector<std::string> > NamesPtr;
+
+  static Output formatBatch(LogBatchPtr batch, LogFilter filter,
+                            LogFormatter formatter, Format format,
+                            NamesPtr names);
+  void startFiles();
+  void writeOutputs();
+
+  const QStringList filenames_;
+  const LogFilter filter_;
+  const LogFormatter formatter_;
+  const Format format_;
+  FILE *output_;
+  // Names of the files by source id, which label their lines when
+  // there are several, like grep does.  Empty for a single file.
+  NamesPtr names_;
+
+  int next_file_;
+  int running_files_;
+  std::deque<QFuture<Output> > outputs_;
+  int timer_id_;
+
+  size_t match_count_;
+  size_t error_count_;
+};  // class LogQuery
+
+// Command line argument that runs a query instead of the GUI.
+extern const char QUERY_ARGUMENT[];
+
+// Runs a query.  Returns the process's exit code: 0 if any entry
+// matched, 1 if none did, and 2 if there was an error.
+int runQuery(int argc, char **argv);
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_LOG_QUERY_H_
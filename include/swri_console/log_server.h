@@ -0,0 +1,141 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#ifndef SWRI_CONSOLE_LOG_SERVER_H_
+#define SWRI_CONSOLE_LOG_SERVER_H_
+
+#include <stdint.h>
+#include <map>
+#include <QByteArray>
+#include <QList>
+#include <QLocalServer>
+#include <QObject>
+#include <QString>
+#include <swri_console/log_database.h>
+#include <swri_console/ros_relay.h>
+
+class QIODevice;
+class QLocalSocket;
+
+namespace swri_console
+{
+/*
+ * A LogServer shares a log database with consoles in other processes
+ * over a local socket.  It is used by the headless recorder (see
+ * headless_recorder.h) so that several consoles can attach to one
+ * ingest pipeline.  Frames have the same layout as the relay's (see
+ * ros_relay.h).  On connecting, the server sends SERVER_HELLO and
+ * SERVER_STATUS, and waits for CLIENT_RESUME before it sends entries,
+ * starting with the backlog and continuing with new entries as they
+ * are added.  It answers CLIENT_RESUME with SERVER_RESUME, which tells
+ * the client where in the database it resumes.  A client can resume
+ * from this server instance or, given the history set by
+ * setHistory(), from an earlier instance whose entries were read back
+ * from its spill file.
+ *
+ * Entries are copied out of the database and sent in blocks encoded
+ * in the session file format.  Each client has its own position in
+ * the database, and only a limited amount of data is queued per
+ * socket, so a slow client does not hold up the others.
+ */
+enum LogServerFrameType
+{
+  // data: uint64_t id of the server instance.
+  SERVER_HELLO = 1,
+  // data: the URI of the server's ROS master, empty if not connected.
+  SERVER_STATUS = 2,
+  // data: a block of entries in the session file format.
+  SERVER_ENTRIES = 3,
+  // data: uint64_t id of the server instance the client was attached
+  // to before and uint64_t number of entries received from it.
+  CLIENT_RESUME = 4,
+  // data: uint64_t number of database entries that the server will
+  // not send to the client because it already has them.
+  SERVER_RESUME = 5
+};
+
+// Name of the server's socket when none is given.
+extern const char DEFAULT_SERVER_NAME[];
+
+class LogServer : public QObject
+{
+  Q_OBJECT;
+
+ public:
+  LogServer(LogDatabase *db, QObject *parent=NULL);
+  ~LogServer();
+
+  // Starts listening on the local socket name.  A stale socket left
+  // behind by a previous server is removed.
+  bool listen(const QString &name);
+  QString errorString() const { return server_.errorString(); }
+
+  uint64_t instanceId() const { return instance_id_; }
+  // Sets the number of database entries that came from each earlier
+  // server instance, keyed by instance id, so that clients that were
+  // attached to those instances can resume without receiving their
+  // entries again.
+  void setHistory(const std::map<uint64_t, size_t> &history) { history_ = history; }
+
+ public Q_SLOTS:
+  void setStatus(bool connected, const QString &master_uri);
+
+ private Q_SLOTS:
+  void acceptClients();
+  void readClient();
+  void removeClient();
+  void sendEntries();
+
+ private:
+  struct Client
+  {
+    QLocalSocket *socket;
+    RelayFrameReader reader;
+    // Set once the client has sent CLIENT_RESUME.
+    bool resumed;
+    // Number of database entries sent to the client.
+    size_t sent;
+  };
+
+  Client* findClient(QObject *socket);
+  void sendEntries(Client *client);
+
+  LogDatabase *db_;
+  QLocalServer server_;
+  QList<Client*> clients_;
+  const uint64_t instance_id_;
+  std::map<uint64_t, size_t> history_;
+  QByteArray master_uri_;
+};  // class LogServer
+
+// Writes a frame to a socket or file.  Returns false if the device
+// did not take all of it.
+bool writeServerFrame(QIODevice *device, uint8_t type, const void *data, uint32_t size);
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_LOG_SERVER_H_
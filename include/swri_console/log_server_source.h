@@ -0,0 +1,110 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#ifndef SWRI_CONSOLE_LOG_SERVER_SOURCE_H_
+#define SWRI_CONSOLE_LOG_SERVER_SOURCE_H_
+
+#include <stdint.h>
+#include <deque>
+#include <QByteArray>
+#include <QFuture>
+#include <QLocalSocket>
+#include <QString>
+#include <swri_console/log_source.h>
+#include <swri_console/ros_relay.h>
+
+namespace swri_console
+{
+/*
+ * LogServerSource attaches to a LogServer, normally the one run by
+ * the headless recorder, and delivers its backlog followed by new
+ * entries as they are recorded.  The blocks of entries are decoded on
+ * the global thread pool and delivered in order.  Only a few blocks
+ * are decoded at a time; the socket is not read while they are, so
+ * the server holds back instead of the console buffering without
+ * bounds.  The source reconnects if the server goes away, resuming
+ * where it left off, even if the recorder was restarted in between.
+ */
+class LogServerSource : public LogSource
+{
+  Q_OBJECT;
+
+ public:
+  // Entries are tagged with source.
+  LogServerSource(const QString &server_name, uint16_t source, QObject *parent=NULL);
+  // Waits for any blocks that are still being decoded.
+  ~LogServerSource();
+
+  void start();
+
+  QString name() const { return server_name_; }
+  const QString& serverName() const { return server_name_; }
+
+  // Short description of the source's state for the status bar.
+  QString statusText() const;
+
+ Q_SIGNALS:
+  void statusChanged();
+
+ private Q_SLOTS:
+  void handleDisconnected();
+  void readFrames();
+
+ protected:
+  void halt();
+  void timerEvent(QTimerEvent *event);
+
+ private:
+  static LogBatchPtr decodeBlock(QByteArray data, uint16_t source);
+  void connectToServer();
+
+  const QString server_name_;
+  const uint16_t source_;
+
+  QLocalSocket socket_;
+  RelayFrameReader reader_;
+  std::deque<QFuture<LogBatchPtr> > blocks_;
+  int poll_timer_id_;
+
+  bool attached_;
+  QString master_uri_;
+  int retry_interval_;
+  int retry_timer_id_;
+
+  // Identifies the server instance, and the number of entries
+  // received from it, for resuming after a reconnect.
+  uint64_t server_id_;
+  uint64_t received_;
+  // Id of the server instance that sent SERVER_HELLO.  It replaces
+  // server_id_ when the server answers CLIENT_RESUME, so the old
+  // position is kept if the connection drops before then.
+  uint64_t hello_id_;
+};  // class LogServerSource
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_LOG_SERVER_SOURCE_H_
@@ -0,0 +1,143 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#ifndef SWRI_CONSOLE_LOG_SOURCE_H_
+#define SWRI_CONSOLE_LOG_SOURCE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <boost/shared_ptr.hpp>
+#include <swri_console/log_database.h>
+
+namespace swri_console
+{
+/*
+ * Counters that every LogSource keeps.
+ */
+struct LogSourceStats
+{
+  // Entries delivered.
+  size_t msg_count;
+  // Bytes read, for sources that know it.
+  uint64_t byte_count;
+  // Messages that were lost or discarded before they were delivered.
+  size_t drop_count;
+  // Entries delivered per second over the last interval.
+  double rate;
+  // Seconds since the source was created.
+  double elapsed;
+
+  LogSourceStats() : msg_count(0), byte_count(0), drop_count(0), rate(0.0), elapsed(0.0) {}
+};
+
+/*
+ * LogSource is the interface of everything that produces log entries:
+ * files, the ROS master, relays and recorders.  Sources deliver their
+ * entries in batches with batchRead(), which is all the database
+ * needs to be connected to, and report the end of a finite source or
+ * the failure of any source with finished().
+ *
+ * Sources run in the GUI thread and usually do their work elsewhere.
+ * Workers on other threads add the size of each batch they hand over
+ * to backlog(), and deliverQueued() takes it off again when the batch
+ * arrives.  Workers hold back while the backlog is at MAX_BACKLOG, so
+ * entries do not pile up in the event queue when the GUI thread can't
+ * keep up.
+ */
+class LogSource : public QObject
+{
+  Q_OBJECT;
+
+ public:
+  // Entries handed over but not delivered at which workers should
+  // hold back.
+  static const int MAX_BACKLOG = 100000;
+
+  explicit LogSource(QObject *parent=NULL);
+  virtual ~LogSource();
+
+  // Name of the source for messages to the user.
+  virtual QString name() const = 0;
+
+  // Starts producing entries.  A source that can't start emits
+  // finished() with an error.
+  virtual void start() = 0;
+
+  bool isFinished() const { return finished_; }
+  const LogSourceStats& stats() const { return stats_; }
+  const boost::shared_ptr<QAtomicInt>& backlog() const { return backlog_; }
+
+ Q_SIGNALS:
+  void batchRead(const swri_console::LogBatchPtr &batch);
+  // Emitted once.  Nothing is delivered afterwards.
+  void finished(const QString &name, bool success, size_t msg_count, const QString &error_msg);
+  // Emitted about once per second while the stats are changing.
+  void statsUpdated(const swri_console::LogSourceStats &stats);
+
+ public Q_SLOTS:
+  // Stops the source and finishes successfully with what it has
+  // delivered so far.
+  void stop();
+  // Stops the source and finishes with an error.
+  void cancel();
+
+ protected:
+  // Called once by stop() or cancel() to stop producing entries.
+  // Anything produced afterwards is discarded.
+  virtual void halt() {}
+
+  void deliver(const LogBatchPtr &batch, uint64_t bytes=0);
+  // Delivers a batch that a worker added to backlog().
+  void deliverQueued(const LogBatchPtr &batch, uint64_t bytes=0);
+  void addBytes(uint64_t bytes);
+  void addDrops(size_t count);
+  void finish(bool success, const QString &error_msg=QString());
+
+ private Q_SLOTS:
+  void updateStats();
+
+ private:
+  bool finished_;
+  LogSourceStats stats_;
+  boost::shared_ptr<QAtomicInt> backlog_;
+
+  QElapsedTimer elapsed_timer_;
+  QTimer stats_timer_;
+  // Values at the last statsUpdated().
+  size_t last_msg_count_;
+  double last_elapsed_;
+  bool changed_;
+};  // class LogSource
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_LOG_SOURCE_H_
@@ -0,0 +1,76 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_MASTER_MONITOR_H_
+#define SWRI_CONSOLE_MASTER_MONITOR_H_
+
+#include <QObject>
+#include <QTimer>
+
+namespace swri_console
+{
+/*
+ * MasterMonitor polls the ROS master with ros::master::check(), which
+ * is a blocking XML-RPC call.  It is meant to live in a thread of its
+ * own, so that a slow or unreachable master does not hold up anything
+ * else.
+ *
+ * While the master is up, it is checked at a fixed interval.  While it
+ * is down, the interval between attempts backs off exponentially up to
+ * a limit, and is reset as soon as the master is found.
+ */
+class MasterMonitor : public QObject
+{
+  Q_OBJECT;
+
+ public:
+  MasterMonitor();
+
+ Q_SIGNALS:
+  // Emitted when the master's status changes, starting with the
+  // result of the first check.
+  void masterStatusChanged(bool is_up);
+
+ public Q_SLOTS:
+  // Starts checking.  Call this from the monitor's thread, e.g. by
+  // connecting it to QThread::started().
+  void start();
+
+ private Q_SLOTS:
+  void checkMaster();
+
+ private:
+  QTimer timer_;
+  bool checked_;
+  bool is_up_;
+  int retry_interval_;
+};  // class MasterMonitor
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_MASTER_MONITOR_H_
@@ -33,7 +33,7 @@
 
 #include <string>
 #include <vector>
-#include <map>
+#include <unordered_map>
 #include <QAbstractListModel>
 
 namespace swri_console
@@ -60,10 +60,17 @@ class NodeListModel : public QAbstractListModel
   void handleMessagesAdded();
   
  private:
+  void rebuildRowIndex();
+
   LogDatabase *db_;
-  
-  std::map<std::string, size_t> data_;
+
+  // Message counts keyed by node name.  The node names are kept
+  // sorted in ordering_, and row_index_ maps each name back to its
+  // row so that only the nodes touched by a batch need to be
+  // updated.
+  std::unordered_map<std::string, size_t> data_;
   std::vector<std::string> ordering_;
+  std::unordered_map<std::string, int> row_index_;
 };
 }  // namespace swri_console
 #endif  // SWRI_CONSOLE_NODE_LIST_MODEL_H_
@@ -0,0 +1,115 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_RAW_LOG_MESSAGE_H_
+#define SWRI_CONSOLE_RAW_LOG_MESSAGE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <ros/message_traits.h>
+#include <ros/serialization.h>
+#include <rosgraph_msgs/Log.h>
+
+namespace swri_console
+{
+/*
+ * A rosgraph_msgs/Log message in its serialized form.  Subscribing
+ * with this type makes roscpp copy the bytes off the wire instead of
+ * deserializing them, so the receiving thread does almost no work per
+ * message.  Decode the data with decodeLogMessage().
+ */
+struct RawLogMessage
+{
+  std::vector<uint8_t> data;
+};
+typedef boost::shared_ptr<const RawLogMessage> RawLogMessageConstPtr;
+}  // namespace swri_console
+
+namespace ros
+{
+namespace message_traits
+{
+// Advertise the same type as rosgraph_msgs/Log so that publishers of
+// that type will connect.
+template<>
+struct MD5Sum<swri_console::RawLogMessage>
+{
+  static const char* value() { return MD5Sum<rosgraph_msgs::Log>::value(); }
+  static const char* value(const swri_console::RawLogMessage&) { return value(); }
+};
+
+template<>
+struct DataType<swri_console::RawLogMessage>
+{
+  static const char* value() { return DataType<rosgraph_msgs::Log>::value(); }
+  static const char* value(const swri_console::RawLogMessage&) { return value(); }
+};
+
+template<>
+struct Definition<swri_console::RawLogMessage>
+{
+  static const char* value() { return Definition<rosgraph_msgs::Log>::value(); }
+  static const char* value(const swri_console::RawLogMessage&) { return value(); }
+};
+}  // namespace message_traits
+
+namespace serialization
+{
+template<>
+struct Serializer<swri_console::RawLogMessage>
+{
+  template<typename Stream>
+  inline static void write(Stream& stream, const swri_console::RawLogMessage& msg)
+  {
+    if (!msg.data.empty()) {
+      memcpy(stream.advance(msg.data.size()), &msg.data[0], msg.data.size());
+    }
+  }
+
+  template<typename Stream>
+  inline static void read(Stream& stream, swri_console::RawLogMessage& msg)
+  {
+    // The stream holds exactly one message.
+    msg.data.resize(stream.getLength());
+    if (!msg.data.empty()) {
+      memcpy(&msg.data[0], stream.advance(msg.data.size()), msg.data.size());
+    }
+  }
+
+  inline static uint32_t serializedLength(const swri_console::RawLogMessage& msg)
+  {
+    return msg.data.size();
+  }
+};
+}  // namespace serialization
+}  // namespace ros
+#endif  // SWRI_CONSOLE_RAW_LOG_MESSAGE_H_
@@ -0,0 +1,94 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_REMOTE_ROS_SOURCE_H_
+#define SWRI_CONSOLE_REMOTE_ROS_SOURCE_H_
+
+#include <QString>
+#include <QThread>
+#include <swri_console/ingest_monitor.h>
+#include <swri_console/log_source.h>
+
+namespace swri_console
+{
+class RemoteRosSourceBackend;
+
+/*
+ * RemoteRosSource follows the logs of a ROS master other than the one
+ * the console itself is connected to.  It runs in the GUI thread and
+ * hides the relay process and decoding in a RemoteRosSourceBackend on
+ * a thread of its own.
+ */
+class RemoteRosSource : public LogSource
+{
+  Q_OBJECT;
+
+ public:
+  // label names the source and prefixes its node names.  Entries are
+  // tagged with source.
+  RemoteRosSource(const QString &label, const QString &master_uri,
+                  uint16_t source, QObject *parent=NULL);
+  ~RemoteRosSource();
+
+  void start();
+
+  QString name() const { return label_; }
+  const QString& label() const { return label_; }
+  const QString& masterUri() const { return master_uri_; }
+  bool isConnected() const { return connected_; }
+
+  // Short description of the source's state for the status bar.
+  QString statusText() const;
+
+ Q_SIGNALS:
+  void statusChanged();
+
+ protected:
+  void halt();
+
+ private Q_SLOTS:
+  void handleConnected(bool connected);
+  void handleBatch(const swri_console::LogBatchPtr &batch);
+  void handleIngestStats(const swri_console::IngestStats &stats);
+
+ private:
+  const QString label_;
+  const QString master_uri_;
+  const uint16_t source_;
+
+  QThread thread_;
+  RemoteRosSourceBackend *backend_;
+
+  bool connected_;
+  // Messages the relay lost and the backend shed count as drops.
+  IngestStats ingest_stats_;
+};  // class RemoteRosSource
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_REMOTE_ROS_SOURCE_H_
@@ -0,0 +1,113 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_REMOTE_ROS_SOURCE_BACKEND_H_
+#define SWRI_CONSOLE_REMOTE_ROS_SOURCE_BACKEND_H_
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QTimer>
+#include <boost/shared_ptr.hpp>
+#include <swri_console/ingest_monitor.h>
+#include <swri_console/log_database.h>
+#include <swri_console/ros_relay.h>
+
+namespace swri_console
+{
+/*
+ * RemoteRosSourceBackend runs a relay process (see ros_relay.h) for
+ * one ROS master and decodes its output into batches of entries.  The
+ * entries are tagged with the source's id, and their node names are
+ * prefixed with "label:" so that nodes of different masters stay
+ * apart.  It lives in a thread of its own, so decoding does not load
+ * the GUI thread, and restarts the relay with a backoff whenever it
+ * exits.  The size of each batch is added to backlog, and the
+ * RemoteRosSource takes it off again as it delivers them.
+ *
+ * Like the local source's serialized path, sequence gaps of the
+ * relayed /rosout_agg are tracked and DEBUG and INFO messages are
+ * shed as the backlog grows (see IngestMonitor).
+ *
+ * While the backlog is at LogSource::MAX_BACKLOG the backend stops
+ * decoding, and checks again on a timer.  QProcess keeps draining the
+ * relay's pipe in the meantime, so the output waits in its buffer as
+ * serialized frames, which are much smaller than decoded entries.
+ */
+class RemoteRosSourceBackend : public QObject
+{
+  Q_OBJECT;
+
+ public:
+  RemoteRosSourceBackend(const QString &label, const QString &master_uri, uint16_t source,
+                         const boost::shared_ptr<QAtomicInt> &backlog);
+  ~RemoteRosSourceBackend();
+
+ Q_SIGNALS:
+  void connected(bool connected);
+  void batchRead(const swri_console::LogBatchPtr &batch);
+  // Emitted at most every few hundred ms while the counts change.
+  void ingestStatsUpdated(const swri_console::IngestStats &stats);
+
+ public Q_SLOTS:
+  // Starts the relay.  Call this from the backend's thread.
+  void start();
+  // Stops the relay for good.
+  void stop();
+
+ private Q_SLOTS:
+  void readOutput();
+  void relayFinished();
+  void emitIngestStats();
+
+ protected:
+  void timerEvent(QTimerEvent *event);
+
+ private:
+  void startRelay();
+
+  const QString label_;
+  const QString master_uri_;
+  const uint16_t source_;
+  boost::shared_ptr<QAtomicInt> backlog_;
+
+  QProcess *process_;
+  RelayFrameReader reader_;
+  IngestMonitor ingest_monitor_;
+  QTimer stats_timer_;
+  bool stopped_;
+  bool connected_;
+  int retry_interval_;
+  int restart_timer_id_;
+  int resume_timer_id_;
+};  // class RemoteRosSourceBackend
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_REMOTE_ROS_SOURCE_BACKEND_H_
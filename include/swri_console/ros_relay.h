@@ -0,0 +1,94 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_ROS_RELAY_H_
+#define SWRI_CONSOLE_ROS_RELAY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace swri_console
+{
+/*
+ * roscpp only supports one ROS master per process, so each additional
+ * master is followed by a relay: a child process running
+ * "swri_console --relay" with ROS_MASTER_URI set to that master.  The
+ * relay subscribes to /rosout_agg in serialized form and writes what
+ * it receives to its stdout as a stream of frames:
+ *
+ *   uint8_t   type (RelayFrameType)
+ *   uint32_t  size, little endian
+ *   uint8_t   data[size]
+ *
+ * The relay exits when it loses the master, and is restarted by its
+ * parent (see RemoteRosSourceBackend).
+ */
+enum RelayFrameType
+{
+  // data: the master URI.
+  RELAY_CONNECTED = 1,
+  // data: a serialized rosgraph_msgs/Log.
+  RELAY_MESSAGE = 2
+};
+
+// Command line argument that runs the relay instead of the GUI.
+extern const char RELAY_ARGUMENT[];
+
+// Size of a frame's header.
+static const size_t RELAY_HEADER_SIZE = 5;
+
+// Parses the frame at the start of data.  Returns false if data does
+// not hold a complete frame.
+bool parseRelayFrame(const uint8_t *data, size_t size,
+                     uint8_t *type, const uint8_t **frame, uint32_t *frame_size);
+
+// Parses frames from a stream of bytes.
+class RelayFrameReader
+{
+ public:
+  RelayFrameReader();
+
+  // Adds bytes read from the stream.
+  void append(const char *data, size_t size);
+
+  // Gets the next complete frame.  data and size are valid until the
+  // next call to append().  Returns false if there is none.
+  bool next(uint8_t *type, const uint8_t **data, uint32_t *size);
+
+ private:
+  std::vector<uint8_t> buffer_;
+  size_t pos_;
+};
+
+// Runs the relay process.  Returns the process's exit code.
+int runRelay(int argc, char **argv);
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_ROS_RELAY_H_
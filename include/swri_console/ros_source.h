@@ -30,19 +30,21 @@
 #ifndef SWRI_CONSOLE_ROS_SOURCE_H_
 #define SWRI_CONSOLE_ROS_SOURCE_H_
 
-#include <QObject>
 #include <QThread>
 #include <rosgraph_msgs/Log.h>
+#include <swri_console/ingest_monitor.h>
+#include <swri_console/log_source.h>
 
 namespace swri_console
 {
+class MasterMonitor;
 class RosSourceBackend;
 
 /* RosSource is the interface class for interacting with ROS.  It runs
  * in the GUI thread and hides all the actual interactions with ROS in
  * a different thread in the RosSourceBackend.
  */
-class RosSource : public QObject
+class RosSource : public LogSource
 {
   Q_OBJECT;
 
@@ -72,6 +74,11 @@ class RosSource : public QObject
    */
   const QString& masterUri() const { return master_uri_; }
 
+  /*
+   * Return the most recent counts of lost and shed messages.
+   */
+  const IngestStats& ingestStats() const { return ingest_stats_; }
+
   /*
    * Called to start the source.  If the source has already been
    * started, this will do nothing.  I'm not sure if it safe to
@@ -81,6 +88,7 @@ class RosSource : public QObject
    */
   void start();
 
+  QString name() const { return "ROS"; }
 
  Q_SIGNALS:
   /**
@@ -89,10 +97,9 @@ class RosSource : public QObject
   void connected(bool connected, const QString &mater_uri);
 
   /**
-   * Emitted every time a log message is received.  This can be emitted multiple times per spin of
-   * the ROS core; wait until spun() is emitted to do any processing on them.
+   * Emitted when the counts of lost or shed messages change.
    */
-  void logReceived(const rosgraph_msgs::LogConstPtr &msg);
+  void ingestStatsUpdated(const swri_console::IngestStats &stats);
 
 
  private Q_SLOTS:
@@ -101,17 +108,23 @@ class RosSource : public QObject
   // and so will be queued.
   void handleConnected(bool connected, QString uri);
 
-  // Used internally to receive log messages from the ROS source
-  // backend.  This connection is between two different threads and so
-  // will be queued.
-  void handleLog(const rosgraph_msgs::LogConstPtr &msg);
+  // Used internally to receive batches of log messages from the ROS
+  // source backend, so that they can be taken off its backlog.
+  void handleBatch(const swri_console::LogBatchPtr &batch);
+
+  void handleIngestStats(const swri_console::IngestStats &stats);
 
  private:
   QThread ros_thread_;
   RosSourceBackend *backend_;
 
+  QThread monitor_thread_;
+  MasterMonitor *monitor_;
+
   bool connected_;
   QString master_uri_;
+
+  IngestStats ingest_stats_;
 };  // class RosSource
 }  // namespace swri_console
 #endif //SWRI_CONSOLE_ROS_SOURCE_H_
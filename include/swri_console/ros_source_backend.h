@@ -30,35 +30,98 @@
 #ifndef SWRI_CONSOLE_ROS_SOURCE_BACKEND_H_
 #define SWRI_CONSOLE_ROS_SOURCE_BACKEND_H_
 
+#include <string>
+#include <vector>
+#include <QAtomicInt>
+#include <QMutex>
 #include <QObject>
+#include <QTimer>
+#include <boost/shared_ptr.hpp>
+#include <ros/callback_queue.h>
+#include <ros/message_event.h>
+#include <ros/spinner.h>
 #include <ros/subscriber.h>
 #include <rosgraph_msgs/Log.h>
+#include <swri_console/ingest_monitor.h>
+#include <swri_console/log_database.h>
+#include <swri_console/raw_log_message.h>
 
 namespace swri_console
 {
+/*
+ * RosSourceBackend subscribes to /rosout_agg while the ROS master is
+ * up.  The subscription has a callback queue of its own that is
+ * serviced by an AsyncSpinner, so messages are delivered as soon as
+ * they arrive rather than on a polling interval.  Whether the master
+ * is up is decided elsewhere (see MasterMonitor) and passed in with
+ * setMasterStatus(), so a slow master does not delay messages.
+ *
+ * If the RAW_ROSOUT_SUBSCRIPTION setting is on (the default), the
+ * messages are received in serialized form (see raw_log_message.h).
+ * Otherwise they are deserialized by roscpp.  The setting is read each
+ * time the backend connects.  Either way, the spinner only queues the
+ * messages, and they are converted in batches on the backend's thread
+ * and delivered with batchRead().
+ *
+ * Sequence gaps are tracked per publisher, and DEBUG and INFO
+ * messages are shed when the backlog grows (see IngestMonitor).  The
+ * backlog counts the messages waiting to be converted plus those in
+ * the shared counter, which the receiver of batchRead() decrements as
+ * it takes batches.
+ */
 class RosSourceBackend : public QObject
 {
   Q_OBJECT;
 
  public:
-  RosSourceBackend();
+  explicit RosSourceBackend(const boost::shared_ptr<QAtomicInt> &backlog);
   ~RosSourceBackend();
 
  Q_SIGNALS:
   void connected(bool connected, QString master_uri);
-  void logReceived(const rosgraph_msgs::LogConstPtr &msg);
+  void batchRead(const swri_console::LogBatchPtr &batch);
+  // Emitted at most every few hundred ms while the counts change.
+  void ingestStatsUpdated(const swri_console::IngestStats &stats);
+
+ public Q_SLOTS:
+  void setMasterStatus(bool is_up);
+
+ private Q_SLOTS:
+  void decodePendingLogs();
+  void emitIngestStats();
 
  private:
   void startRos();
   void stopRos();
 
-  void timerEvent(QTimerEvent *event);
-
-  void handleLog(const rosgraph_msgs::LogConstPtr &msg);
+  void handleLog(const ros::MessageEvent<rosgraph_msgs::Log const> &event);
+  void handleRawLog(const ros::MessageEvent<RawLogMessage const> &event);
+  void queueLog(const std::string &publisher,
+                const rosgraph_msgs::LogConstPtr &msg,
+                const RawLogMessageConstPtr &raw);
 
  private:  
+  ros::CallbackQueue callback_queue_;
+  boost::shared_ptr<ros::AsyncSpinner> spinner_;
   ros::Subscriber rosout_sub_;
   bool is_connected_;
+
+  // A received message.  Only one of msg (deserialized) and raw
+  // (serialized) is set.
+  struct PendingLog
+  {
+    rosgraph_msgs::LogConstPtr msg;
+    RawLogMessageConstPtr raw;
+    std::string publisher;
+  };
+
+  // Messages waiting to be converted.  Filled by the spinner's thread.
+  QMutex pending_mutex_;
+  std::vector<PendingLog> pending_;
+
+  boost::shared_ptr<QAtomicInt> backlog_;
+  IngestMonitor ingest_monitor_;
+  QTimer stats_timer_;
 };  // class RosSourceBackend
 }  // namespace swri_console
 #endif  // SWRI_CONSOLE_ROS_SOURCE_BACKEND_H_
@@ -0,0 +1,103 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_SCAN_UTIL_H_
+#define SWRI_CONSOLE_SCAN_UTIL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace swri_console
+{
+/*
+ * Primitives shared by the text parsers (text_log_parser.cpp and
+ * syslog_parser.cpp).  They scan a buffer in place between p and end,
+ * and the ones that take p by reference advance it past what they
+ * matched.
+ */
+namespace scan_util
+{
+inline bool isDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+// Parses an unsigned decimal number at p, advancing p past it.
+// Fails if there are no digits or more than max_digits.
+inline bool parseNumber(const char *&p, const char *end, size_t max_digits, uint64_t *value)
+{
+  const char *start = p;
+  *value = 0;
+  while (p < end && isDigit(*p)) {
+    if (static_cast<size_t>(p - start) == max_digits) {
+      return false;
+    }
+    *value = *value * 10 + (*p - '0');
+    p++;
+  }
+  return p != start;
+}
+
+// Parses the digits of a fraction of a second at p (the part after
+// the '.') as nanoseconds.  Fails if there are no digits or more
+// than nine.
+inline bool parseNanoseconds(const char *&p, const char *end, uint64_t *nsec)
+{
+  const char *start = p;
+  if (!parseNumber(p, end, 9, nsec)) {
+    return false;
+  }
+  for (size_t digits = p - start; digits < 9; digits++) {
+    *nsec *= 10;
+  }
+  return true;
+}
+
+// Advances p past str if the buffer starts with it.
+inline bool expect(const char *&p, const char *end, const char *str)
+{
+  size_t len = strlen(str);
+  if (static_cast<size_t>(end - p) < len || memcmp(p, str, len) != 0) {
+    return false;
+  }
+  p += len;
+  return true;
+}
+
+// Returns the first c in [p, end), or end if there is none.
+inline const char *find(const char *p, const char *end, char c)
+{
+  const void *result = memchr(p, c, end - p);
+  return result ? static_cast<const char*>(result) : end;
+}
+}  // namespace scan_util
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_SCAN_UTIL_H_
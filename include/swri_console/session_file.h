@@ -0,0 +1,150 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_SESSION_FILE_H_
+#define SWRI_CONSOLE_SESSION_FILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include <QByteArray>
+#include <QFile>
+#include <QIODevice>
+#include <QString>
+#include <swri_console/log_database.h>
+
+namespace swri_console
+{
+/*
+ * Session files (*.swrilog) are swri_console's native format for
+ * saving and reopening the log database.  Bag files remain the
+ * interchange format.  Unlike a bag, a session file is laid out so
+ * that it can be memory-mapped and read in place:
+ *
+ *   header         SessionFileHeader
+ *   records        SessionFileRecord[entry_count], in database order
+ *   text           UTF-8 message text, lines joined with '\n'
+ *   string table   uint64_t[string_count + 1] offsets, then the bytes
+ *
+ * Node, file and function names are interned in the string table.
+ * Sections are aligned to 8 bytes, and all values are stored in the
+ * writer's byte order, which the reader checks with byte_order.
+ *
+ * Opening a file only maps it and checks its header and section
+ * bounds; records are checked when they are read.  Loading a file
+ * into the database still decodes every record into a LogEntry (see
+ * SessionSource), so that part grows with the file.
+ */
+struct SessionFileHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t entry_count;
+  uint64_t records_offset;
+  uint64_t text_offset;
+  uint64_t text_size;
+  uint64_t strings_offset;
+  uint64_t string_count;
+};
+
+struct SessionFileRecord
+{
+  uint32_t sec;
+  uint32_t nsec;
+  uint32_t seq;
+  uint32_t line;
+  uint32_t node;
+  uint32_t file;
+  uint32_t function;
+  uint32_t text_length;
+  uint64_t text_offset;
+  uint8_t level;
+  uint8_t reserved[7];
+};
+
+// Writes entries to a session file.  Returns an error message, or an
+// empty string on success.
+QString writeSessionFile(const QString &filename, const std::vector<LogEntry> &entries);
+
+// Writes entries in the session file format to a seekable device.
+QString writeSessionData(QIODevice &device, const std::vector<LogEntry> &entries);
+
+// Encodes entries in the session file format in memory.  Returns an
+// empty array on failure.
+QByteArray encodeSessionData(const std::vector<LogEntry> &entries);
+
+// Decodes session data held in memory, e.g. a block received from a
+// LogServer, and appends its entries to entries, tagged with source.
+// Records that can not be decoded are skipped.  Returns an error
+// message, or an empty string on success.
+QString decodeSessionData(const QByteArray &data, uint16_t source,
+                          std::vector<LogEntry> *entries);
+
+/*
+ * Read access to a memory-mapped session file.  The accessors may be
+ * called from any thread once open() has succeeded.
+ */
+class SessionFileReader
+{
+ public:
+  SessionFileReader();
+  ~SessionFileReader();
+
+  // Maps and validates the file.  Returns an error message, or an
+  // empty string on success.
+  QString open(const QString &filename);
+  // Reads session data held in memory, e.g. received from a
+  // LogServer.  The reader keeps a reference to data.
+  QString open(const QByteArray &data);
+
+  size_t size() const { return header_ ? header_->entry_count : 0; }
+
+  // Decodes record i.  Returns false if the record refers to data
+  // outside of the file or has an invalid stamp.
+  bool decode(size_t i, LogEntry *entry) const;
+
+ private:
+  QString validate();
+  bool getString(uint32_t id, std::string *str) const;
+
+  QFile file_;
+  QByteArray buffer_;
+  const uchar *data_;
+  size_t data_size_;
+  const SessionFileHeader *header_;
+  const SessionFileRecord *records_;
+  const char *text_;
+  const uint64_t *string_offsets_;
+  const char *strings_;
+  size_t strings_size_;
+};
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_SESSION_FILE_H_
@@ -0,0 +1,85 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_SESSION_SOURCE_H_
+#define SWRI_CONSOLE_SESSION_SOURCE_H_
+
+#include <deque>
+#include <QFuture>
+#include <QObject>
+#include <boost/shared_ptr.hpp>
+#include <swri_console/log_database.h>
+#include <swri_console/log_source.h>
+
+namespace swri_console
+{
+class SessionFileReader;
+
+/*
+ * SessionSource reads a session file saved by swri_console.  The file
+ * is memory-mapped and its records are decoded in chunks on the
+ * global thread pool.  The chunks are delivered in file order.  Every
+ * record becomes a LogEntry in the database, so the load time grows
+ * with the file, but none of the decoding happens on the GUI thread.
+ */
+class SessionSource : public LogSource
+{
+  Q_OBJECT;
+
+ public:
+  // Entries are tagged with source.
+  SessionSource(const QString &filename, uint16_t source);
+  // Waits for any chunks that are still being decoded.
+  ~SessionSource();
+
+  void start();
+
+  const QString &filename() const { return filename_; }
+  QString name() const { return filename_; }
+
+ protected:
+  void timerEvent(QTimerEvent *);
+  void halt();
+
+ private:
+  typedef boost::shared_ptr<SessionFileReader> ReaderPtr;
+
+  static LogBatchPtr decodeChunk(ReaderPtr reader, size_t begin, size_t end, uint16_t source);
+  void startChunks();
+
+  const QString filename_;
+  const uint16_t source_;
+  ReaderPtr reader_;
+  std::deque<QFuture<LogBatchPtr> > chunks_;
+  size_t next_record_;
+  int timer_id_;
+};  // class SessionSource
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_SESSION_SOURCE_H_
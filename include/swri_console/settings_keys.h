@@ -63,6 +63,12 @@ namespace swri_console
     static const QString FATAL_COLOR;
     static const QString COLORIZE_LOGS;
     static const QString ALTERNATE_LOG_ROW_COLORS;
+    static const QString COLLAPSE_MULTILINE;
+    static const QString MAX_LINE_LENGTH;
+    static const QString PREVIEW_LARGE_BAGS;
+    static const QString RAW_ROSOUT_SUBSCRIPTION;
+    static const QString REMOTE_MASTERS;
+    static const QString SYSLOG_ADDRESSES;
   };
 }
 
@@ -0,0 +1,73 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_SYSLOG_PARSER_H_
+#define SWRI_CONSOLE_SYSLOG_PARSER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ros/time.h>
+#include <swri_console/log_database.h>
+
+namespace swri_console
+{
+/*
+ * Parser for syslog messages as they are sent in UDP datagrams (RFC
+ * 5426).  Both the current format (RFC 5424):
+ *
+ *   <165>1 2003-10-11T22:14:15.003Z host app 1234 ID47 [id@1 a="b"] message
+ *
+ * and the older BSD format (RFC 3164), which is what most embedded
+ * loggers and log4cxx's SyslogAppender (and so rosconsole) send:
+ *
+ *   <34>Oct 11 22:14:15 host app[1234]: message
+ *
+ * are recognized.  Entries are named "host:/app" after the sender, or
+ * "host:/facility" when the message has no application name.  The
+ * facility is kept as the entry's file and the process id as its
+ * function, so that they show up in the location.
+ */
+
+// Maps a syslog severity (0 = emergency to 7 = debug) onto the rosout
+// levels.
+uint8_t syslogSeverityLevel(int severity);
+
+// Returns the name of a syslog facility (0-23), e.g. "daemon" or
+// "local3".
+const char* syslogFacilityName(int facility);
+
+// Parses one message into entry.  Anything that is not recognized is
+// kept as the text of a user.notice message, as RFC 3164 asks of
+// relays.  received is the stamp of messages that do not have one, and
+// picks the year of BSD timestamps, which do not include it.
+void parseSyslogMessage(const char *data, size_t size,
+                        const ros::Time &received, LogEntry *entry);
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_SYSLOG_PARSER_H_
@@ -0,0 +1,93 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_SYSLOG_SOURCE_H_
+#define SWRI_CONSOLE_SYSLOG_SOURCE_H_
+
+#include <stdint.h>
+#include <QString>
+#include <QThread>
+#include <swri_console/log_source.h>
+
+namespace swri_console
+{
+class SyslogSourceBackend;
+
+/*
+ * SyslogSource receives syslog messages over UDP, e.g. from
+ * controllers and other processes that don't use ROS, or from
+ * rosconsole's log4cxx SyslogAppender.  It runs in the GUI thread and
+ * hides the socket and parsing in a SyslogSourceBackend on a thread of
+ * its own.
+ *
+ * It can be tried out on one machine with, for example:
+ *   logger -n 127.0.0.1 -P 5140 -d "hello"
+ */
+class SyslogSource : public LogSource
+{
+  Q_OBJECT;
+
+ public:
+  // address is "[host:]port", with IPv6 hosts in brackets.  Without a
+  // host the source listens on all interfaces.  Entries are tagged
+  // with source.
+  SyslogSource(const QString &address, uint16_t source, QObject *parent=NULL);
+  ~SyslogSource();
+
+  // Opens the socket and starts receiving.  Finishes with an error if
+  // the socket can not be opened.
+  void start();
+
+  QString name() const { return address_; }
+  const QString& address() const { return address_; }
+
+  // Short description of the source's state for the status bar.
+  QString statusText() const;
+
+ Q_SIGNALS:
+  void statusChanged();
+
+ protected:
+  void halt();
+
+ private Q_SLOTS:
+  void handleBatch(const swri_console::LogBatchPtr &batch, size_t bytes, size_t dropped);
+
+ private:
+  int openSocket(QString *error_msg) const;
+
+  const QString address_;
+  const uint16_t source_;
+
+  QThread thread_;
+  SyslogSourceBackend *backend_;
+};  // class SyslogSource
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_SYSLOG_SOURCE_H_
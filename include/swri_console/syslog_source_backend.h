@@ -0,0 +1,110 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_SYSLOG_SOURCE_BACKEND_H_
+#define SWRI_CONSOLE_SYSLOG_SOURCE_BACKEND_H_
+
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <vector>
+#include <QAtomicInt>
+#include <QObject>
+#include <boost/shared_ptr.hpp>
+#include <swri_console/log_database.h>
+
+QT_BEGIN_NAMESPACE
+class QSocketNotifier;
+QT_END_NAMESPACE
+
+namespace swri_console
+{
+/*
+ * SyslogSourceBackend receives syslog datagrams on a bound UDP socket
+ * and parses them into batches of entries (see syslog_parser.h).  It
+ * lives in a thread of its own.  Each time the socket becomes readable
+ * it is drained with recvmmsg(), which takes many datagrams per system
+ * call, so the rate is bound by parsing rather than by system calls.
+ *
+ * The size of each batch is added to backlog, and the SyslogSource
+ * takes it off again as it delivers them.  While the backlog is at
+ * LogSource::MAX_BACKLOG the backend stops reading.  Datagrams then
+ * wait in the socket's receive buffer, and the number the kernel had
+ * to drop is reported with the next batch.
+ */
+class SyslogSourceBackend : public QObject
+{
+  Q_OBJECT;
+
+ public:
+  // Takes ownership of fd, a bound, non-blocking UDP socket.  Entries
+  // are tagged with source.
+  SyslogSourceBackend(int fd, uint16_t source, const boost::shared_ptr<QAtomicInt> &backlog);
+  ~SyslogSourceBackend();
+
+ Q_SIGNALS:
+  // bytes is the size of the datagrams, and dropped the number of
+  // datagrams the kernel discarded since the previous batch.
+  void batchRead(const swri_console::LogBatchPtr &batch, size_t bytes, size_t dropped);
+
+ public Q_SLOTS:
+  // Starts reading.  Call this from the backend's thread.
+  void start();
+  // Closes the socket for good.
+  void stop();
+
+ private Q_SLOTS:
+  void readDatagrams();
+
+ protected:
+  void timerEvent(QTimerEvent *event);
+
+ private:
+  size_t takeDrops(struct msghdr *header);
+
+  int fd_;
+  const uint16_t source_;
+  boost::shared_ptr<QAtomicInt> backlog_;
+
+  QSocketNotifier *notifier_;
+  int resume_timer_id_;
+
+  // Buffers for recvmmsg(), one datagram and its control message
+  // each.
+  std::vector<char> data_;
+  std::vector<char> control_;
+  std::vector<struct iovec> iovecs_;
+  std::vector<struct mmsghdr> headers_;
+
+  // The kernel's count of dropped datagrams at the last batch.
+  uint32_t drop_counter_;
+};  // class SyslogSourceBackend
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_SYSLOG_SOURCE_BACKEND_H_
@@ -0,0 +1,81 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_TEXT_LOG_PARSER_H_
+#define SWRI_CONSOLE_TEXT_LOG_PARSER_H_
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <swri_console/log_database.h>
+
+namespace swri_console
+{
+/*
+ * Parser for the text log files written by ROS, usually found in
+ * ~/.ros/log.  Three line formats are recognized:
+ *
+ *   rosout.log (written by the rosout node):
+ *     1530000000.123456789 INFO /node [file.cpp:12(function)] [topics: /rosout] message
+ *
+ *   rospy node logs:
+ *     [rosout][INFO] 2018-06-26 12:00:00,123: message
+ *
+ *   roscpp console output (e.g. *-stdout.log):
+ *     [ INFO] [1530000000.123456789]: message
+ *
+ * A record starts with a line in one of these formats.  Any following
+ * lines that do not are continuation lines of the record's message.
+ * Node names are taken from the line when the format has one, and
+ * otherwise from default_node.
+ *
+ * The functions work on a buffer in memory (e.g. a mapped file), so
+ * independent ranges of it can be parsed concurrently.
+ */
+
+// Returns the offset of the first record that starts at or after pos,
+// or size if there is none.  Use this to split a buffer into ranges
+// that can be parsed separately.
+size_t findTextLogRecord(const char *data, size_t size, size_t pos);
+
+// Parses the records that start in [begin, end) and appends them to
+// entries.  begin must be the start of a record (or 0).  The last
+// record's continuation lines may extend past end.  Returns the number
+// of lines that were not part of any record (i.e. before the first).
+size_t parseTextLog(const char *data, size_t size,
+                    size_t begin, size_t end,
+                    const std::string &default_node,
+                    std::vector<LogEntry> *entries);
+
+// Derives a node name from a log file name, e.g. "talker-1.log" ->
+// "/talker".
+std::string nodeNameFromLogFile(const std::string &filename);
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_TEXT_LOG_PARSER_H_
@@ -0,0 +1,98 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_TEXT_LOG_SOURCE_H_
+#define SWRI_CONSOLE_TEXT_LOG_SOURCE_H_
+
+#include <deque>
+#include <string>
+#include <QFile>
+#include <QFuture>
+#include <QObject>
+#include <boost/shared_ptr.hpp>
+#include <swri_console/log_database.h>
+#include <swri_console/log_source.h>
+
+namespace swri_console
+{
+/*
+ * TextLogSource reads a ROS text log file (see text_log_parser.h).
+ * The file is memory-mapped and split into ranges at record
+ * boundaries, which are parsed concurrently on the global thread
+ * pool and delivered in file order.
+ */
+class TextLogSource : public LogSource
+{
+  Q_OBJECT;
+
+ public:
+  // Entries are tagged with source.
+  TextLogSource(const QString &filename, uint16_t source);
+  // Waits for any ranges that are still being parsed.
+  ~TextLogSource();
+
+  void start();
+
+  const QString &filename() const { return filename_; }
+  QString name() const { return filename_; }
+
+ protected:
+  void timerEvent(QTimerEvent *);
+  void halt();
+
+ private:
+  // The mapped file, shared with the parsing tasks.
+  struct MappedFile {
+    QFile file;
+    const char *data;
+    size_t size;
+  };
+  typedef boost::shared_ptr<MappedFile> MappedFilePtr;
+
+  // A range of the file being parsed.
+  struct Range {
+    QFuture<LogBatchPtr> batch;
+    size_t size;
+  };
+
+  static LogBatchPtr parseRange(MappedFilePtr file, size_t begin, size_t end,
+                                std::string default_node, uint16_t source);
+  void startRanges();
+
+  const QString filename_;
+  const uint16_t source_;
+  const std::string default_node_;
+  MappedFilePtr file_;
+  std::deque<Range> ranges_;
+  size_t next_offset_;
+  int timer_id_;
+};  // class TextLogSource
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_TEXT_LOG_SOURCE_H_
@@ -0,0 +1,110 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#ifndef SWRI_CONSOLE_TEXT_LOG_TAIL_SOURCE_H_
+#define SWRI_CONSOLE_TEXT_LOG_TAIL_SOURCE_H_
+
+#include <map>
+#include <string>
+#include <QObject>
+#include <QTimer>
+#include <swri_console/log_database.h>
+#include <swri_console/log_source.h>
+
+QT_BEGIN_NAMESPACE
+class QSocketNotifier;
+QT_END_NAMESPACE
+
+namespace swri_console
+{
+/*
+ * TextLogTailSource follows the text log files (*.log) in a directory,
+ * e.g. ~/.ros/log/latest, and reads records as they are appended.
+ *
+ * Changes are detected with inotify, so nothing runs while the files
+ * are idle.  Only new bytes are parsed.  New files are read from the
+ * start, files that existed when following began are read from their
+ * current end, and files that are truncated or replaced (log rotation)
+ * are read again from the start.
+ *
+ * Since a record's continuation lines may still be on their way, the
+ * last record of each file is held back until the next record starts
+ * or the file has been quiet for a short time.
+ */
+class TextLogTailSource : public LogSource
+{
+  Q_OBJECT;
+
+ public:
+  // Entries are tagged with source.
+  TextLogTailSource(const QString &directory, uint16_t source, QObject *parent=NULL);
+  ~TextLogTailSource();
+
+  // Starts following the directory.  Finishes with an error if it
+  // can not be watched.
+  void start();
+
+  const QString &directory() const { return directory_; }
+  QString name() const { return directory_; }
+
+ protected:
+  void halt();
+
+ private Q_SLOTS:
+  void readEvents();
+  void flushPending();
+
+ private:
+  struct TailedFile
+  {
+    int fd;
+    size_t offset;
+    std::string node;
+    // Bytes read but not yet parsed: a partial line and/or the last
+    // record, which may still receive continuation lines.
+    std::string pending;
+  };
+
+  void openFile(const std::string &name, bool from_end);
+  void closeFile(const std::string &name, const LogBatchPtr &batch);
+  void readFile(TailedFile &file, const LogBatchPtr &batch);
+  void parsePending(TailedFile &file, bool flush, const LogBatchPtr &batch);
+  void closeAll(const LogBatchPtr &batch);
+
+  const QString directory_;
+  const uint16_t source_;
+
+  int inotify_fd_;
+  QSocketNotifier *notifier_;
+  std::map<std::string, TailedFile> files_;
+  QTimer flush_timer_;
+};  // class TextLogTailSource
+}  // namespace swri_console
+#endif  // SWRI_CONSOLE_TEXT_LOG_TAIL_SOURCE_H_
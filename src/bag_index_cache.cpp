@@ -0,0 +1,256 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/bag_index_cache.h>
+
+#include <string.h>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDesktopServices>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+namespace swri_console
+{
+static const char CACHE_MAGIC[8] = {'S', 'W', 'R', 'I', 'B', 'I', 'D', 'X'};
+static const uint32_t CACHE_VERSION = 1;
+static const uint32_t CACHE_BYTE_ORDER = 0x01020304;
+
+// Number of bytes at the start of a bag that are hashed.  This covers
+// the bag header record, which holds the position of the bag's index.
+static const qint64 HEADER_HASH_SIZE = 4096;
+
+// Layout of a cache file:
+//
+//   header     CacheHeader
+//   path       path_size bytes
+//   topic      topic_size bytes
+//   nodes      node_count * (uint32_t size, bytes)
+//   records    BagIndexRecord[record_count]
+struct CacheHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t bag_size;
+  int64_t bag_mtime;
+  char header_hash[20];
+  uint32_t path_size;
+  uint32_t topic_size;
+  uint32_t reserved;
+  uint64_t node_count;
+  uint64_t record_count;
+};
+
+// The identity of a bag file that a cache entry is checked against.
+struct BagIdentity
+{
+  QString path;
+  uint64_t size;
+  int64_t mtime;
+  QByteArray header_hash;
+};
+
+static bool getBagIdentity(const QString &bag_filename, BagIdentity *identity)
+{
+  QFileInfo info(bag_filename);
+  identity->path = info.canonicalFilePath();
+  if (identity->path.isEmpty()) {
+    return false;
+  }
+  identity->size = info.size();
+  identity->mtime = static_cast<int64_t>(info.lastModified().toTime_t()) * 1000 +
+    info.lastModified().time().msec();
+
+  QFile bag(identity->path);
+  if (!bag.open(QFile::ReadOnly)) {
+    return false;
+  }
+  identity->header_hash = QCryptographicHash::hash(bag.read(HEADER_HASH_SIZE),
+                                                   QCryptographicHash::Sha1);
+  return static_cast<size_t>(identity->header_hash.size()) ==
+    sizeof(CacheHeader().header_hash);
+}
+
+static QString cacheFilename(const QString &canonical_path)
+{
+  QDir dir(QDesktopServices::storageLocation(QDesktopServices::CacheLocation));
+  if (!dir.mkpath("bag_index")) {
+    return QString();
+  }
+  QByteArray name = QCryptographicHash::hash(canonical_path.toUtf8(),
+                                             QCryptographicHash::Sha1).toHex();
+  return dir.filePath("bag_index/" + QString::fromAscii(name) + ".idx");
+}
+
+static bool readString(QFile &file, size_t size, std::string *str)
+{
+  str->resize(size);
+  return size == 0 ||
+    file.read(&(*str)[0], size) == static_cast<qint64>(size);
+}
+
+bool loadBagMessageIndex(const QString &bag_filename, BagMessageIndex *index)
+{
+  BagIdentity identity;
+  if (!getBagIdentity(bag_filename, &identity)) {
+    return false;
+  }
+
+  QString cache_filename = cacheFilename(identity.path);
+  QFile file(cache_filename);
+  if (cache_filename.isEmpty() || !file.open(QFile::ReadOnly)) {
+    return false;
+  }
+
+  CacheHeader header;
+  if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) !=
+      static_cast<qint64>(sizeof(header)) ||
+      memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+      header.version != CACHE_VERSION ||
+      header.byte_order != CACHE_BYTE_ORDER ||
+      header.bag_size != identity.size ||
+      header.bag_mtime != identity.mtime ||
+      memcmp(header.header_hash, identity.header_hash.constData(),
+             sizeof(header.header_hash)) != 0) {
+    return false;
+  }
+
+  // Guard against a cache file that does not hold what its header
+  // claims before allocating for it.
+  const uint64_t records_size = header.record_count * sizeof(BagIndexRecord);
+  if (header.record_count > static_cast<uint64_t>(file.size()) / sizeof(BagIndexRecord) ||
+      header.node_count > static_cast<uint64_t>(file.size())) {
+    return false;
+  }
+
+  std::string path;
+  if (!readString(file, header.path_size, &path) ||
+      QString::fromUtf8(path.data(), path.size()) != identity.path ||
+      !readString(file, header.topic_size, &index->topic)) {
+    return false;
+  }
+
+  index->nodes.resize(header.node_count);
+  for (size_t i = 0; i < index->nodes.size(); i++) {
+    uint32_t size;
+    if (file.read(reinterpret_cast<char*>(&size), sizeof(size)) !=
+        static_cast<qint64>(sizeof(size)) ||
+        static_cast<qint64>(size) > file.size() ||
+        !readString(file, size, &index->nodes[i])) {
+      return false;
+    }
+  }
+
+  index->records.resize(header.record_count);
+  if (records_size > 0 &&
+      file.read(reinterpret_cast<char*>(&index->records[0]), records_size) !=
+      static_cast<qint64>(records_size)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < index->records.size(); i++) {
+    if (index->records[i].node >= index->nodes.size() ||
+        (i > 0 && index->records[i].time < index->records[i-1].time)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool saveBagMessageIndex(const QString &bag_filename, const BagMessageIndex &index)
+{
+  BagIdentity identity;
+  if (!getBagIdentity(bag_filename, &identity)) {
+    return false;
+  }
+
+  QString cache_filename = cacheFilename(identity.path);
+  if (cache_filename.isEmpty()) {
+    return false;
+  }
+
+  QByteArray path = identity.path.toUtf8();
+
+  CacheHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+  header.version = CACHE_VERSION;
+  header.byte_order = CACHE_BYTE_ORDER;
+  header.bag_size = identity.size;
+  header.bag_mtime = identity.mtime;
+  memcpy(header.header_hash, identity.header_hash.constData(), sizeof(header.header_hash));
+  header.path_size = path.size();
+  header.topic_size = index.topic.size();
+  header.node_count = index.nodes.size();
+  header.record_count = index.records.size();
+
+  // Write to a temporary file and move it into place, so that readers
+  // never see a partial entry.
+  QString temp_filename = cache_filename + ".tmp";
+  QFile file(temp_filename);
+  if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+    return false;
+  }
+
+  bool ok =
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header)) ==
+    static_cast<qint64>(sizeof(header)) &&
+    file.write(path) == path.size() &&
+    file.write(index.topic.data(), index.topic.size()) == static_cast<qint64>(index.topic.size());
+
+  for (size_t i = 0; ok && i < index.nodes.size(); i++) {
+    uint32_t size = index.nodes[i].size();
+    ok = file.write(reinterpret_cast<const char*>(&size), sizeof(size)) ==
+      static_cast<qint64>(sizeof(size)) &&
+      file.write(index.nodes[i].data(), size) == static_cast<qint64>(size);
+  }
+
+  const qint64 records_size = index.records.size() * sizeof(BagIndexRecord);
+  if (ok && records_size > 0) {
+    ok = file.write(reinterpret_cast<const char*>(&index.records[0]), records_size) == records_size;
+  }
+
+  file.close();
+  if (!ok || file.error() != QFile::NoError) {
+    QFile::remove(temp_filename);
+    return false;
+  }
+
+  QFile::remove(cache_filename);
+  if (!QFile::rename(temp_filename, cache_filename)) {
+    QFile::remove(temp_filename);
+    return false;
+  }
+  return true;
+}
+}  // namespace swri_console
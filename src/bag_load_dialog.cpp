@@ -0,0 +1,283 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/bag_load_dialog.h>
+#include <swri_console/bag_source.h>
+
+#include <algorithm>
+
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QDoubleSpinBox>
+#include <QFileInfo>
+#include <QFormLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPushButton>
+#include <QRegExp>
+#include <QVBoxLayout>
+#include <rosgraph_msgs/Log.h>
+
+namespace swri_console
+{
+/*
+ * Draws the density histogram of a BagIndex with the selected range
+ * highlighted.  Dragging across the histogram selects a new range.
+ */
+class BagDensityWidget : public QWidget
+{
+ public:
+  BagDensityWidget(const BagIndex &index, BagLoadDialog *dialog)
+    :
+    QWidget(dialog),
+    index_(index),
+    dialog_(dialog),
+    span_((index.end_time - index.begin_time).toSec()),
+    start_(0.0),
+    end_(span_),
+    drag_start_(0.0)
+  {
+    setMinimumSize(400, 120);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+  }
+
+  void setSelection(double start, double end)
+  {
+    start_ = start;
+    end_ = end;
+    update();
+  }
+
+ protected:
+  void paintEvent(QPaintEvent *)
+  {
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+
+    if (span_ > 0.0) {
+      int x0 = offsetToX(start_);
+      int x1 = offsetToX(end_);
+      painter.fillRect(QRect(x0, 0, std::max(x1 - x0, 1), height()),
+                       palette().highlight().color().lighter(160));
+    }
+
+    const std::vector<size_t> &density = index_.density;
+    if (density.empty()) {
+      return;
+    }
+
+    const size_t max_count = *std::max_element(density.begin(), density.end());
+    if (max_count == 0) {
+      return;
+    }
+
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(palette().text());
+    for (size_t i = 0; i < density.size(); i++) {
+      int x0 = width() * i / density.size();
+      int x1 = width() * (i + 1) / density.size();
+      int h = static_cast<int>(static_cast<double>(height() - 2) * density[i] / max_count);
+      if (density[i] > 0) {
+        h = std::max(h, 1);
+      }
+      painter.drawRect(x0, height() - h, std::max(x1 - x0, 1), h);
+    }
+  }
+
+  void mousePressEvent(QMouseEvent *event)
+  {
+    if (event->button() == Qt::LeftButton) {
+      drag_start_ = xToOffset(event->pos().x());
+      dialog_->setRange(drag_start_, drag_start_);
+    }
+  }
+
+  void mouseMoveEvent(QMouseEvent *event)
+  {
+    if (event->buttons() & Qt::LeftButton) {
+      double offset = xToOffset(event->pos().x());
+      dialog_->setRange(std::min(drag_start_, offset),
+                        std::max(drag_start_, offset));
+    }
+  }
+
+ private:
+  int offsetToX(double offset) const
+  {
+    return static_cast<int>(offset / span_ * width());
+  }
+
+  double xToOffset(int x) const
+  {
+    x = std::max(0, std::min(x, width()));
+    return span_ * x / std::max(width(), 1);
+  }
+
+  const BagIndex &index_;
+  BagLoadDialog *dialog_;
+  double span_;
+  double start_;
+  double end_;
+  double drag_start_;
+};
+
+BagLoadDialog::BagLoadDialog(const BagIndex &index, BagSource *source, QWidget *parent)
+  :
+  QDialog(parent),
+  index_(index),
+  source_(source)
+{
+  setWindowTitle(tr("Load Bag File"));
+  setAttribute(Qt::WA_DeleteOnClose);
+
+  const double span = (index_.end_time - index_.begin_time).toSec();
+
+  summary_label_ = new QLabel(this);
+  density_widget_ = new BagDensityWidget(index_, this);
+
+  start_spin_ = new QDoubleSpinBox(this);
+  end_spin_ = new QDoubleSpinBox(this);
+  QDoubleSpinBox *spins[] = { start_spin_, end_spin_ };
+  for (size_t i = 0; i < 2; i++) {
+    spins[i]->setDecimals(3);
+    spins[i]->setRange(0.0, span);
+    spins[i]->setSuffix(tr(" s"));
+  }
+  start_spin_->setValue(0.0);
+  end_spin_->setValue(span);
+
+  nodes_edit_ = new QLineEdit(this);
+  nodes_edit_->setToolTip(tr("Space or comma separated node names.  "
+                             "Leave empty to load messages from all nodes."));
+
+  severity_combo_ = new QComboBox(this);
+  severity_combo_->addItem(tr("Debug"), rosgraph_msgs::Log::DEBUG);
+  severity_combo_->addItem(tr("Info"), rosgraph_msgs::Log::INFO);
+  severity_combo_->addItem(tr("Warn"), rosgraph_msgs::Log::WARN);
+  severity_combo_->addItem(tr("Error"), rosgraph_msgs::Log::ERROR);
+  severity_combo_->addItem(tr("Fatal"), rosgraph_msgs::Log::FATAL);
+
+  QFormLayout *form = new QFormLayout();
+  form->addRow(tr("Start offset:"), start_spin_);
+  form->addRow(tr("End offset:"), end_spin_);
+  form->addRow(tr("Nodes:"), nodes_edit_);
+  form->addRow(tr("Minimum severity:"), severity_combo_);
+
+  QDialogButtonBox *buttons = new QDialogButtonBox(this);
+  QPushButton *load_range = buttons->addButton(tr("Load Range"), QDialogButtonBox::AcceptRole);
+  QPushButton *load_all = buttons->addButton(tr("Load All"), QDialogButtonBox::ActionRole);
+  buttons->addButton(QDialogButtonBox::Cancel);
+  load_range->setDefault(true);
+
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->addWidget(summary_label_);
+  layout->addWidget(density_widget_, 1);
+  layout->addLayout(form);
+  layout->addWidget(buttons);
+
+  QObject::connect(buttons, SIGNAL(accepted()), this, SLOT(accept()));
+  QObject::connect(buttons, SIGNAL(rejected()), this, SLOT(reject()));
+  QObject::connect(this, SIGNAL(rejected()), source_, SLOT(cancel()));
+  QObject::connect(source_, SIGNAL(destroyed()), this, SLOT(deleteLater()));
+  QObject::connect(load_all, SIGNAL(clicked()), this, SLOT(loadAll()));
+  QObject::connect(start_spin_, SIGNAL(valueChanged(double)), this, SLOT(updateSummary()));
+  QObject::connect(end_spin_, SIGNAL(valueChanged(double)), this, SLOT(updateSummary()));
+
+  updateSummary();
+}
+
+ros::Time BagLoadDialog::startTime() const
+{
+  return index_.begin_time + ros::Duration(start_spin_->value());
+}
+
+ros::Time BagLoadDialog::endTime() const
+{
+  // The spin boxes round to milliseconds, so snap the end of the
+  // range to the end of the bag to avoid dropping the last messages.
+  if (end_spin_->value() >= end_spin_->maximum()) {
+    return index_.end_time;
+  }
+  return index_.begin_time + ros::Duration(end_spin_->value());
+}
+
+BagQuery BagLoadDialog::query() const
+{
+  BagQuery query(startTime(), endTime());
+
+  query.filter.min_level = severity_combo_->itemData(severity_combo_->currentIndex()).toInt();
+
+  QStringList nodes = nodes_edit_->text().split(QRegExp("[,\\s]+"), QString::SkipEmptyParts);
+  for (int i = 0; i < nodes.size(); i++) {
+    // Node names are always fully qualified in log messages.
+    QString node = nodes[i];
+    if (!node.startsWith('/')) {
+      node.prepend('/');
+    }
+    query.filter.nodes.insert(node.toStdString());
+  }
+
+  return query;
+}
+
+void BagLoadDialog::setRange(double start, double end)
+{
+  start_spin_->setValue(start);
+  end_spin_->setValue(end);
+}
+
+void BagLoadDialog::loadAll()
+{
+  setRange(start_spin_->minimum(), end_spin_->maximum());
+  nodes_edit_->clear();
+  severity_combo_->setCurrentIndex(0);
+  accept();
+}
+
+void BagLoadDialog::updateSummary()
+{
+  if (end_spin_->value() < start_spin_->value()) {
+    end_spin_->setValue(start_spin_->value());
+  }
+
+  density_widget_->setSelection(start_spin_->value(), end_spin_->value());
+
+  summary_label_->setText(
+    tr("%1\n%2 log messages over %3 seconds.\n"
+       "About %4 messages in the selected range.")
+    .arg(index_.filenames.size() == 1 ?
+         QFileInfo(index_.filenames[0]).fileName() :
+         tr("%1 bag files").arg(index_.filenames.size()))
+    .arg(index_.msg_count)
+    .arg((index_.end_time - index_.begin_time).toSec(), 0, 'f', 1)
+    .arg(index_.estimateCount(startTime(), endTime())));
+}
+}  // namespace swri_console
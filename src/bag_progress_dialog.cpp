@@ -0,0 +1,86 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/bag_progress_dialog.h>
+#include <swri_console/bag_source.h>
+
+#include <QFileInfo>
+
+namespace swri_console
+{
+// The progress bar is updated in tenths of a percent.
+static const int PROGRESS_STEPS = 1000;
+
+BagProgressDialog::BagProgressDialog(BagSource *source, QWidget *parent)
+  :
+  QProgressDialog(parent)
+{
+  if (source->filenames().size() == 1) {
+    name_ = QFileInfo(source->filenames()[0]).fileName();
+  } else {
+    name_ = source->name();
+  }
+
+  setWindowTitle(tr("Loading Bag Files"));
+  setLabelText(tr("Loading %1...").arg(name_));
+  setRange(0, PROGRESS_STEPS);
+  setValue(0);
+  setAutoClose(false);
+  setAutoReset(false);
+  setMinimumDuration(500);
+
+  QObject::connect(this, SIGNAL(canceled()), source, SLOT(cancel()));
+  QObject::connect(source, SIGNAL(progress(const swri_console::BagLoadProgress &)),
+                   this, SLOT(updateProgress(const swri_console::BagLoadProgress &)));
+  QObject::connect(source, SIGNAL(destroyed()), this, SLOT(deleteLater()));
+}
+
+QString BagProgressDialog::formatProgress(const BagLoadProgress &progress)
+{
+  QString text = QString("%1 of ~%2 messages read (%3 kept)\n"
+                         "%4 msg/s, %5 MB/s")
+    .arg(progress.msgs_read)
+    .arg(progress.msgs_total)
+    .arg(progress.msgs_kept)
+    .arg(progress.messagesPerSecond(), 0, 'f', 0)
+    .arg(progress.megabytesPerSecond(), 0, 'f', 1);
+
+  double remaining = progress.remainingSeconds();
+  if (remaining >= 0.0) {
+    text.append(QString(", %1 s remaining").arg(remaining, 0, 'f', 0));
+  }
+  return text;
+}
+
+void BagProgressDialog::updateProgress(const swri_console::BagLoadProgress &progress)
+{
+  setLabelText(tr("Loading %1...\n%2").arg(name_).arg(formatProgress(progress)));
+  setValue(static_cast<int>(progress.fraction() * PROGRESS_STEPS));
+}
+}  // namespace swri_console
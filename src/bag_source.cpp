@@ -32,22 +32,27 @@
 
 namespace swri_console
 {
-BagSource::BagSource(const QString &filename)
+BagSource::BagSource(const QStringList &filenames, const std::vector<uint16_t> &sources)
   :
-  filename_(filename),
-  backend_(NULL)
+  filenames_(filenames),
+  sources_(sources),
+  backend_(NULL),
+  cancelled_(new QAtomicInt(0))
 {
 }
 
 BagSource::~BagSource()
 {
+  // The backend checks for cancellation regularly, even while it is
+  // reading the bag index, so the thread stops soon after.
+  cancelled_->fetchAndStoreOrdered(1);
   thread_.quit();
-  if (!thread_.wait(500)) {
-    qWarning("Bag thread is not closing in a timely fashion.  This can happen"
-             "when opening a really large file.  We will attempt to forcibly "
-             "terminate the thread.");
-    thread_.terminate();
-  }
+  thread_.wait();
+}
+
+void BagSource::halt()
+{
+  cancelled_->fetchAndStoreOrdered(1);
 }
 
 void BagSource::start()
@@ -58,7 +63,7 @@ void BagSource::start()
 
   // Using the threading approach recommended in the following URL.
   // https://mayaposch.wordpress.com/2011/11/01/how-to-really-truly-use-qthreads-the-full-explanation/
-  backend_ = new BagSourceBackend(filename_);
+  backend_ = new BagSourceBackend(filenames_, sources_, cancelled_, backlog());
   backend_->moveToThread(&thread_);
   // The thread should finish when the backend has finished.
   QObject::connect(backend_, SIGNAL(finished(bool, size_t, QString)),
@@ -69,21 +74,44 @@ void BagSource::start()
 
   QObject::connect(backend_, SIGNAL(finished(bool, size_t, QString)),
                    this, SLOT(handleFinished(bool, size_t, QString)));
-  QObject::connect(backend_, SIGNAL(logRead(const rosgraph_msgs::LogConstPtr &)),
-                   this, SLOT(handleLogRead(const rosgraph_msgs::LogConstPtr &)));
+  QObject::connect(backend_, SIGNAL(batchRead(const swri_console::LogBatchPtr &)),
+                   this, SLOT(handleBatchRead(const swri_console::LogBatchPtr &)));
+  QObject::connect(backend_, SIGNAL(indexRead(const swri_console::BagIndex &)),
+                   this, SIGNAL(indexRead(const swri_console::BagIndex &)));
+  QObject::connect(backend_, SIGNAL(progress(const swri_console::BagLoadProgress &)),
+                   this, SLOT(handleProgress(const swri_console::BagLoadProgress &)));
+  QObject::connect(this, SIGNAL(loadRequested(const swri_console::BagQuery &)),
+                   backend_, SLOT(load(const swri_console::BagQuery &)));
   thread_.start();
 }
 
-void BagSource::handleFinished(bool success, size_t msg_count, QString error_msg)
+void BagSource::load(const BagQuery &query)
 {
-  Q_EMIT finished(filename_, success, msg_count, error_msg);
+  Q_EMIT loadRequested(query);
+}
+
+QString BagSource::name() const
+{
+  if (filenames_.size() == 1) {
+    return filenames_[0];
+  }
+  return QString("%1 bag files").arg(filenames_.size());
 }
 
-void BagSource::handleLogRead(const rosgraph_msgs::LogConstPtr &msg)
+void BagSource::handleFinished(bool success, size_t, QString error_msg)
 {
-  // Planning on changing what is done here soon, so that's why we're
-  // just rebroadcasting the signal from a slot instead of linking the
-  // incoming signal to the outgoing signal.
-  Q_EMIT logRead(msg);
-}                          
+  finish(success, error_msg);
+}
+
+void BagSource::handleProgress(const swri_console::BagLoadProgress &progress)
+{
+  addBytes(progress.bytes_read - last_progress_.bytes_read);
+  last_progress_ = progress;
+  Q_EMIT this->progress(progress);
+}
+
+void BagSource::handleBatchRead(const swri_console::LogBatchPtr &batch)
+{
+  deliverQueued(batch);
+}
 }  // namespace swri_console
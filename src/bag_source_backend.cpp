@@ -28,27 +28,98 @@
 //
 // *****************************************************************************
 #include <swri_console/bag_source_backend.h>
+#include <swri_console/log_source.h>
+#include <swri_console/log_decoder.h>
+
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+
+#include <ros/serialization.h>
+
+#include <QMutexLocker>
+#include <QThread>
+#include <QtConcurrentRun>
 
 namespace swri_console
 {
-// Number of messages to read from the bag file during each operation.
-static const int CHUNK_SIZE = 100;
+// Number of messages a worker reads before handing them off as a batch.
+static const size_t BATCH_SIZE = 5000;
+
+// Approximate number of messages in each time slice.  Bags smaller
+// than this are read by a single worker.
+static const size_t SLICE_SIZE = 50000;
+
+// Upper limit on the number of slices, since every slice has to open
+// the bag and read its index.
+static const size_t MAX_SLICES = 256;
+
+// Interval (ms) at which finished batches are collected from the workers.
+static const int POLL_INTERVAL = 10;
+
+// Number of bins in the message density histogram of the bag index.
+static const size_t DENSITY_BINS = 200;
+
+// Number of messages a worker reads between updating its progress
+// counters and checking for cancellation.
+static const size_t CHECK_INTERVAL = 1000;
+
+// Minimum interval (ms) between progress() signals.
+static const qint64 PROGRESS_INTERVAL = 250;
+
+// Number of consecutive messages rejected by a query's filter that
+// a cached bag's slice skips by ending and starting a new slice
+// rather than reading them.  Every slice opens the bag, so this
+// shouldn't be too small.
+static const size_t SKIP_GAP = 20000;
 
-BagSourceBackend::BagSourceBackend(const QString &filename)
+BagSourceBackend::BagSourceBackend(const QStringList &filenames,
+                                   const std::vector<uint16_t> &sources,
+                                   const boost::shared_ptr<QAtomicInt> &cancelled,
+                                   const boost::shared_ptr<QAtomicInt> &backlog)
   :
-  filename_(filename),
   opened_(false),
-  view_(NULL),
-  msg_count_(0)
+  loading_(false),
+  msg_count_(0),
+  cancelled_(cancelled),
+  backlog_(backlog),
+  last_progress_(0),
+  msgs_total_(0)
 {
+  bags_.resize(filenames.size());
+  for (size_t i = 0; i < bags_.size(); i++) {
+    bags_[i].filename = filenames[i];
+    bags_[i].source = sources[i];
+  }
+  index_.filenames = filenames;
+
   timer_id_ = startTimer(0);
 }
 
 BagSourceBackend::~BagSourceBackend()
 {
-  if (view_) {
-    delete view_;
-  }  
+  // Stop any workers that are still running.  They only share the
+  // slices with us, so they can finish on their own.
+  cancelled_->fetchAndStoreOrdered(1);
+}
+
+bool BagSourceBackend::isCancelled() const
+{
+  return cancelled_->fetchAndAddOrdered(0) != 0;
+}
+
+bool BagSourceBackend::isBackedUp() const
+{
+  return backlog_->fetchAndAddOrdered(0) >= LogSource::MAX_BACKLOG;
+}
+
+void BagSourceBackend::emitBatch(const LogBatchPtr &batch)
+{
+  msg_count_ += batch->size();
+  backlog_->fetchAndAddOrdered(batch->size());
+  Q_EMIT batchRead(batch);
 }
 
 void BagSourceBackend::timerEvent(QTimerEvent *)
@@ -56,72 +127,656 @@ void BagSourceBackend::timerEvent(QTimerEvent *)
   Result result;
 
   try {
-    if (!opened_) {
+    if (isCancelled()) {
+      result = Result(ERROR, "Load cancelled");
+    } else if (!opened_) {
       result = open();
     } else {
-      result = read(CHUNK_SIZE);
+      result = read();
     }
   } catch(const rosbag::BagException &e) {
     result = Result(ERROR, QString("Bag file error: %1").arg(e.what()));
   }
 
+  if (loading_ &&
+      (result.status != CONTINUE ||
+       load_timer_.elapsed() - last_progress_ >= PROGRESS_INTERVAL)) {
+    last_progress_ = load_timer_.elapsed();
+    Q_EMIT progress(currentProgress());
+  }
+
+  if (result.status == FINISHED && loading_) {
+    saveCaches();
+  }
+
   if (result.status != CONTINUE) {
     killTimer(timer_id_);
-    if (view_) {
-      delete view_;
-      view_ = NULL;
-    }
-    bag_.close();
     Q_EMIT finished(result.status == FINISHED, msg_count_, result.error_msg);
   }
 }
 
+BagLoadProgress BagSourceBackend::currentProgress() const
+{
+  BagLoadProgress progress;
+  progress.msgs_total = msgs_total_;
+  progress.msgs_kept = msg_count_;
+  progress.elapsed = load_timer_.elapsed() / 1000.0;
+
+  for (size_t i = 0; i < bags_.size(); i++) {
+    const std::vector<SlicePtr> &slices = bags_[i].slices;
+    for (size_t j = 0; j < slices.size(); j++) {
+      QMutexLocker lock(&slices[j]->mutex);
+      progress.msgs_read += slices[j]->msgs_read;
+      progress.bytes_read += slices[j]->bytes_read;
+    }
+  }
+
+  return progress;
+}
+
+// Adds a receipt time to a histogram of density.size() bins spanning
+// [begin, end].
+static void addToDensity(uint64_t time,
+                         const ros::Time &begin,
+                         const ros::Time &end,
+                         std::vector<size_t> &density)
+{
+  const uint64_t begin_nsec = begin.toNSec();
+  const uint64_t span = end.toNSec() - begin_nsec + 1;
+  const size_t bins = density.size();
+  size_t bin = static_cast<double>(time - begin_nsec) / span * bins;
+  density[std::min(bin, bins - 1)]++;
+}
+
+// Adds the receipt time of every message in view to a histogram of
+// density.size() bins spanning [begin, end].  Returns false if
+// cancelled was set before it finished.
+static bool addToDensity(const rosbag::View &view,
+                         const ros::Time &begin,
+                         const ros::Time &end,
+                         std::vector<size_t> &density,
+                         QAtomicInt &cancelled)
+{
+  size_t count = 0;
+  for (rosbag::View::const_iterator iter = view.begin(); iter != view.end(); ++iter) {
+    addToDensity(iter->getTime().toNSec(), begin, end, density);
+
+    if (++count % CHECK_INTERVAL == 0 &&
+        cancelled.fetchAndAddOrdered(0) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
 BagSourceBackend::Result BagSourceBackend::open()
 {
-  bool has_rosout = false;
-  bool has_rosout_agg = false;
-  
-  bag_.open(filename_.toStdString(), rosbag::bagmode::Read);
-    
-  has_rosout_agg = !(rosbag::View(bag_, rosbag::TopicQuery("/rosout_agg")).getConnections().empty());
-  if (!has_rosout_agg) {
-    has_rosout = !(rosbag::View(bag_, rosbag::TopicQuery("/rosout")).getConnections().empty());
+  // First pass: find the topic and time span of each bag.
+  for (size_t i = 0; i < bags_.size(); i++) {
+    BagState &state = bags_[i];
+    state.index.filenames = QStringList(state.filename);
+
+    boost::shared_ptr<BagMessageIndex> cache(new BagMessageIndex());
+    if (loadBagMessageIndex(state.filename, cache.get())) {
+      state.cache = cache;
+      state.topic = cache->topic;
+      state.index.msg_count = cache->records.size();
+      if (state.index.msg_count == 0) {
+        state.done = true;
+        continue;
+      }
+      state.index.begin_time.fromNSec(cache->records.front().time);
+      state.index.end_time.fromNSec(cache->records.back().time);
+    } else {
+      rosbag::Bag bag;
+      bag.open(state.filename.toStdString(), rosbag::bagmode::Read);
+
+      bool has_rosout = false;
+      bool has_rosout_agg = false;
+      has_rosout_agg = !(rosbag::View(bag, rosbag::TopicQuery("/rosout_agg")).getConnections().empty());
+      if (!has_rosout_agg) {
+        has_rosout = !(rosbag::View(bag, rosbag::TopicQuery("/rosout")).getConnections().empty());
+      }
+
+      if (!has_rosout && !has_rosout_agg) {
+        return Result(ERROR, QString("Bag file %1 does not have /rosout or /rosout_agg")
+                      .arg(state.filename));
+      }
+
+      state.topic = has_rosout_agg ? "/rosout_agg" : "/rosout";
+
+      rosbag::View view(bag, rosbag::TopicQuery(state.topic));
+      state.index.msg_count = view.size();
+      if (state.index.msg_count == 0) {
+        state.done = true;
+        continue;
+      }
+      state.index.begin_time = view.getBeginTime();
+      state.index.end_time = view.getEndTime();
+    }
+
+    if (index_.msg_count == 0 || state.index.begin_time < index_.begin_time) {
+      index_.begin_time = state.index.begin_time;
+    }
+    if (index_.msg_count == 0 || state.index.end_time > index_.end_time) {
+      index_.end_time = state.index.end_time;
+    }
+    index_.msg_count += state.index.msg_count;
   }
 
-  if (!has_rosout && !has_rosout_agg) {
-    return Result(ERROR, QString("Bag file does not have /rosout or /rosout_agg"));
+  if (index_.msg_count == 0) {
+    Q_EMIT indexRead(index_);
+    return Result(FINISHED, "");
   }
 
-  std::string topic = has_rosout_agg ? "/rosout_agg" : "/rosout";
+  // Second pass: build the density histograms from the receipt times
+  // in the indexes, both for each bag (used to plan its slices) and
+  // for the whole job.  Iterating the views does not read any message
+  // data.
+  index_.density.assign(DENSITY_BINS, 0);
+  for (size_t i = 0; i < bags_.size(); i++) {
+    BagState &state = bags_[i];
+    if (state.done) {
+      continue;
+    }
+
+    state.index.density.assign(DENSITY_BINS, 0);
+    if (state.cache) {
+      const std::vector<BagIndexRecord> &records = state.cache->records;
+      for (size_t j = 0; j < records.size(); j++) {
+        addToDensity(records[j].time, state.index.begin_time, state.index.end_time,
+                     state.index.density);
+        addToDensity(records[j].time, index_.begin_time, index_.end_time,
+                     index_.density);
+      }
+      continue;
+    }
+
+    rosbag::Bag bag;
+    bag.open(state.filename.toStdString(), rosbag::bagmode::Read);
+    rosbag::View view(bag, rosbag::TopicQuery(state.topic));
+
+    if (!addToDensity(view, state.index.begin_time, state.index.end_time,
+                      state.index.density, *cancelled_) ||
+        !addToDensity(view, index_.begin_time, index_.end_time,
+                      index_.density, *cancelled_)) {
+      return Result(ERROR, "Load cancelled");
+    }
+  }
 
-  // View has a private assignment operator, so the only way to create
-  // a persistent view after our constructor is to allocate it on the
-  // heap.
-  view_ = new rosbag::View(bag_, rosbag::TopicQuery(topic));
-  iter_ = view_->begin();
+  Q_EMIT indexRead(index_);
 
-  opened_ = true;  
+  // Nothing else to do until load() is called.
+  killTimer(timer_id_);
+  opened_ = true;
   return Result(CONTINUE);
 }
 
-BagSourceBackend::Result BagSourceBackend::read(size_t msgs_to_read)
+void BagSourceBackend::load(const swri_console::BagQuery &query)
 {
-  for (size_t i = 0; i < msgs_to_read; ++i) {
-    if (iter_ == view_->end()) {
-      return Result(FINISHED, "");
+  if (!opened_ || loading_) {
+    return;
+  }
+
+  loading_ = true;
+  filter_ = query.filter;
+  load_timer_.start();
+  for (size_t i = 0; i < bags_.size(); i++) {
+    BagState &bag = bags_[i];
+    if (bag.done) {
+      continue;
     }
-    rosgraph_msgs::LogConstPtr log = iter_->instantiate<rosgraph_msgs::Log>();
-    if (log != NULL ) {
-      emit logRead(log);
-      msg_count_++;
+    const ros::Time start = std::max(query.start, bag.index.begin_time);
+    const ros::Time end = std::min(query.end, bag.index.end_time);
+    if (bag.cache) {
+      planCachedSlices(bag, start, end);
     } else {
-      qWarning("Got a message that was not a log message but a: %s", iter_->getDataType().c_str());
+      bag.record = (start == bag.index.begin_time && end == bag.index.end_time);
+      msgs_total_ += bag.index.estimateCount(start, end);
+      planSlices(bag, start, end);
     }
-    
-    ++iter_;
+    startSlices(bag);
   }
+  timer_id_ = startTimer(POLL_INTERVAL);
+}
 
-  return Result(CONTINUE);
+void BagSourceBackend::planSlices(BagState &bag,
+                                  const ros::Time &start_time,
+                                  const ros::Time &end_time)
+{
+  if (end_time < start_time) {
+    return;
+  }
+
+  // Divide the range into time slices with roughly SLICE_SIZE messages
+  // each, but at least one per thread so every core has work.
+  const uint64_t begin = start_time.toNSec();
+  const uint64_t end = end_time.toNSec();
+  const size_t threads = std::max(QThread::idealThreadCount(), 1);
+
+  const size_t msg_count = bag.index.estimateCount(start_time, end_time);
+  size_t slice_count = 1;
+  if (msg_count > SLICE_SIZE) {
+    slice_count = std::max(threads, msg_count / SLICE_SIZE);
+    slice_count = std::min(slice_count, MAX_SLICES);
+  }
+
+  const uint64_t span = end - begin;
+  for (size_t i = 0; i < slice_count; i++) {
+    SlicePtr slice(new Slice());
+    slice->cancelled = cancelled_;
+    slice->record = bag.record;
+    slice->start.fromNSec(begin + span * i / slice_count);
+    // View time ranges include both ends, so stop each slice 1ns
+    // before the next one starts.
+    if (i + 1 == slice_count) {
+      slice->end.fromNSec(end);
+    } else {
+      slice->end.fromNSec(begin + span * (i + 1) / slice_count - 1);
+    }
+
+    if (i == 0 || slice->end >= slice->start) {
+      bag.slices.push_back(slice);
+    }
+  }
 }
-}  // namespace swri_console
 
+static bool compareRecordTime(const BagIndexRecord &record, uint64_t time)
+{
+  return record.time < time;
+}
+
+static bool compareTimeRecord(uint64_t time, const BagIndexRecord &record)
+{
+  return time < record.time;
+}
+
+void BagSourceBackend::planCachedSlices(BagState &bag,
+                                        const ros::Time &start_time,
+                                        const ros::Time &end_time)
+{
+  if (end_time < start_time) {
+    return;
+  }
+
+  const std::vector<BagIndexRecord> &records = bag.cache->records;
+  const size_t lo = std::lower_bound(records.begin(), records.end(),
+                                     start_time.toNSec(), compareRecordTime) - records.begin();
+  const size_t hi = std::upper_bound(records.begin(), records.end(),
+                                     end_time.toNSec(), compareTimeRecord) - records.begin();
+
+  std::vector<bool> node_accepted(bag.cache->nodes.size(), filter_.nodes.empty());
+  for (size_t i = 0; i < node_accepted.size(); i++) {
+    if (filter_.nodes.count(bag.cache->nodes[i])) {
+      node_accepted[i] = true;
+    }
+  }
+
+  // Slices cover runs of the range that hold accepted messages.  A run
+  // ends when the slice is big enough, sized the same way as for an
+  // uncached bag, or before a long stretch of rejected messages.
+  // Cuts are only made between different receipt times, since view
+  // time ranges include both ends.  If that gives too many slices, the
+  // limits are relaxed until it doesn't.
+  const size_t count = hi - lo;
+  const size_t threads = std::max(QThread::idealThreadCount(), 1);
+  size_t slice_size = std::max(count / MAX_SLICES + 1,
+                               std::min(SLICE_SIZE, count / threads + 1));
+  size_t max_gap = SKIP_GAP;
+
+  std::vector<std::pair<size_t, size_t> > runs;
+  while (true) {
+    runs.clear();
+    size_t first = hi;
+    size_t last = hi;
+    for (size_t i = lo; i < hi; i++) {
+      const BagIndexRecord &record = records[i];
+      if (record.level < filter_.min_level || !node_accepted[record.node]) {
+        continue;
+      }
+
+      if (first != hi &&
+          (i - first >= slice_size || i - last > max_gap) &&
+          record.time > records[last].time) {
+        runs.push_back(std::make_pair(first, last));
+        first = hi;
+      }
+      if (first == hi) {
+        first = i;
+      }
+      last = i;
+    }
+    if (first != hi) {
+      runs.push_back(std::make_pair(first, last));
+    }
+
+    if (runs.size() <= MAX_SLICES) {
+      break;
+    }
+    slice_size *= 2;
+    max_gap *= 2;
+  }
+
+  for (size_t i = 0; i < runs.size(); i++) {
+    SlicePtr slice(new Slice());
+    slice->cancelled = cancelled_;
+    slice->start.fromNSec(records[runs[i].first].time);
+    slice->end.fromNSec(records[runs[i].second].time);
+    bag.slices.push_back(slice);
+    msgs_total_ += runs[i].second - runs[i].first + 1;
+  }
+}
+
+void BagSourceBackend::startSlices(BagState &bag)
+{
+  // The global thread pool runs tasks in the order they were
+  // started, so the slices are read roughly in the order they are
+  // delivered.
+  for (size_t i = 0; i < bag.slices.size(); i++) {
+    QtConcurrent::run(&BagSourceBackend::readSlice,
+                      bag.filename.toStdString(),
+                      bag.topic,
+                      bag.source,
+                      filter_,
+                      bag.slices[i]);
+  }
+}
+
+bool BagSourceBackend::fillBag(BagState &bag, QString *error_msg)
+{
+  // Makes sure the front of the bag's pending batches has an entry to
+  // merge, taking batches from its slices in order.  Returns false if
+  // the bag has to wait for a worker or failed.
+  while (!bag.done) {
+    while (!bag.pending.empty() && bag.pending_pos >= bag.pending.front()->size()) {
+      bag.pending.pop_front();
+      bag.pending_pos = 0;
+    }
+    if (!bag.pending.empty()) {
+      return true;
+    }
+
+    if (bag.current_slice >= bag.slices.size()) {
+      bag.done = true;
+      break;
+    }
+
+    SlicePtr slice = bag.slices[bag.current_slice];
+    bool done;
+    QString slice_error;
+    {
+      QMutexLocker lock(&slice->mutex);
+      bag.pending.swap(slice->batches);
+      done = slice->done;
+      slice_error = slice->error_msg;
+    }
+
+    if (!bag.pending.empty()) {
+      continue;
+    }
+
+    if (!done) {
+      return false;
+    }
+
+    if (!slice_error.isEmpty()) {
+      *error_msg = slice_error;
+      return false;
+    }
+
+    bag.current_slice++;
+  }
+
+  return true;
+}
+
+BagSourceBackend::Result BagSourceBackend::read()
+{
+  // Merge the bags by stamp.  Each bag's slices are delivered in
+  // order, so the head of each bag is the next entry of that bag and
+  // the smallest head is the next entry of the merged stream.  Nothing
+  // is merged past a bag that is still waiting on a worker.
+  //
+  // Slices are split by receipt time, so a bag whose stamps are out
+  // of order (e.g. /rosout_agg from nodes with skewed clocks) is
+  // merged in roughly, not strictly, stamp order.
+  //
+  // There are only a handful of bags in a job, so the smallest head
+  // is found with a linear scan rather than a heap.
+  QString error_msg;
+  for (size_t i = 0; i < bags_.size(); i++) {
+    if (!fillBag(bags_[i], &error_msg)) {
+      return error_msg.isEmpty() ? Result(CONTINUE) : Result(ERROR, error_msg);
+    }
+  }
+
+  LogBatchPtr batch;
+  Result result(CONTINUE);
+  // The workers keep reading their slices while the merge waits for
+  // the GUI to catch up.
+  while (!isBackedUp()) {
+    BagState *next = NULL;
+    size_t active = 0;
+    for (size_t i = 0; i < bags_.size(); i++) {
+      BagState &bag = bags_[i];
+      if (bag.done) {
+        continue;
+      }
+      active++;
+      if (!next ||
+          (*bag.pending.front())[bag.pending_pos].stamp <
+          (*next->pending.front())[next->pending_pos].stamp) {
+        next = &bag;
+      }
+    }
+
+    if (!next) {
+      result = Result(FINISHED, "");
+      break;
+    }
+
+    if (active == 1 && !batch && next->pending_pos == 0) {
+      // Only one bag is left, so its batches can be passed through
+      // without copying.
+      LogBatchPtr whole = next->pending.front();
+      next->pending.pop_front();
+      emitBatch(whole);
+    } else {
+      if (!batch) {
+        batch.reset(new std::vector<LogEntry>());
+        batch->reserve(BATCH_SIZE);
+      }
+      batch->push_back(LogEntry());
+      std::swap(batch->back(), (*next->pending.front())[next->pending_pos]);
+      next->pending_pos++;
+
+      if (batch->size() >= BATCH_SIZE) {
+        emitBatch(batch);
+        batch.reset();
+      }
+    }
+
+    if (!fillBag(*next, &error_msg)) {
+      if (!error_msg.isEmpty()) {
+        result = Result(ERROR, error_msg);
+      }
+      break;
+    }
+  }
+
+  if (batch) {
+    emitBatch(batch);
+  }
+
+  return result;
+}
+
+void BagSourceBackend::readSlice(std::string filename, std::string topic,
+                                 uint16_t source, LogDecodeFilter filter,
+                                 SlicePtr slice)
+{
+  QString error_msg;
+
+  try {
+    rosbag::Bag bag;
+    bag.open(filename, rosbag::bagmode::Read);
+    rosbag::View view(bag, rosbag::TopicQuery(topic), slice->start, slice->end);
+
+    LogBatchPtr batch(new std::vector<LogEntry>());
+    batch->reserve(std::min(static_cast<size_t>(view.size()), BATCH_SIZE));
+
+    const std::string log_md5sum = ros::message_traits::md5sum<rosgraph_msgs::Log>();
+
+    // Messages are copied out of the bag into a reused buffer and
+    // decoded straight into a LogEntry, rather than instantiating a
+    // rosgraph_msgs::Log for each one.
+    std::vector<uint8_t> buffer;
+    size_t msgs_read = 0;
+    uint64_t bytes_read = 0;
+
+    bool record = slice->record;
+    std::vector<BagIndexRecord> records;
+    std::vector<std::string> nodes;
+    std::map<std::string, uint16_t> node_ids;
+    std::string node;
+    for (rosbag::View::const_iterator iter = view.begin(); iter != view.end(); ++iter) {
+      if (msgs_read == CHECK_INTERVAL) {
+        QMutexLocker lock(&slice->mutex);
+        slice->msgs_read += msgs_read;
+        slice->bytes_read += bytes_read;
+        msgs_read = 0;
+        bytes_read = 0;
+
+        if (slice->cancelled->fetchAndAddOrdered(0) != 0) {
+          error_msg = "Load cancelled";
+          break;
+        }
+      }
+      msgs_read++;
+
+      if (iter->getMD5Sum() != log_md5sum) {
+        qWarning("Got a message that was not a log message but a: %s", iter->getDataType().c_str());
+        continue;
+      }
+
+      const uint32_t size = iter->size();
+      bytes_read += size;
+      buffer.resize(size);
+      ros::serialization::OStream stream(buffer.data(), size);
+      iter->write(stream);
+
+      BagIndexRecord index_record;
+      uint32_t seq;
+      uint32_t sec;
+      uint32_t nsec;
+      if (record &&
+          decodeLogHeader(buffer.data(), size, &seq, &sec, &nsec,
+                          &index_record.level, &node)) {
+        std::map<std::string, uint16_t>::iterator it = node_ids.find(node);
+        if (it == node_ids.end() && nodes.size() > std::numeric_limits<uint16_t>::max()) {
+          // Node ids would overflow; give up on the index.
+          record = false;
+          records.clear();
+        } else {
+          if (it == node_ids.end()) {
+            it = node_ids.insert(std::make_pair(node, nodes.size())).first;
+            nodes.push_back(node);
+          }
+          index_record.time = iter->getTime().toNSec();
+          // decodeLogHeader() has checked nsec, so this is the same as
+          // ros::Time(sec, nsec).toNSec() without the chance of a throw.
+          index_record.stamp = static_cast<uint64_t>(sec) * 1000000000ULL + nsec;
+          index_record.node = it->second;
+          memset(index_record.reserved, 0, sizeof(index_record.reserved));
+          records.push_back(index_record);
+        }
+      }
+
+      batch->push_back(LogEntry());
+      DecodeStatus status = decodeLogMessage(buffer.data(), size, filter, &batch->back());
+      if (status != DECODE_ACCEPTED) {
+        if (status == DECODE_INVALID) {
+          qWarning("Failed to decode a log message at time %u.%09u",
+                   iter->getTime().sec, iter->getTime().nsec);
+        }
+        batch->pop_back();
+        continue;
+      }
+      batch->back().source = source;
+
+      if (batch->size() >= BATCH_SIZE) {
+        QMutexLocker lock(&slice->mutex);
+        slice->batches.push_back(batch);
+        batch.reset(new std::vector<LogEntry>());
+        batch->reserve(BATCH_SIZE);
+      }
+    }
+
+    QMutexLocker lock(&slice->mutex);
+    slice->msgs_read += msgs_read;
+    slice->bytes_read += bytes_read;
+    if (!batch->empty()) {
+      slice->batches.push_back(batch);
+    }
+    slice->record = record;
+    slice->records.swap(records);
+    slice->nodes.swap(nodes);
+  } catch (const rosbag::BagException &e) {
+    error_msg = QString("Bag file error: %1").arg(e.what());
+  }
+
+  QMutexLocker lock(&slice->mutex);
+  slice->error_msg = error_msg;
+  slice->done = true;
+}
+
+void BagSourceBackend::saveCaches()
+{
+  // Combine the indexes recorded by the slices of each bag that was
+  // read in full.  The slices are in time order and don't overlap, so
+  // their records can simply be appended.
+  for (size_t i = 0; i < bags_.size(); i++) {
+    const BagState &bag = bags_[i];
+    if (!bag.record) {
+      continue;
+    }
+
+    BagMessageIndex index;
+    index.topic = bag.topic;
+    std::map<std::string, uint16_t> node_ids;
+    bool complete = true;
+    for (size_t j = 0; complete && j < bag.slices.size(); j++) {
+      Slice &slice = *bag.slices[j];
+      QMutexLocker lock(&slice.mutex);
+      if (!slice.record) {
+        complete = false;
+        break;
+      }
+
+      std::vector<uint16_t> slice_ids(slice.nodes.size());
+      for (size_t k = 0; k < slice.nodes.size(); k++) {
+        std::map<std::string, uint16_t>::iterator it = node_ids.find(slice.nodes[k]);
+        if (it == node_ids.end()) {
+          if (index.nodes.size() > std::numeric_limits<uint16_t>::max()) {
+            complete = false;
+            break;
+          }
+          it = node_ids.insert(std::make_pair(slice.nodes[k], index.nodes.size())).first;
+          index.nodes.push_back(slice.nodes[k]);
+        }
+        slice_ids[k] = it->second;
+      }
+
+      for (size_t k = 0; complete && k < slice.records.size(); k++) {
+        index.records.push_back(slice.records[k]);
+        index.records.back().node = slice_ids[slice.records[k].node];
+      }
+    }
+
+    if (complete && !saveBagMessageIndex(bag.filename, index)) {
+      qWarning("Failed to save the index of %s to the cache.",
+               bag.filename.toLocal8Bit().constData());
+    }
+  }
+}
+}  // namespace swri_console
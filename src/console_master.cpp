@@ -32,24 +32,91 @@
 #include <swri_console/console_window.h>
 #include <swri_console/settings_keys.h>
 #include <swri_console/bag_source.h>
+#include <swri_console/bag_load_dialog.h>
+#include <swri_console/bag_progress_dialog.h>
+#include <swri_console/log_server_source.h>
+#include <swri_console/remote_ros_source.h>
+#include <swri_console/session_source.h>
+#include <swri_console/syslog_source.h>
+#include <swri_console/text_log_source.h>
+#include <swri_console/text_log_tail_source.h>
 
+#include <QDir>
+#include <QFileInfo>
 #include <QFontDialog>
+#include <QMessageBox>
 #include <QSettings>
 
 namespace swri_console
 {
+// Bags with at least this many log messages are previewed before
+// loading when the PREVIEW_LARGE_BAGS setting is enabled.
+static const size_t PREVIEW_MIN_MESSAGES = 100000;
+
 ConsoleMaster::ConsoleMaster()
   :
   connected_(false),
+  recorder_source_(NULL),
   window_font_(QFont("Ubuntu Mono", 9))
 {
-  QObject::connect(&ros_source_, SIGNAL(logReceived(const rosgraph_msgs::LogConstPtr& )),
-                   &db_, SLOT(queueMessage(const rosgraph_msgs::LogConstPtr&) ));
-  ros_source_.start();
+  connectRosSource(true);
+
+  // Restore the additional masters, saved as "label=uri".
+  QSettings settings;
+  QStringList masters = settings.value(SettingsKeys::REMOTE_MASTERS).toStringList();
+  for (int i = 0; i < masters.size(); i++) {
+    int split = masters[i].indexOf('=');
+    if (split > 0) {
+      startRemoteSource(masters[i].left(split), masters[i].mid(split + 1));
+    }
+  }
+
+  QStringList addresses = settings.value(SettingsKeys::SYSLOG_ADDRESSES).toStringList();
+  for (int i = 0; i < addresses.size(); i++) {
+    startSyslogSource(addresses[i]);
+  }
 }
 
 ConsoleMaster::~ConsoleMaster()
 {
+  // Stop the relays while the database is still around.
+  qDeleteAll(remote_sources_);
+  qDeleteAll(syslog_sources_);
+  delete recorder_source_;
+}
+
+void ConsoleMaster::startRosSource()
+{
+  ros_source_.start();
+}
+
+void ConsoleMaster::connectRosSource(bool connect)
+{
+  if (connect) {
+    connectSource(&ros_source_);
+  } else {
+    QObject::disconnect(&ros_source_, SIGNAL(batchRead(const swri_console::LogBatchPtr &)),
+                        &db_, SLOT(queueBatch(const swri_console::LogBatchPtr &)));
+  }
+}
+
+void ConsoleMaster::connectSource(LogSource *source)
+{
+  QObject::connect(source, SIGNAL(batchRead(const swri_console::LogBatchPtr &)),
+                   &db_, SLOT(queueBatch(const swri_console::LogBatchPtr &)));
+}
+
+void ConsoleMaster::readFile(LogSource *source)
+{
+  connectSource(source);
+
+  QObject::connect(source, SIGNAL(finished(const QString&, bool, size_t, const QString&)),
+                   this, SLOT(fileLoadFinished(const QString&, bool, size_t, const QString&)));
+
+  QObject::connect(source, SIGNAL(finished(const QString&, bool, size_t, const QString&)),
+                   source, SLOT(deleteLater()));
+
+  source->start();
 }
 
 void ConsoleMaster::createNewWindow()
@@ -67,6 +134,10 @@ void ConsoleMaster::createNewWindow()
                    win, SLOT(rosConnected(bool, const QString&)));
   win->rosConnected(ros_source_.isConnected(), ros_source_.masterUri());
 
+  QObject::connect(&ros_source_, SIGNAL(ingestStatsUpdated(const swri_console::IngestStats &)),
+                   win, SLOT(ingestStatsUpdated(const swri_console::IngestStats &)));
+  win->ingestStatsUpdated(ros_source_.ingestStats());
+
   QObject::connect(this,
                    SIGNAL(fontChanged(const QFont &)),
                    win, SLOT(setFont(const QFont &)));
@@ -74,8 +145,40 @@ void ConsoleMaster::createNewWindow()
   QObject::connect(win, SIGNAL(selectFont()),
                    this, SLOT(selectFont()));
 
-  QObject::connect(win, SIGNAL(readBagFile(const QString &)),
-                   this, SLOT(readBagFile(const QString &)));
+  QObject::connect(win, SIGNAL(readBagFiles(const QStringList &, bool)),
+                   this, SLOT(readBagFiles(const QStringList &, bool)));
+
+  QObject::connect(win, SIGNAL(followLogDirectory(const QString &)),
+                   this, SLOT(followLogDirectory(const QString &)));
+
+  QObject::connect(win, SIGNAL(addRosMaster(const QString &, const QString &)),
+                   this, SLOT(addRosMaster(const QString &, const QString &)));
+  QObject::connect(win, SIGNAL(removeRosMaster(const QString &)),
+                   this, SLOT(removeRosMaster(const QString &)));
+  QObject::connect(win, SIGNAL(attachToRecorder(const QString &)),
+                   this, SLOT(attachToRecorder(const QString &)));
+  QObject::connect(win, SIGNAL(listenForSyslog(const QString &)),
+                   this, SLOT(listenForSyslog(const QString &)));
+
+  QObject::connect(this, SIGNAL(sourceStatusChanged(const QString &, const QString &, const QString &)),
+                   win, SLOT(setSourceStatus(const QString &, const QString &, const QString &)));
+  QObject::connect(this, SIGNAL(statusMessage(const QString &)),
+                   win, SLOT(showStatusMessage(const QString &)));
+  for (int i = 0; i < remote_sources_.size(); i++) {
+    win->setSourceStatus(remote_sources_[i]->label(),
+                         remote_sources_[i]->statusText(),
+                         remote_sources_[i]->masterUri());
+  }
+  for (int i = 0; i < syslog_sources_.size(); i++) {
+    win->setSourceStatus(syslogLabel(syslog_sources_[i]),
+                         syslog_sources_[i]->statusText(),
+                         syslog_sources_[i]->address());
+  }
+  if (recorder_source_) {
+    win->setSourceStatus(recorderLabel(),
+                         recorder_source_->statusText(),
+                         recorder_source_->serverName());
+  }
 
   win->show();
 }
@@ -112,16 +215,359 @@ void ConsoleMaster::selectFont()
   }
 }
 
-void ConsoleMaster::readBagFile(const QString &name)
+void ConsoleMaster::readBagFiles(const QStringList &filenames, bool choose_query)
 {
-  BagSource *source = new BagSource(name);
+  // Session files and text logs are read on their own.  Everything
+  // else is treated as a bag.
+  QStringList names;
+  for (int i = 0; i < filenames.size(); i++) {
+    if (filenames[i].endsWith(".swrilog", Qt::CaseInsensitive)) {
+      readSessionFile(filenames[i]);
+    } else if (filenames[i].endsWith(".log", Qt::CaseInsensitive)) {
+      readTextLogFile(filenames[i]);
+    } else {
+      names.append(filenames[i]);
+    }
+  }
+
+  if (names.isEmpty()) {
+    return;
+  }
+
+  // All of the bags are read as a single job so that their messages
+  // are merged in time order.  Each bag is registered as a separate
+  // source so its messages can be told apart.
+  std::vector<uint16_t> sources;
+  for (int i = 0; i < names.size(); i++) {
+    sources.push_back(db_.addSource(QFileInfo(names[i]).fileName()));
+  }
 
-  QObject::connect(source, SIGNAL(logRead(const rosgraph_msgs::LogConstPtr& )),
-                   &db_, SLOT(queueMessage(const rosgraph_msgs::LogConstPtr&) ));
+  BagSource *source = new BagSource(names, sources);
+  connectSource(source);
+  if (choose_query) {
+    query_bag_sources_.append(source);
+  }
+  
+  QObject::connect(source, SIGNAL(indexRead(const swri_console::BagIndex &)),
+                   this, SLOT(bagIndexRead(const swri_console::BagIndex &)));
   
+  QObject::connect(source, SIGNAL(finished(const QString&, bool, size_t, const QString&)),
+                   this, SLOT(bagLoadFinished(const QString&, bool, size_t, const QString&)));
+
   QObject::connect(source, SIGNAL(finished(const QString&, bool, size_t, const QString&)),
                    source, SLOT(deleteLater()));
 
   source->start();
 }
+
+void ConsoleMaster::readSessionFile(const QString &filename)
+{
+  readFile(new SessionSource(filename, db_.addSource(QFileInfo(filename).fileName())));
+}
+
+void ConsoleMaster::readTextLogFile(const QString &filename)
+{
+  readFile(new TextLogSource(filename, db_.addSource(QFileInfo(filename).fileName())));
+}
+
+void ConsoleMaster::followLogDirectory(const QString &directory)
+{
+  QString path = QDir(directory).canonicalPath();
+  for (int i = 0; i < tail_sources_.size(); i++) {
+    if (tail_sources_[i]->directory() == path) {
+      return;
+    }
+  }
+
+  TextLogTailSource *source = new TextLogTailSource(
+    path, db_.addSource(QDir(path).dirName() + "/"), this);
+  connectSource(source);
+  QObject::connect(source, SIGNAL(finished(const QString&, bool, size_t, const QString&)),
+                   this, SLOT(tailSourceFinished(const QString&, bool, size_t, const QString&)));
+
+  tail_sources_.append(source);
+  source->start();
+}
+
+void ConsoleMaster::tailSourceFinished(const QString &name, bool success,
+                                       size_t, const QString &error_msg)
+{
+  TextLogTailSource *source = qobject_cast<TextLogTailSource*>(sender());
+  if (!source) {
+    return;
+  }
+
+  tail_sources_.removeAll(source);
+  source->deleteLater();
+  if (!success) {
+    QMessageBox::warning(NULL, tr("Stopped following log directory"),
+                         tr("Stopped following %1:\n%2").arg(name).arg(error_msg));
+  }
+}
+
+void ConsoleMaster::addRosMaster(const QString &label, const QString &master_uri)
+{
+  if (startRemoteSource(label, master_uri)) {
+    saveRemoteMasters();
+  }
+}
+
+void ConsoleMaster::removeRosMaster(const QString &label)
+{
+  if (recorder_source_ && label == recorderLabel()) {
+    delete recorder_source_;
+    recorder_source_ = NULL;
+    Q_EMIT sourceStatusChanged(label, QString(), QString());
+
+    // Back to following the ROS master directly.
+    connectRosSource(true);
+    ros_source_.start();
+    return;
+  }
+
+  for (int i = 0; i < remote_sources_.size(); i++) {
+    if (remote_sources_[i]->label() == label) {
+      delete remote_sources_.takeAt(i);
+      saveRemoteMasters();
+      Q_EMIT sourceStatusChanged(label, QString(), QString());
+      return;
+    }
+  }
+
+  for (int i = 0; i < syslog_sources_.size(); i++) {
+    if (syslogLabel(syslog_sources_[i]) == label) {
+      delete syslog_sources_.takeAt(i);
+      saveSyslogAddresses();
+      Q_EMIT sourceStatusChanged(label, QString(), QString());
+      return;
+    }
+  }
+}
+
+void ConsoleMaster::attachToRecorder(const QString &server_name)
+{
+  if (recorder_source_ || server_name.isEmpty()) {
+    return;
+  }
+
+  // The recorder has the live logs, so the console's own
+  // subscription, if any, would only duplicate them.
+  connectRosSource(false);
+
+  recorder_source_ = new LogServerSource(server_name, db_.addSource(server_name), this);
+  connectSource(recorder_source_);
+  QObject::connect(recorder_source_, SIGNAL(statusChanged()),
+                   this, SLOT(recorderStatusChanged()));
+  recorder_source_->start();
+  recorderStatusChanged();
+}
+
+QString ConsoleMaster::recorderLabel() const
+{
+  return tr("Recorder %1").arg(recorder_source_->serverName());
+}
+
+void ConsoleMaster::recorderStatusChanged()
+{
+  if (recorder_source_) {
+    Q_EMIT sourceStatusChanged(recorderLabel(), recorder_source_->statusText(),
+                               recorder_source_->serverName());
+  }
+}
+
+bool ConsoleMaster::startRemoteSource(const QString &label, const QString &master_uri)
+{
+  if (label.isEmpty() || master_uri.isEmpty()) {
+    return false;
+  }
+  for (int i = 0; i < remote_sources_.size(); i++) {
+    if (remote_sources_[i]->label() == label) {
+      QMessageBox::warning(NULL, tr("Add ROS Master"),
+                           tr("There already is a ROS master named %1.").arg(label));
+      return false;
+    }
+  }
+
+  RemoteRosSource *source = new RemoteRosSource(
+    label, master_uri, db_.addSource(label), this);
+
+  connectSource(source);
+  QObject::connect(source, SIGNAL(statusChanged()),
+                   this, SLOT(remoteSourceStatusChanged()));
+
+  remote_sources_.append(source);
+  source->start();
+  Q_EMIT sourceStatusChanged(label, source->statusText(), master_uri);
+  return true;
+}
+
+void ConsoleMaster::saveRemoteMasters() const
+{
+  QStringList masters;
+  for (int i = 0; i < remote_sources_.size(); i++) {
+    masters.append(remote_sources_[i]->label() + "=" + remote_sources_[i]->masterUri());
+  }
+  QSettings settings;
+  settings.setValue(SettingsKeys::REMOTE_MASTERS, masters);
+}
+
+void ConsoleMaster::remoteSourceStatusChanged()
+{
+  RemoteRosSource *source = qobject_cast<RemoteRosSource*>(sender());
+  if (source) {
+    Q_EMIT sourceStatusChanged(source->label(), source->statusText(), source->masterUri());
+  }
+}
+
+void ConsoleMaster::listenForSyslog(const QString &address)
+{
+  if (startSyslogSource(address)) {
+    saveSyslogAddresses();
+  }
+}
+
+bool ConsoleMaster::startSyslogSource(const QString &address)
+{
+  if (address.isEmpty()) {
+    return false;
+  }
+  for (int i = 0; i < syslog_sources_.size(); i++) {
+    if (syslog_sources_[i]->address() == address) {
+      return false;
+    }
+  }
+
+  SyslogSource *source = new SyslogSource(address, db_.addSource(address), this);
+  connectSource(source);
+  QObject::connect(source, SIGNAL(statusChanged()),
+                   this, SLOT(syslogSourceStatusChanged()));
+  QObject::connect(source, SIGNAL(finished(const QString&, bool, size_t, const QString&)),
+                   this, SLOT(syslogSourceFinished(const QString&, bool, size_t, const QString&)));
+
+  source->start();
+  if (source->isFinished()) {
+    // Could not listen; the error has been shown.
+    delete source;
+    return false;
+  }
+
+  syslog_sources_.append(source);
+  Q_EMIT sourceStatusChanged(syslogLabel(source), source->statusText(), address);
+  return true;
+}
+
+void ConsoleMaster::saveSyslogAddresses() const
+{
+  QStringList addresses;
+  for (int i = 0; i < syslog_sources_.size(); i++) {
+    addresses.append(syslog_sources_[i]->address());
+  }
+  QSettings settings;
+  settings.setValue(SettingsKeys::SYSLOG_ADDRESSES, addresses);
+}
+
+QString ConsoleMaster::syslogLabel(const SyslogSource *source) const
+{
+  return tr("Syslog %1").arg(source->address());
+}
+
+void ConsoleMaster::syslogSourceStatusChanged()
+{
+  SyslogSource *source = qobject_cast<SyslogSource*>(sender());
+  if (source && syslog_sources_.contains(source)) {
+    Q_EMIT sourceStatusChanged(syslogLabel(source), source->statusText(), source->address());
+  }
+}
+
+void ConsoleMaster::syslogSourceFinished(const QString &name, bool success,
+                                         size_t, const QString &error_msg)
+{
+  if (!success) {
+    QMessageBox::warning(NULL, tr("Failed to receive syslog messages"),
+                         tr("Failed to receive syslog messages on %1:\n%2").arg(name).arg(error_msg));
+  }
+}
+
+void ConsoleMaster::fileLoadFinished(const QString &name, bool success,
+                                     size_t msg_count, const QString &error_msg)
+{
+  LogSource *source = qobject_cast<LogSource*>(sender());
+  if (success && source) {
+    const LogSourceStats &stats = source->stats();
+    Q_EMIT statusMessage(
+      tr("Loaded %1 messages from %2 in %3 s: %4 MB")
+      .arg(msg_count)
+      .arg(QFileInfo(name).fileName())
+      .arg(stats.elapsed, 0, 'f', 2)
+      .arg(stats.byte_count / (1024.0 * 1024.0), 0, 'f', 1));
+  } else if (!success) {
+    QMessageBox::warning(NULL, tr("Failed to read log file"),
+                         tr("Failed to read %1:\n%2").arg(name).arg(error_msg));
+  }
+}
+
+void ConsoleMaster::bagIndexRead(const swri_console::BagIndex &index)
+{
+  BagSource *source = qobject_cast<BagSource*>(sender());
+  const bool choose_query = query_bag_sources_.removeAll(source) > 0;
+  if (!source || index.msg_count == 0) {
+    return;
+  }
+
+  QSettings settings;
+  bool preview = settings.value(SettingsKeys::PREVIEW_LARGE_BAGS, true).toBool();
+  if (choose_query || (preview && index.msg_count >= PREVIEW_MIN_MESSAGES)) {
+    // The dialog is not run in a nested event loop.  The load starts
+    // when it is accepted, and rejecting it cancels the source, which
+    // then finishes like any other cancelled load.
+    BagLoadDialog *dlg = new BagLoadDialog(index, source);
+    QObject::connect(dlg, SIGNAL(accepted()), this, SLOT(bagQueryChosen()));
+    dlg->open();
+    return;
+  }
+
+  loadBag(source, BagQuery(index.begin_time, index.end_time));
+}
+
+void ConsoleMaster::bagQueryChosen()
+{
+  BagLoadDialog *dlg = qobject_cast<BagLoadDialog*>(sender());
+  if (dlg && !dlg->source()->isFinished()) {
+    loadBag(dlg->source(), dlg->query());
+  }
+}
+
+void ConsoleMaster::loadBag(BagSource *source, const BagQuery &query)
+{
+  // The dialog deletes itself along with the source.
+  new BagProgressDialog(source);
+  source->load(query);
+}
+
+void ConsoleMaster::bagLoadFinished(const QString &name, bool success,
+                                    size_t msg_count, const QString &error_msg)
+{
+  BagSource *source = qobject_cast<BagSource*>(sender());
+  if (!source) {
+    return;
+  }
+  query_bag_sources_.removeAll(source);
+
+  if (success) {
+    // Shown so that load throughput can be compared between bags.
+    // The rates count every message read, including those the query
+    // filtered out.
+    const BagLoadProgress &progress = source->lastProgress();
+    Q_EMIT statusMessage(
+      tr("Loaded %1 messages from %2 in %3 s: %4 msg/s, %5 MB/s")
+      .arg(msg_count)
+      .arg(QFileInfo(name).fileName())
+      .arg(progress.elapsed, 0, 'f', 2)
+      .arg(progress.messagesPerSecond(), 0, 'f', 0)
+      .arg(progress.megabytesPerSecond(), 0, 'f', 1));
+  } else if (!source->isCancelled()) {
+    QMessageBox::warning(NULL, tr("Failed to read bag"),
+                         tr("Failed to read %1:\n%2").arg(name).arg(error_msg));
+  }
+}
 }  // namespace swri_console
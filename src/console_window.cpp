@@ -30,13 +30,19 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <algorithm>
+#include <map>
 #include <set>
+#include <string>
+#include <vector>
 
 #include <rosgraph_msgs/Log.h>
 
 #include <swri_console/console_window.h>
 #include <swri_console/log_database.h>
 #include <swri_console/log_database_proxy_model.h>
+#include <swri_console/log_exporter.h>
+#include <swri_console/log_server.h>
 #include <swri_console/node_list_model.h>
 #include <swri_console/settings_keys.h>
 
@@ -46,21 +52,34 @@
 #include <QClipboard>
 #include <QDateTime>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QDir>
 #include <QScrollBar>
 #include <QMenu>
+#include <QMessageBox>
+#include <QProgressDialog>
+#include <QDialog>
+#include <QInputDialog>
+#include <QUrl>
+#include <QPlainTextEdit>
+#include <QVBoxLayout>
 #include <QSettings>
 
 using namespace Qt;
 
 namespace swri_console {
 
+// Selections with at least this many rows are copied incrementally
+// with a progress dialog instead of blocking the window.
+static const size_t ASYNC_COPY_ROWS = 100000;
+
 ConsoleWindow::ConsoleWindow(LogDatabase *db)
   :
   QMainWindow(),
   db_(db),
   db_proxy_(new LogDatabaseProxyModel(db)),
-  node_list_model_(new NodeListModel(db))
+  node_list_model_(new NodeListModel(db)),
+  copy_progress_(NULL)
 {
   ui.setupUi(this); 
 
@@ -78,6 +97,23 @@ ConsoleWindow::ConsoleWindow(LogDatabase *db)
 
   QObject::connect(ui.action_ReadBagFile, SIGNAL(triggered(bool)),
                    this, SLOT(promptForBagFile()));
+  QObject::connect(ui.action_ReadBagFileWithFilters, SIGNAL(triggered(bool)),
+                   this, SLOT(promptForFilteredBagFile()));
+
+  QObject::connect(ui.action_FollowLogDirectory, SIGNAL(triggered(bool)),
+                   this, SLOT(promptForLogDirectory()));
+
+  QObject::connect(ui.action_AddRosMaster, SIGNAL(triggered(bool)),
+                   this, SLOT(promptForRosMaster()));
+
+  QObject::connect(ui.action_RemoveRosMaster, SIGNAL(triggered(bool)),
+                   this, SLOT(promptToRemoveRosMaster()));
+
+  QObject::connect(ui.action_AttachToRecorder, SIGNAL(triggered(bool)),
+                   this, SLOT(promptForRecorder()));
+
+  QObject::connect(ui.action_ListenForSyslog, SIGNAL(triggered(bool)),
+                   this, SLOT(promptForSyslog()));
 
   QObject::connect(ui.action_SaveLogs, SIGNAL(triggered(bool)),
                    this, SLOT(saveLogs()));
@@ -103,6 +139,18 @@ ConsoleWindow::ConsoleWindow(LogDatabase *db)
   QObject::connect(ui.action_ColorizeLogs, SIGNAL(toggled(bool)),
                    db_proxy_, SLOT(setColorizeLogs(bool)));
 
+  QObject::connect(ui.action_CollapseMultiline, SIGNAL(toggled(bool)),
+                   db_proxy_, SLOT(setCollapseMultiline(bool)));
+
+  QObject::connect(ui.action_MaxLineLength, SIGNAL(triggered(bool)),
+                   this, SLOT(promptForMaxLineLength()));
+
+  QObject::connect(ui.action_PreviewLargeBags, SIGNAL(toggled(bool)),
+                   this, SLOT(togglePreviewLargeBags(bool)));
+
+  QObject::connect(ui.action_RawRosoutSubscription, SIGNAL(toggled(bool)),
+                   this, SLOT(toggleRawRosoutSubscription(bool)));
+
   QObject::connect(ui.debugColorWidget, SIGNAL(clicked(bool)),
                    this, SLOT(setDebugColor()));
   QObject::connect(ui.infoColorWidget, SIGNAL(clicked(bool)),
@@ -116,7 +164,6 @@ ConsoleWindow::ConsoleWindow(LogDatabase *db)
 
   ui.nodeList->setModel(node_list_model_);  
   ui.messageList->setModel(db_proxy_);
-  ui.messageList->setUniformItemSizes(true);
 
   QObject::connect(
     ui.nodeList->selectionModel(),
@@ -143,9 +190,16 @@ ConsoleWindow::ConsoleWindow(LogDatabase *db)
   QObject::connect(
     db_proxy_, SIGNAL(messagesAdded()),
     this, SLOT(messagesAdded()));
+  QObject::connect(
+    db_proxy_, SIGNAL(selectionCopyFinished(const QString &, bool)),
+    this, SLOT(selectionCopyFinished(const QString &, bool)));
   QObject::connect(ui.checkFollowNewest, SIGNAL(toggled(bool)),
                    this, SLOT(setFollowNewest(bool)));
 
+  // Double-clicking a collapsed multi-line message expands it.
+  QObject::connect(ui.messageList, SIGNAL(rowDoubleClicked(size_t)),
+                   this, SLOT(toggleMessageExpanded(size_t)));
+
   // Right-click menu for the message list
   QObject::connect(ui.messageList, SIGNAL(customContextMenuRequested(const QPoint&)),
                     this, SLOT(showLogContextMenu(const QPoint&)));
@@ -176,6 +230,12 @@ ConsoleWindow::ConsoleWindow(LogDatabase *db)
   connection_status_ = new QLabel("Not connected");
   connection_status_->setFrameStyle(QFrame::Panel | QFrame::Sunken);
   statusBar()->addPermanentWidget(connection_status_);
+
+  // Only shown once live messages have been lost or shed.
+  ingest_status_ = new QLabel();
+  ingest_status_->setFrameStyle(QFrame::Panel | QFrame::Sunken);
+  ingest_status_->hide();
+  statusBar()->addPermanentWidget(ingest_status_);
   
   loadSettings();
 }
@@ -199,13 +259,83 @@ void ConsoleWindow::clearMessages()
 void ConsoleWindow::saveLogs()
 {
   QString defaultname = QDateTime::currentDateTime().toString(Qt::ISODate) + ".bag";
+  const QString bag_filter = tr("Bag Files (*.bag)");
+  const QString bz2_filter = tr("Bag Files, BZ2 Compressed (*.bag)");
+  const QString lz4_filter = tr("Bag Files, LZ4 Compressed (*.bag)");
+  const QString text_filter = tr("Text Files (*.txt)");
+  const QString json_filter = tr("Newline-delimited JSON Files (*.ndjson *.jsonl)");
+  const QString session_filter = tr("Session Files (*.swrilog)");
+  QString selected_filter;
   QString filename = QFileDialog::getSaveFileName(this,
                                                   "Save Logs",
                                                   QDir::homePath() + QDir::separator() + defaultname,
-                                                  tr("Bag Files (*.bag);;Text Files (*.txt)"));
-  if (filename != NULL && !filename.isEmpty()) {
-    db_proxy_->saveToFile(filename);
+                                                  (QStringList()
+                                                   << bag_filter
+                                                   << bz2_filter
+                                                   << lz4_filter
+                                                   << text_filter
+                                                   << json_filter
+                                                   << session_filter).join(";;"),
+                                                  &selected_filter);
+  if (filename == NULL || filename.isEmpty()) {
+    return;
+  }
+
+  LogExporter::Format format = LogExporter::TEXT;
+  if (filename.endsWith(".bag", Qt::CaseInsensitive)) {
+    format = LogExporter::BAG;
+    if (selected_filter == bz2_filter) {
+      format = LogExporter::BAG_BZ2;
+    } else if (selected_filter == lz4_filter) {
+      format = LogExporter::BAG_LZ4;
+    }
+  } else if (filename.endsWith(".ndjson", Qt::CaseInsensitive) ||
+             filename.endsWith(".jsonl", Qt::CaseInsensitive)) {
+    format = LogExporter::NDJSON;
+  } else if (filename.endsWith(".swrilog", Qt::CaseInsensitive)) {
+    format = LogExporter::SESSION;
   }
+
+  // The filtered entries are copied here so the export is not
+  // affected by messages that arrive or filters that change while it
+  // runs.
+  LogExporter *exporter = new LogExporter(filename,
+                                          db_proxy_->snapshotEntries(),
+                                          format,
+                                          db_proxy_->formatter(),
+                                          this);
+
+  QProgressDialog *progress = new QProgressDialog(this);
+  progress->setWindowTitle(tr("Save Logs"));
+  progress->setLabelText(tr("Saving logs to %1...").arg(QFileInfo(filename).fileName()));
+  progress->setRange(0, 100);
+  progress->setAutoClose(false);
+  progress->setAutoReset(false);
+  progress->setMinimumDuration(500);
+  QObject::connect(progress, SIGNAL(canceled()),
+                   exporter, SLOT(cancel()));
+  QObject::connect(exporter, SIGNAL(progress(int)),
+                   progress, SLOT(setValue(int)));
+  QObject::connect(exporter, SIGNAL(destroyed()),
+                   progress, SLOT(deleteLater()));
+  QObject::connect(exporter, SIGNAL(finished(bool, const QString &)),
+                   this, SLOT(exportFinished(bool, const QString &)));
+
+  exporter->start();
+}
+
+void ConsoleWindow::exportFinished(bool success, const QString &error_msg)
+{
+  LogExporter *exporter = qobject_cast<LogExporter*>(sender());
+  if (!exporter) {
+    return;
+  }
+
+  if (!success && !exporter->isCancelled()) {
+    QMessageBox::warning(this, tr("Save Logs"),
+                         tr("Failed to save %1:\n%2").arg(exporter->filename()).arg(error_msg));
+  }
+  exporter->deleteLater();
 }
 
 void ConsoleWindow::rosConnected(bool connected, const QString &master_uri)
@@ -217,6 +347,78 @@ void ConsoleWindow::rosConnected(bool connected, const QString &master_uri)
   }
 }
 
+// Appends "name: count" lines for the largest counts to text.
+static void appendTopCounts(const std::map<std::string, uint64_t> &counts, QString &text)
+{
+  static const size_t MAX_LINES = 10;
+
+  std::vector<std::pair<uint64_t, std::string> > sorted;
+  for (std::map<std::string, uint64_t>::const_iterator it = counts.begin();
+       it != counts.end(); ++it) {
+    sorted.push_back(std::make_pair(it->second, it->first));
+  }
+  std::sort(sorted.rbegin(), sorted.rend());
+
+  for (size_t i = 0; i < sorted.size() && i < MAX_LINES; i++) {
+    text += QString("\n  %1: %2")
+      .arg(QString::fromStdString(sorted[i].second))
+      .arg(sorted[i].first);
+  }
+  if (sorted.size() > MAX_LINES) {
+    text += QString("\n  (%1 more)").arg(sorted.size() - MAX_LINES);
+  }
+}
+
+void ConsoleWindow::setSourceStatus(const QString &label, const QString &status,
+                                    const QString &details)
+{
+  QLabel *widget = source_status_.value(label, NULL);
+  if (status.isEmpty()) {
+    delete widget;
+    source_status_.remove(label);
+    return;
+  }
+
+  if (!widget) {
+    widget = new QLabel();
+    widget->setFrameStyle(QFrame::Panel | QFrame::Sunken);
+    statusBar()->addPermanentWidget(widget);
+    source_status_[label] = widget;
+  }
+  widget->setText(status);
+  widget->setToolTip(details);
+}
+
+void ConsoleWindow::showStatusMessage(const QString &message)
+{
+  statusBar()->showMessage(message);
+}
+
+void ConsoleWindow::ingestStatsUpdated(const swri_console::IngestStats &stats)
+{
+  const uint64_t lost = stats.totalLost();
+  const uint64_t shed = stats.totalShed();
+  if (lost == 0 && shed == 0) {
+    ingest_status_->hide();
+    return;
+  }
+
+  ingest_status_->setText(tr("Lost: %1  Sampled out: %2").arg(lost).arg(shed));
+
+  QString tooltip = tr("Live messages that are not in the log.");
+  if (lost) {
+    tooltip += tr("\n\nLost before reaching the console, by publisher:");
+    appendTopCounts(stats.lost, tooltip);
+  }
+  if (shed) {
+    tooltip += tr("\n\nDEBUG and INFO messages discarded while the console "
+                  "was overloaded, by node:");
+    appendTopCounts(stats.shed, tooltip);
+  }
+  ingest_status_->setToolTip(tooltip);
+  ingest_status_->show();
+}
+
 void ConsoleWindow::closeEvent(QCloseEvent *event)
 {
   QMainWindow::closeEvent(event);
@@ -294,6 +496,10 @@ void ConsoleWindow::showLogContextMenu(const QPoint& point)
   QAction copy_extended(tr("Copy Extended"), ui.messageList);
   connect(&copy_extended, SIGNAL(triggered()), this, SLOT(copyExtendedLogs()));
 
+  QAction show_details(tr("Show Details..."), ui.messageList);
+  show_details.setEnabled(!ui.messageList->selectedRanges().empty());
+  connect(&show_details, SIGNAL(triggered()), this, SLOT(showLogDetails()));
+
   QAction alternate_row_colors(tr("Alternate Row Colors"), ui.messageList);
   alternate_row_colors.setCheckable(true);
   alternate_row_colors.setChecked(ui.messageList->alternatingRowColors());
@@ -303,11 +509,65 @@ void ConsoleWindow::showLogContextMenu(const QPoint& point)
   contextMenu.addAction(&select_all);
   contextMenu.addAction(&copy);
   contextMenu.addAction(&copy_extended);
+  contextMenu.addAction(&show_details);
   contextMenu.addAction(&alternate_row_colors);
 
   contextMenu.exec(ui.messageList->mapToGlobal(point));
 }
 
+void ConsoleWindow::showLogDetails()
+{
+  const std::vector<LogDatabaseProxyModel::RowRange> &ranges =
+    ui.messageList->selectedRanges();
+  if (ranges.empty()) {
+    return;
+  }
+
+  // The full text of the message is only fetched here, since the
+  // list itself only displays the beginning of very long lines.
+  std::vector<LogDatabaseProxyModel::RowRange> row;
+  row.push_back(LogDatabaseProxyModel::RowRange(ranges[0].first, ranges[0].first));
+
+  QDialog *dialog = new QDialog(this);
+  dialog->setAttribute(Qt::WA_DeleteOnClose);
+  dialog->setWindowTitle(tr("Log Details"));
+  dialog->resize(800, 600);
+
+  QPlainTextEdit *text = new QPlainTextEdit(dialog);
+  text->setReadOnly(true);
+  text->setLineWrapMode(QPlainTextEdit::NoWrap);
+  text->setFont(ui.messageList->font());
+  text->setPlainText(db_proxy_->selectionText(row, true));
+
+  QVBoxLayout *layout = new QVBoxLayout(dialog);
+  layout->addWidget(text);
+
+  dialog->show();
+}
+
+void ConsoleWindow::promptForMaxLineLength()
+{
+  bool ok = false;
+  int length = QInputDialog::getInt(
+    this,
+    tr("Maximum Line Length"),
+    tr("Characters displayed before long lines are elided:"),
+    db_proxy_->maxLineLength(),
+    80,
+    1000000,
+    100,
+    &ok);
+
+  if (ok) {
+    db_proxy_->setMaxLineLength(length);
+  }
+}
+
+void ConsoleWindow::toggleMessageExpanded(size_t row)
+{
+  db_proxy_->toggleExpanded(row);
+}
+
 void ConsoleWindow::userScrolled(int value)
 {
   if (value != ui.messageList->verticalScrollBar()->maximum()) {
@@ -329,22 +589,54 @@ void ConsoleWindow::selectAllLogs()
 
 void ConsoleWindow::copyLogs()
 {
-  QStringList buffer;
-  foreach(const QModelIndex &index, ui.messageList->selectionModel()->selectedIndexes())
-  {
-    buffer << db_proxy_->data(index, Qt::DisplayRole).toString();
-  }
-  QApplication::clipboard()->setText(buffer.join(tr("\n")));
+  copySelection(false);
 }
 
 void ConsoleWindow::copyExtendedLogs()
 {
-  QStringList buffer;
-  foreach(const QModelIndex &index, ui.messageList->selectionModel()->selectedIndexes())
-  {
-    buffer << db_proxy_->data(index, LogDatabaseProxyModel::ExtendedLogRole).toString();
+  copySelection(true);
+}
+
+void ConsoleWindow::copySelection(bool extended)
+{
+  const std::vector<LogDatabaseProxyModel::RowRange> &ranges =
+    ui.messageList->selectedRanges();
+  size_t row_count = 0;
+  for (size_t i = 0; i < ranges.size(); i++) {
+    row_count += ranges[i].last - ranges[i].first + 1;
+  }
+
+  if (row_count < ASYNC_COPY_ROWS) {
+    QApplication::clipboard()->setText(db_proxy_->selectionText(ranges, extended));
+    return;
+  }
+
+  if (!copy_progress_) {
+    copy_progress_ = new QProgressDialog(this);
+    copy_progress_->setWindowTitle(tr("Copy"));
+    copy_progress_->setLabelText(tr("Copying logs to the clipboard..."));
+    copy_progress_->setRange(0, 100);
+    QObject::connect(copy_progress_, SIGNAL(canceled()),
+                     db_proxy_, SLOT(cancelSelectionCopy()));
+    QObject::connect(db_proxy_, SIGNAL(selectionCopyProgress(int)),
+                     copy_progress_, SLOT(setValue(int)));
+  }
+  copy_progress_->setValue(0);
+  copy_progress_->show();
+
+  db_proxy_->startSelectionCopy(ranges, extended);
+}
+
+void ConsoleWindow::selectionCopyFinished(const QString &text, bool completed)
+{
+  if (copy_progress_) {
+    copy_progress_->reset();
+    copy_progress_->hide();
+  }
+
+  if (completed) {
+    QApplication::clipboard()->setText(text);
   }
-  QApplication::clipboard()->setText(buffer.join(tr("\n\n")));
 }
 
 void ConsoleWindow::setFollowNewest(bool follow)
@@ -519,6 +811,20 @@ void ConsoleWindow::toggleAlternateRowColors(bool checked)
   settings.setValue(SettingsKeys::ALTERNATE_LOG_ROW_COLORS, checked);
 }
 
+void ConsoleWindow::togglePreviewLargeBags(bool checked)
+{
+  // The setting is read by ConsoleMaster each time a bag is opened.
+  QSettings settings;
+  settings.setValue(SettingsKeys::PREVIEW_LARGE_BAGS, checked);
+}
+
+void ConsoleWindow::toggleRawRosoutSubscription(bool checked)
+{
+  // The setting is read by the ROS backend each time it connects.
+  QSettings settings;
+  settings.setValue(SettingsKeys::RAW_ROSOUT_SUBSCRIPTION, checked);
+}
+
 void ConsoleWindow::loadSettings()
 {
   // First, load all the boolean settings...
@@ -526,6 +832,9 @@ void ConsoleWindow::loadSettings()
   loadBooleanSetting(SettingsKeys::ABSOLUTE_TIMESTAMPS, ui.action_AbsoluteTimestamps);
   loadBooleanSetting(SettingsKeys::USE_REGEXPS, ui.action_RegularExpressions);
   loadBooleanSetting(SettingsKeys::COLORIZE_LOGS, ui.action_ColorizeLogs);
+  loadBooleanSetting(SettingsKeys::COLLAPSE_MULTILINE, ui.action_CollapseMultiline);
+  loadBooleanSetting(SettingsKeys::PREVIEW_LARGE_BAGS, ui.action_PreviewLargeBags);
+  loadBooleanSetting(SettingsKeys::RAW_ROSOUT_SUBSCRIPTION, ui.action_RawRosoutSubscription);
   loadBooleanSetting(SettingsKeys::FOLLOW_NEWEST, ui.checkFollowNewest);
 
   // The severity level has to be handled a little differently, since they're all combined
@@ -557,21 +866,142 @@ void ConsoleWindow::loadSettings()
   QString excludeFilter = settings.value(SettingsKeys::EXCLUDE_FILTER, "").toString();
   ui.excludeText->setText(excludeFilter);
 
+  int max_line_length = settings.value(SettingsKeys::MAX_LINE_LENGTH,
+                                       LogDatabaseProxyModel::DEFAULT_MAX_LINE_LENGTH).toInt();
+  db_proxy_->setMaxLineLength(max_line_length);
+
   bool alternate_row_colors = settings.value(SettingsKeys::ALTERNATE_LOG_ROW_COLORS, true).toBool();
   ui.messageList->setAlternatingRowColors(alternate_row_colors);
 }
 
 void ConsoleWindow::promptForBagFile()
 {
-  QString filename = QFileDialog::getOpenFileName(
+  // Selecting several bag files (e.g. the pieces of a split
+  // recording) reads them as one time-ordered stream.
+  QStringList filenames = QFileDialog::getOpenFileNames(
     NULL,
-    tr("Open Bag File"),
+    tr("Open Log Files"),
     QDir::homePath(),
-    tr("Bag Files (*.bag)"));
+    tr("Log Files (*.bag *.swrilog *.log);;Bag Files (*.bag);;"
+       "Session Files (*.swrilog);;Text Logs (*.log)"));
 
-  if (filename != NULL) {
-    Q_EMIT readBagFile(filename);
+  if (!filenames.isEmpty()) {
+    Q_EMIT readBagFiles(filenames);
   }  
 }
+
+void ConsoleWindow::promptForFilteredBagFile()
+{
+  // The bags' index is read first, and the time range, nodes and
+  // severity to load are chosen from it, whatever the size of the
+  // bags.
+  QStringList filenames = QFileDialog::getOpenFileNames(
+    NULL,
+    tr("Open Bag Files"),
+    QDir::homePath(),
+    tr("Bag Files (*.bag)"));
+
+  if (!filenames.isEmpty()) {
+    Q_EMIT readBagFiles(filenames, true);
+  }
+}
+
+void ConsoleWindow::promptForRosMaster()
+{
+  bool ok;
+  QString uri = QInputDialog::getText(this,
+                                      tr("Add ROS Master"),
+                                      tr("Master URI:"),
+                                      QLineEdit::Normal,
+                                      "http://localhost:11311",
+                                      &ok).trimmed();
+  if (!ok || uri.isEmpty()) {
+    return;
+  }
+
+  // The host name is a reasonable default label.
+  QString label = QInputDialog::getText(this,
+                                        tr("Add ROS Master"),
+                                        tr("Label (prefixed to node names):"),
+                                        QLineEdit::Normal,
+                                        QUrl(uri).host(),
+                                        &ok).trimmed();
+  if (!ok || label.isEmpty()) {
+    return;
+  }
+
+  Q_EMIT addRosMaster(label, uri);
+}
+
+void ConsoleWindow::promptToRemoveRosMaster()
+{
+  QStringList labels = source_status_.keys();
+  if (labels.isEmpty()) {
+    QMessageBox::information(this, tr("Remove ROS Master"),
+                             tr("No additional ROS masters are being followed."));
+    return;
+  }
+
+  bool ok;
+  QString label = QInputDialog::getItem(this,
+                                        tr("Remove ROS Master"),
+                                        tr("ROS master:"),
+                                        labels, 0, false, &ok);
+  if (ok) {
+    Q_EMIT removeRosMaster(label);
+  }
+}
+
+void ConsoleWindow::promptForRecorder()
+{
+  bool ok;
+  QString name = QInputDialog::getText(this,
+                                       tr("Attach to Recorder"),
+                                       tr("Recorder socket:"),
+                                       QLineEdit::Normal,
+                                       DEFAULT_SERVER_NAME,
+                                       &ok).trimmed();
+  if (ok && !name.isEmpty()) {
+    Q_EMIT attachToRecorder(name);
+  }
+}
+
+void ConsoleWindow::promptForSyslog()
+{
+  bool ok;
+  QString address = QInputDialog::getText(this,
+                                          tr("Listen for Syslog"),
+                                          tr("UDP port, optionally as host:port:"),
+                                          QLineEdit::Normal,
+                                          "5140",
+                                          &ok).trimmed();
+  if (ok && !address.isEmpty()) {
+    Q_EMIT listenForSyslog(address);
+  }
+}
+
+void ConsoleWindow::promptForLogDirectory()
+{
+  // Start in the directory of the most recent ROS run, found the same
+  // way roslaunch does.
+  QString log_dir = QString::fromLocal8Bit(qgetenv("ROS_LOG_DIR"));
+  if (log_dir.isEmpty()) {
+    QString ros_home = QString::fromLocal8Bit(qgetenv("ROS_HOME"));
+    if (ros_home.isEmpty()) {
+      ros_home = QDir::home().filePath(".ros");
+    }
+    log_dir = QDir(ros_home).filePath("log");
+  }
+  QString latest = QDir(log_dir).filePath("latest");
+
+  QString directory = QFileDialog::getExistingDirectory(
+    NULL,
+    tr("Follow Log Directory"),
+    QDir(latest).exists() ? latest : QDir::homePath());
+
+  if (!directory.isEmpty()) {
+    Q_EMIT followLogDirectory(directory);
+  }
+}
 }  // namespace swri_console
 
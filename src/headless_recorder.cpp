@@ -0,0 +1,420 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/headless_recorder.h>
+#include <swri_console/session_file.h>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <utility>
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <QCoreApplication>
+#include <QDesktopServices>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSocketNotifier>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimerEvent>
+#include <QtConcurrentRun>
+
+namespace swri_console
+{
+void registerMetaTypes();
+
+const char HEADLESS_ARGUMENT[] = "--headless";
+
+// Interval (ms) at which new entries are appended to the spill file.
+static const int SPILL_INTERVAL = 60000;
+
+// Maximum number of entries in a block of the spill file.
+static const size_t SPILL_BLOCK_SIZE = 100000;
+
+// Identifies a spill file.  Bumped if the file's layout changes.
+static const char SPILL_MAGIC[8] = { 'S', 'W', 'R', 'I', 'S', 'P', 'L', '2' };
+
+// Signals are passed to the event loop through a pipe.
+static int signal_fds[2] = { -1, -1 };
+
+static void handleTerminationSignal(int)
+{
+  char c = 1;
+  ssize_t ignored = ::write(signal_fds[1], &c, 1);
+  (void)ignored;
+}
+
+// Appends the blocks to the spill file, preceded by a SERVER_HELLO
+// frame if instance_id is not 0.  If any of them can not be written,
+// the file is truncated back to its previous size so that it does not
+// end in a partial block.
+static QString appendSpillFile(QString filename, uint64_t instance_id,
+                               std::vector<LogBatchPtr> blocks)
+{
+  QFile file(filename);
+  if (!file.open(QFile::WriteOnly | QFile::Append)) {
+    return file.errorString();
+  }
+
+  const qint64 start_size = file.size();
+  QString error_msg;
+  if (start_size == 0 &&
+      file.write(SPILL_MAGIC, sizeof(SPILL_MAGIC)) != static_cast<qint64>(sizeof(SPILL_MAGIC))) {
+    error_msg = file.errorString();
+  }
+  if (error_msg.isEmpty() && instance_id != 0 &&
+      !writeServerFrame(&file, SERVER_HELLO, &instance_id, sizeof(instance_id))) {
+    error_msg = file.errorString();
+  }
+
+  for (size_t i = 0; error_msg.isEmpty() && i < blocks.size(); i++) {
+    QByteArray data = encodeSessionData(*blocks[i]);
+    if (data.isEmpty()) {
+      error_msg = "Could not encode the log entries.";
+    } else if (!writeServerFrame(&file, SERVER_ENTRIES, data.constData(), data.size())) {
+      error_msg = file.errorString();
+    }
+  }
+  if (error_msg.isEmpty() && !file.flush()) {
+    error_msg = file.errorString();
+  }
+
+  if (!error_msg.isEmpty()) {
+    file.resize(start_size);
+  }
+  return error_msg;
+}
+
+// Decodes a block of the spill file.
+static LogBatchPtr decodeSpillBlock(const uchar *data, uint32_t size, uint16_t source)
+{
+  LogBatchPtr batch(new std::vector<LogEntry>());
+  // Copied, so that the block is aligned for the session file reader.
+  QString error_msg = decodeSessionData(
+    QByteArray(reinterpret_cast<const char*>(data), size), source, batch.get());
+  if (!error_msg.isEmpty()) {
+    qWarning("Skipping a bad block in the spill file: %s", qPrintable(error_msg));
+  }
+  return batch;
+}
+
+HeadlessRecorder::HeadlessRecorder(const QString &spill_file)
+  :
+  spill_file_(spill_file),
+  server_(&db_),
+  hello_spilled_(false),
+  spilled_(0),
+  spilling_(0),
+  spill_timer_id_(0),
+  signal_notifier_(NULL)
+{
+  QObject::connect(&ros_source_, SIGNAL(batchRead(const swri_console::LogBatchPtr &)),
+                   &db_, SLOT(queueBatch(const swri_console::LogBatchPtr &)));
+  QObject::connect(&ros_source_, SIGNAL(connected(bool, const QString&)),
+                   &server_, SLOT(setStatus(bool, const QString&)));
+  QObject::connect(&ros_source_, SIGNAL(connected(bool, const QString&)),
+                   this, SLOT(installSignalHandlers()));
+  QObject::connect(&spill_watcher_, SIGNAL(finished()),
+                   this, SLOT(spillFinished()));
+}
+
+HeadlessRecorder::~HeadlessRecorder()
+{
+  spill_watcher_.waitForFinished();
+}
+
+bool HeadlessRecorder::start(const QString &server_name)
+{
+  if (!server_.listen(server_name)) {
+    error_msg_ = QString("Could not listen on %1: %2").arg(server_name).arg(server_.errorString());
+    return false;
+  }
+
+  if (::pipe(signal_fds) == 0) {
+    signal_notifier_ = new QSocketNotifier(signal_fds[0], QSocketNotifier::Read, this);
+    QObject::connect(signal_notifier_, SIGNAL(activated(int)),
+                     this, SLOT(handleSignal()));
+    installSignalHandlers();
+  } else {
+    qWarning("Could not create signal pipe: %s", strerror(errno));
+  }
+
+  // The logs recorded by previous runs are read back before the ROS
+  // source starts, so that they come first in the database.
+  loadSpillFile();
+  QString error_msg = appendSpillFile(spill_file_, server_.instanceId(), std::vector<LogBatchPtr>());
+  if (error_msg.isEmpty()) {
+    hello_spilled_ = true;
+  } else {
+    qWarning("Failed to write %s: %s", qPrintable(spill_file_), qPrintable(error_msg));
+  }
+
+  ros_source_.start();
+  spill_timer_id_ = startTimer(SPILL_INTERVAL);
+  return true;
+}
+
+void HeadlessRecorder::loadSpillFile()
+{
+  QFile file(spill_file_);
+  if (!file.exists()) {
+    QDir().mkpath(QFileInfo(spill_file_).absolutePath());
+    return;
+  }
+  if (!file.open(QFile::ReadWrite)) {
+    qWarning("Could not open %s: %s", qPrintable(spill_file_), qPrintable(file.errorString()));
+    return;
+  }
+
+  const qint64 size = file.size();
+  if (size == 0) {
+    return;
+  }
+
+  uchar *data = file.map(0, size);
+  if (!data ||
+      size < static_cast<qint64>(sizeof(SPILL_MAGIC)) ||
+      memcmp(data, SPILL_MAGIC, sizeof(SPILL_MAGIC)) != 0) {
+    // The unreadable file is kept for inspection instead of being
+    // appended to.
+    qWarning("Could not read %s: %s", qPrintable(spill_file_),
+             data ? "Not a spill file." : qPrintable(file.errorString()));
+    file.close();
+    QFile::remove(spill_file_ + ".bad");
+    QFile::rename(spill_file_, spill_file_ + ".bad");
+    return;
+  }
+
+  // Blocks are decoded on the thread pool and added to the database
+  // in file order.  Only a few are in flight at once, so a large file
+  // is not copied into memory twice.
+  const uint16_t source = db_.addSource(QFileInfo(spill_file_).fileName());
+  const size_t max_pending = std::max(2, 2 * QThreadPool::globalInstance()->maxThreadCount());
+  std::deque<QFuture<LogBatchPtr> > pending;
+  size_t msg_count = 0;
+
+  // The entries that follow an earlier run's SERVER_HELLO are that
+  // run's.  For each run, the number of blocks before its frame is
+  // kept, and the number of entries in the blocks so far.
+  std::vector<std::pair<uint64_t, size_t> > runs;
+  std::vector<size_t> block_ends;
+  size_t block_count = 0;
+
+  size_t pos = sizeof(SPILL_MAGIC);
+  uint8_t type;
+  const uint8_t *frame;
+  uint32_t frame_size;
+  while (parseRelayFrame(data + pos, size - pos, &type, &frame, &frame_size)) {
+    pos += RELAY_HEADER_SIZE + frame_size;
+    if (type == SERVER_HELLO) {
+      uint64_t instance_id = 0;
+      memcpy(&instance_id, frame, std::min(static_cast<size_t>(frame_size), sizeof(instance_id)));
+      runs.push_back(std::make_pair(instance_id, block_count));
+      continue;
+    } else if (type != SERVER_ENTRIES) {
+      continue;
+    }
+
+    pending.push_back(QtConcurrent::run(&decodeSpillBlock, frame, frame_size, source));
+    block_count++;
+    while (pending.size() >= max_pending ||
+           (!pending.empty() && pending.front().isFinished())) {
+      LogBatchPtr batch = pending.front().result();
+      pending.pop_front();
+      msg_count += batch->size();
+      block_ends.push_back(msg_count);
+      db_.queueBatch(batch);
+    }
+  }
+  while (!pending.empty()) {
+    LogBatchPtr batch = pending.front().result();
+    pending.pop_front();
+    msg_count += batch->size();
+    block_ends.push_back(msg_count);
+    db_.queueBatch(batch);
+  }
+
+  std::map<uint64_t, size_t> history;
+  for (size_t i = 0; i < runs.size(); i++) {
+    const size_t end_block = (i + 1 < runs.size()) ? runs[i + 1].second : block_count;
+    history[runs[i].first] = (end_block == 0) ? 0 : block_ends[end_block - 1];
+  }
+  server_.setHistory(history);
+
+  file.unmap(data);
+  if (pos < static_cast<size_t>(size)) {
+    qWarning("Discarding an incomplete block at the end of %s.", qPrintable(spill_file_));
+    file.resize(pos);
+  }
+
+  db_.processQueue();
+  spilled_ = spilling_ = db_.log().size();
+}
+
+void HeadlessRecorder::installSignalHandlers()
+{
+  if (signal_fds[1] < 0) {
+    return;
+  }
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = &handleTerminationSignal;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+  sigaction(SIGHUP, &action, NULL);
+}
+
+void HeadlessRecorder::timerEvent(QTimerEvent *event)
+{
+  if (event->timerId() == spill_timer_id_) {
+    spill();
+  }
+}
+
+std::vector<LogBatchPtr> HeadlessRecorder::unspilledBlocks()
+{
+  const std::deque<LogEntry> &log = db_.log();
+  spilling_ = log.size();
+
+  std::vector<LogBatchPtr> blocks;
+  for (size_t begin = spilled_; begin < spilling_; begin += SPILL_BLOCK_SIZE) {
+    const size_t end = std::min(begin + SPILL_BLOCK_SIZE, spilling_);
+    blocks.push_back(LogBatchPtr(new std::vector<LogEntry>(log.begin() + begin, log.begin() + end)));
+  }
+  return blocks;
+}
+
+void HeadlessRecorder::spill()
+{
+  if (spilling_ != spilled_ || db_.log().size() == spilled_) {
+    return;
+  }
+
+  // Only the entries recorded since the last spill are copied.  They
+  // are encoded and written on the thread pool so that ingestion and
+  // the attached consoles are not held up.
+  const uint64_t instance_id = hello_spilled_ ? 0 : server_.instanceId();
+  spill_watcher_.setFuture(QtConcurrent::run(&appendSpillFile, spill_file_, instance_id,
+                                             unspilledBlocks()));
+}
+
+void HeadlessRecorder::spillFinished()
+{
+  if (spilling_ == spilled_) {
+    return;
+  }
+
+  QString error_msg = spill_watcher_.result();
+  if (error_msg.isEmpty()) {
+    hello_spilled_ = true;
+    spilled_ = spilling_;
+  } else {
+    // The same entries are tried again by the next spill.
+    qWarning("Failed to write %s: %s", qPrintable(spill_file_), qPrintable(error_msg));
+    spilling_ = spilled_;
+  }
+}
+
+void HeadlessRecorder::handleSignal()
+{
+  char c;
+  ssize_t ignored = ::read(signal_fds[0], &c, 1);
+  (void)ignored;
+  shutdown();
+}
+
+void HeadlessRecorder::shutdown()
+{
+  killTimer(spill_timer_id_);
+  spill_watcher_.waitForFinished();
+  spillFinished();
+
+  // Entries still waiting in the database's queue are spilled too.
+  db_.processQueue();
+  if (db_.log().size() != spilled_) {
+    const uint64_t instance_id = hello_spilled_ ? 0 : server_.instanceId();
+    QString error_msg = appendSpillFile(spill_file_, instance_id, unspilledBlocks());
+    if (error_msg.isEmpty()) {
+      spilled_ = spilling_;
+    } else {
+      qWarning("Failed to write %s: %s", qPrintable(spill_file_), qPrintable(error_msg));
+      spilling_ = spilled_;
+    }
+  }
+
+  QCoreApplication::quit();
+}
+
+int runHeadless(int argc, char **argv)
+{
+  QCoreApplication app(argc, argv);
+  registerMetaTypes();
+
+  QCoreApplication::setOrganizationName("Southwest Research Institute");
+  QCoreApplication::setOrganizationDomain("swri.org");
+  QCoreApplication::setApplicationName("SwRI Console");
+
+  QString server_name = DEFAULT_SERVER_NAME;
+  QString spill_file = QDir(QDesktopServices::storageLocation(
+                              QDesktopServices::CacheLocation)).filePath("headless.spill");
+
+  QStringList args = app.arguments();
+  for (int i = 2; i < args.size(); i++) {
+    if (args[i] == "--socket" && i + 1 < args.size()) {
+      server_name = args[++i];
+    } else if (args[i] == "--spill" && i + 1 < args.size()) {
+      spill_file = args[++i];
+    } else if (!args[i].contains(":=")) {
+      fprintf(stderr, "usage: %s %s [--socket NAME] [--spill FILE]\n", argv[0], HEADLESS_ARGUMENT);
+      return 1;
+    }
+  }
+
+  HeadlessRecorder recorder(spill_file);
+  if (!recorder.start(server_name)) {
+    fprintf(stderr, "%s\n", qPrintable(recorder.errorString()));
+    return 1;
+  }
+
+  fprintf(stderr, "Recording to %s (%lu messages read back), serving on %s\n",
+          qPrintable(spill_file), static_cast<unsigned long>(recorder.spilledCount()),
+          qPrintable(server_name));
+  return app.exec();
+}
+}  // namespace swri_console
@@ -0,0 +1,84 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/ingest_monitor.h>
+
+#include <rosgraph_msgs/Log.h>
+
+namespace swri_console
+{
+IngestMonitor::IngestMonitor()
+  :
+  debug_count_(0),
+  info_count_(0)
+{
+}
+
+bool IngestMonitor::trackSequence(const std::string &publisher, uint32_t seq)
+{
+  std::map<std::string, uint32_t>::iterator it = last_seq_.find(publisher);
+  if (it == last_seq_.end()) {
+    last_seq_[publisher] = seq;
+    return false;
+  }
+
+  const uint32_t expected = it->second + 1;
+  it->second = seq;
+
+  // A sequence number that goes backwards means the publisher was
+  // restarted, not that messages were lost.
+  if (seq > expected) {
+    stats_.lost[publisher] += seq - expected;
+    return true;
+  }
+  return false;
+}
+
+bool IngestMonitor::keep(const std::string &node, uint8_t level, size_t backlog)
+{
+  if (level > rosgraph_msgs::Log::INFO || backlog < SHED_THRESHOLD) {
+    return true;
+  }
+
+  bool kept = false;
+  if (backlog < DROP_THRESHOLD) {
+    const uint64_t interval = 2 + (backlog - SHED_THRESHOLD) / SHED_STEP;
+    if (level == rosgraph_msgs::Log::INFO) {
+      kept = (info_count_++ % interval) == 0;
+    } else {
+      kept = (debug_count_++ % (2 * interval)) == 0;
+    }
+  }
+
+  if (!kept) {
+    stats_.shed[node]++;
+  }
+  return kept;
+}
+}  // namespace swri_console
@@ -30,12 +30,29 @@
 
 #include <swri_console/log_database.h>
 
+#include <iterator>
+#include <limits>
+
 namespace swri_console
 {
+void convertLogMessage(const rosgraph_msgs::Log &msg, LogEntry *entry)
+{
+  entry->stamp = msg.header.stamp;
+  entry->level = msg.level;
+  entry->node = msg.name;
+  entry->file = msg.file;
+  entry->function = msg.function;
+  entry->line = msg.line;
+  entry->text = QString(msg.msg.c_str()).split('\n');
+  entry->seq = msg.header.seq;
+  entry->source = LogEntry::LIVE_SOURCE;
+}
+
 LogDatabase::LogDatabase()
   :
   min_time_(ros::TIME_MAX)
 {
+  sources_.push_back("ROS");
   startTimer(100);
 }
 
@@ -51,37 +68,88 @@ void LogDatabase::clear()
   Q_EMIT databaseCleared();
 }
 
+uint16_t LogDatabase::addSource(const QString &name)
+{
+  if (sources_.size() > std::numeric_limits<uint16_t>::max()) {
+    qWarning("Too many log sources; tagging %s as the last one.", qPrintable(name));
+    return sources_.size() - 1;
+  }
+  sources_.push_back(name);
+  return sources_.size() - 1;
+}
+
+QString LogDatabase::sourceName(uint16_t source) const
+{
+  if (source >= sources_.size()) {
+    return QString();
+  }
+  return sources_[source];
+}
+
 void LogDatabase::queueMessage(const rosgraph_msgs::LogConstPtr msg)
 {
-  if (msg->header.stamp < min_time_) {
-    min_time_ = msg->header.stamp;
+  LogBatchPtr batch(new std::vector<LogEntry>(1));
+  convertLogMessage(*msg, &batch->front());
+  queueBatch(batch);
+}
+
+void LogDatabase::queueBatch(const swri_console::LogBatchPtr &batch)
+{
+  if (batch->empty()) {
+    return;
+  }
+
+  // Messages usually arrive in runs from the same node, so the counts
+  // are updated once per run.
+  bool min_time_updated = false;
+  const std::string *node = &batch->front().node;
+  size_t run = 0;
+  for (size_t i = 0; i < batch->size(); i++) {
+    const LogEntry &entry = (*batch)[i];
+    if (entry.stamp < min_time_) {
+      min_time_ = entry.stamp;
+      min_time_updated = true;
+    }
+    if (entry.node != *node) {
+      countMessages(*node, run);
+      node = &entry.node;
+      run = 0;
+    }
+    run++;
+  }
+  countMessages(*node, run);
+
+  // The entries are moved into the log when the queue is processed.
+  new_batches_.push_back(batch);
+
+  if (min_time_updated) {
     Q_EMIT minTimeUpdated();
   }
-  
-  msg_counts_[msg->name]++;
-
-  LogEntry log;
-  log.stamp = msg->header.stamp;
-  log.level = msg->level;
-  log.node = msg->name;
-  log.file = msg->file;
-  log.function = msg->function;
-  log.line = msg->line;
-  log.text = QString(msg->msg.c_str()).split('\n');
-  log.seq = msg->header.seq;
-  new_msgs_.push_back(log);
+}
+
+void LogDatabase::countMessages(const std::string &node, size_t count)
+{
+  msg_counts_[node] += count;
+  pending_nodes_.insert(node);
 }
 
 void LogDatabase::processQueue()
 {
-  if (new_msgs_.empty()) {
+  if (new_batches_.empty()) {
     return;
   }
-  
-  log_.insert(log_.end(),
-              new_msgs_.begin(),
-              new_msgs_.end());
-  new_msgs_.clear();
+
+  for (size_t i = 0; i < new_batches_.size(); i++) {
+    std::vector<LogEntry> &batch = *new_batches_[i];
+    log_.insert(log_.end(),
+                std::make_move_iterator(batch.begin()),
+                std::make_move_iterator(batch.end()));
+    batch.clear();
+  }
+  new_batches_.clear();
+
+  changed_nodes_.swap(pending_nodes_);
+  pending_nodes_.clear();
 
   Q_EMIT messagesAdded();              
 }
@@ -29,29 +29,46 @@
 // *****************************************************************************
 
 #include <stdio.h>
+#include <algorithm>
 
 #include <ros/time.h>
-#include <rosbag/bag.h>
 
 #include <swri_console/log_database_proxy_model.h>
 #include <swri_console/log_database.h>
+#include <swri_console/log_formatter.h>
 
 #include <QColor>
-#include <QFile>
-#include <QTextStream>
 #include <QTimer>
 #include <QSettings>
 #include <swri_console/settings_keys.h>
 
 namespace swri_console
 {
+// Number of rows to format during each step of an incremental copy.
+static const size_t COPY_CHUNK_SIZE = 20000;
+
+// Characters per row that are reserved for the output of a copy, with
+// and without the extended fields.  Most rows fit, and the buffer
+// grows as usual for those that do not.
+static const size_t COPY_ROW_CHARS = 96;
+static const size_t COPY_EXTENDED_ROW_CHARS = 320;
+
+// Upper bound (characters) on the space reserved up front, so that a
+// huge selection does not reserve memory that it may never use.
+static const size_t COPY_MAX_RESERVE = 64 * 1024 * 1024;
+
+// Maximum number of message lines shown in a tooltip.
+static const int TOOLTIP_MAX_LINES = 40;
+
 LogDatabaseProxyModel::LogDatabaseProxyModel(LogDatabase *db)
   :
   db_(db),
   colorize_logs_(true),
   display_time_(true),
   display_absolute_time_(false),
-  use_regular_expressions_(false),
+  collapse_multiline_(false),
+  max_line_length_(DEFAULT_MAX_LINE_LENGTH),
+  rows_prepended_(0),
   debug_color_(Qt::gray),
   info_color_(Qt::black),
   warn_color_(QColor(255,127,0)),
@@ -65,6 +82,9 @@ LogDatabaseProxyModel::LogDatabaseProxyModel(LogDatabase *db)
 
   QObject::connect(db_, SIGNAL(minTimeUpdated()),
                    this, SLOT(minTimeUpdated()));
+
+  // No nodes are shown until some are selected.
+  filter_.setNodeFilter(std::set<std::string>());
 }
 
 LogDatabaseProxyModel::~LogDatabaseProxyModel()
@@ -73,13 +93,13 @@ LogDatabaseProxyModel::~LogDatabaseProxyModel()
 
 void LogDatabaseProxyModel::setNodeFilter(const std::set<std::string> &names)
 {
-  names_ = names;
+  filter_.setNodeFilter(names);
   reset();
 }
 
 void LogDatabaseProxyModel::setSeverityFilter(uint8_t severity_mask)
 {
-  severity_mask_ = severity_mask;
+  filter_.setSeverityFilter(severity_mask);
   reset();
 }
 
@@ -131,22 +151,106 @@ void LogDatabaseProxyModel::setDisplayTime(bool display)
   }
 }
 
+void LogDatabaseProxyModel::setMaxLineLength(int length)
+{
+  if (length == max_line_length_) {
+    return;
+  }
+
+  max_line_length_ = length;
+
+  QSettings settings;
+  settings.setValue(SettingsKeys::MAX_LINE_LENGTH, max_line_length_);
+
+  if (msg_mapping_.size()) {
+    Q_EMIT dataChanged(index(0), index(msg_mapping_.size()-1));
+  }
+}
+
 void LogDatabaseProxyModel::setUseRegularExpressions(bool useRegexps)
 {
-  if (useRegexps == use_regular_expressions_) {
+  if (useRegexps == filter_.useRegularExpressions()) {
     return;
   }
 
-  use_regular_expressions_ = useRegexps;
+  filter_.setUseRegularExpressions(useRegexps);
   QSettings settings;
   settings.setValue(SettingsKeys::USE_REGEXPS, useRegexps);
   reset();
 }
 
+void LogDatabaseProxyModel::setCollapseMultiline(bool collapse)
+{
+  if (collapse == collapse_multiline_) {
+    return;
+  }
+
+  collapse_multiline_ = collapse;
+  QSettings settings;
+  settings.setValue(SettingsKeys::COLLAPSE_MULTILINE, collapse_multiline_);
+  reset();
+}
+
+void LogDatabaseProxyModel::toggleExpanded(size_t row)
+{
+  if (!collapse_multiline_ || row >= msg_mapping_.size()) {
+    return;
+  }
+
+  const LineMap line_idx = msg_mapping_[row];
+  const LogEntry &item = db_->log()[line_idx.log_index];
+  const int extra_lines = item.text.size() - 1;
+  if (extra_lines <= 0) {
+    return;
+  }
+
+  // The copy job tracks rows by position, which is about to change.
+  cancelSelectionCopy();
+
+  // Only the rows of this message are inserted or removed, so the
+  // rest of the mapping is left alone.
+  const int first = row - line_idx.line_index;
+  if (expanded_logs_.count(line_idx.log_index)) {
+    beginRemoveRows(QModelIndex(), first + 1, first + extra_lines);
+    msg_mapping_.erase(msg_mapping_.begin() + first + 1,
+                       msg_mapping_.begin() + first + 1 + extra_lines);
+    expanded_logs_.erase(line_idx.log_index);
+    endRemoveRows();
+  } else {
+    std::vector<LineMap> lines;
+    for (int i = 1; i <= extra_lines; i++) {
+      lines.push_back(LineMap(line_idx.log_index, i));
+    }
+    beginInsertRows(QModelIndex(), first + 1, first + extra_lines);
+    msg_mapping_.insert(msg_mapping_.begin() + first + 1,
+                        lines.begin(),
+                        lines.end());
+    expanded_logs_.insert(line_idx.log_index);
+    endInsertRows();
+  }
+
+  Q_EMIT dataChanged(index(first), index(first));
+}
+
+bool LogDatabaseProxyModel::isCollapsed(size_t log_index, const LogEntry &item) const
+{
+  return (collapse_multiline_ &&
+          item.text.size() > 1 &&
+          expanded_logs_.count(log_index) == 0);
+}
+
+int LogDatabaseProxyModel::visibleLineCount(size_t log_index, const LogEntry &item) const
+{
+  if (isCollapsed(log_index, item)) {
+    return 1;
+  }
+  return item.text.size();
+}
+
 void LogDatabaseProxyModel::setIncludeFilters(
   const QStringList &list)
 {
-  include_strings_ = list;
+  filter_.setIncludeFilters(list);
   // The text and regexp filters are always updated at the same time, so this
   // value will be saved by setIncludeRegexpPattern.
   reset();
@@ -155,7 +259,7 @@ void LogDatabaseProxyModel::setIncludeFilters(
 void LogDatabaseProxyModel::setExcludeFilters(
   const QStringList &list)
 {
-  exclude_strings_ = list;
+  filter_.setExcludeFilters(list);
   // The text and regexp filters are always updated at the same time, so this
   // value will be saved by setExcludeRegexpPattern.
   reset();
@@ -164,7 +268,7 @@ void LogDatabaseProxyModel::setExcludeFilters(
 
 void LogDatabaseProxyModel::setIncludeRegexpPattern(const QString& pattern)
 {
-  include_regexp_.setPattern(pattern);
+  filter_.setIncludeRegexpPattern(pattern);
   QSettings settings;
   settings.setValue(SettingsKeys::INCLUDE_FILTER, pattern);
   reset();
@@ -172,7 +276,7 @@ void LogDatabaseProxyModel::setIncludeRegexpPattern(const QString& pattern)
 
 void LogDatabaseProxyModel::setExcludeRegexpPattern(const QString& pattern)
 {
-  exclude_regexp_.setPattern(pattern);
+  filter_.setExcludeRegexpPattern(pattern);
   QSettings settings;
   settings.setValue(SettingsKeys::EXCLUDE_FILTER, pattern);
   reset();
@@ -230,170 +334,319 @@ int LogDatabaseProxyModel::rowCount(const QModelIndex &parent) const
 
 bool LogDatabaseProxyModel::isIncludeValid() const
 {
-  if (use_regular_expressions_ && !include_regexp_.isValid()) {
-    return false;
-  }
-  return true;
+  return filter_.isIncludeValid();
 }
 
 bool LogDatabaseProxyModel::isExcludeValid() const
 {
-  if (use_regular_expressions_ && !exclude_regexp_.isValid()) {
-    return false;
-  }
-  return true;
+  return filter_.isExcludeValid();
 }
 
 
 QVariant LogDatabaseProxyModel::data(
   const QModelIndex &index, int role) const
 {
+  if (index.parent().isValid() ||
+      index.row() >= msg_mapping_.size()) {
+    return QVariant();
+  }
+
   switch (role)
   {
-    // Currently we're only returning data for these roles, so return immediately
-    // if we're being queried for anything else.
     case Qt::DisplayRole:
+      return QVariant(lineText(index.row()));
     case Qt::ToolTipRole:
-      break;
+      return QVariant(lineToolTip(index.row()));
+    case ExtendedLogRole:
+    {
+      QString text;
+      appendExtendedText(text, db_->log()[msg_mapping_[index.row()].log_index]);
+      return QVariant(text);
+    }
     case Qt::ForegroundRole:
-      if (colorize_logs_) {
-        break;
+    {
+      QColor color = lineColor(index.row());
+      if (color.isValid()) {
+        return QVariant(color);
       }
+      return QVariant();
+    }
     default:
       return QVariant();
   }
+}
 
-  if (index.parent().isValid() &&
-      index.row() >= msg_mapping_.size()) {
-    return QVariant();
+QString LogDatabaseProxyModel::lineText(size_t row) const
+{
+  if (row >= msg_mapping_.size()) {
+    return QString();
   }
 
-  const LineMap line_idx = msg_mapping_[index.row()];
+  const LineMap line_idx = msg_mapping_[row];
   const LogEntry &item = db_->log()[line_idx.log_index];
 
-  if (role == Qt::DisplayRole) {
-    char level = '?';
-    if (item.level == rosgraph_msgs::Log::DEBUG) {
-      level = 'D';
-    } else if (item.level == rosgraph_msgs::Log::INFO) {
-      level = 'I';
-    } else if (item.level == rosgraph_msgs::Log::WARN) {
-      level = 'W';
-    } else if (item.level == rosgraph_msgs::Log::ERROR) {
-      level = 'E';
-    } else if (item.level == rosgraph_msgs::Log::FATAL) {
-      level = 'F';
+  QString text;
+  appendDisplayText(text, line_idx, max_line_length_);
+  if (isCollapsed(line_idx.log_index, item)) {
+    text.append(QString(" [+%1 lines]").arg(item.text.size() - 1));
+  }
+  return text;
+}
+
+QColor LogDatabaseProxyModel::lineColor(size_t row) const
+{
+  if (!colorize_logs_ || row >= msg_mapping_.size()) {
+    return QColor();
+  }
+
+  const LogEntry &item = db_->log()[msg_mapping_[row].log_index];
+  switch (item.level) {
+    case rosgraph_msgs::Log::DEBUG:
+      return debug_color_;
+    case rosgraph_msgs::Log::INFO:
+      return info_color_;
+    case rosgraph_msgs::Log::WARN:
+      return warn_color_;
+    case rosgraph_msgs::Log::ERROR:
+      return error_color_;
+    case rosgraph_msgs::Log::FATAL:
+      return fatal_color_;
+    default:
+      return info_color_;
+  }
+}
+
+QString LogDatabaseProxyModel::lineToolTip(size_t row) const
+{
+  if (row >= msg_mapping_.size()) {
+    return QString();
+  }
+
+  const LogEntry &item = db_->log()[msg_mapping_[row].log_index];
+
+  char buffer[4096];
+  snprintf(buffer, sizeof(buffer),
+           "<p style='white-space:pre'>"
+           "Timestamp: %d.%09d\n"
+           "Seq: %d\n"
+           "Node: %s\n"
+           "Function: %s\n"
+           "File: %s\n"
+           "Line: %d\n"
+           "\n",
+           item.stamp.sec,
+           item.stamp.nsec,
+           item.seq,
+           item.node.c_str(),
+           item.function.c_str(),
+           item.file.c_str(),
+           item.line);
+
+  // Very long messages are elided so that the tooltip stays cheap to
+  // build and lay out.  The full text is available from Show Details.
+  QString text(buffer);
+  int lines = std::min(item.text.size(), TOOLTIP_MAX_LINES);
+  for (int i = 0; i < lines; i++) {
+    if (i != 0) {
+      text.append('\n');
     }
+    LogFormatter::appendElided(text, item.text[i], max_line_length_);
+  }
+  if (lines < item.text.size()) {
+    text.append(QString("\n... (%1 more lines)").arg(item.text.size() - lines));
+  }
+  text.append(QLatin1String("</p>"));
+  return text;
+}
 
-    char stamp[128];
-    if (display_absolute_time_) {
-      snprintf(stamp, sizeof(stamp),
-               "%u.%09u",
-               item.stamp.sec,
-               item.stamp.nsec);
-    } else {
-      ros::Duration t = item.stamp - db_->minTime();
-
-      int32_t secs = t.sec;
-      int hours = secs / 60 / 60;
-      int minutes = (secs / 60) % 60;
-      int seconds = (secs % 60);
-      int milliseconds = t.nsec / 1000000;
-      
-      snprintf(stamp, sizeof(stamp),
-               "%d:%02d:%02d:%03d",
-               hours, minutes, seconds, milliseconds);
+LogFormatter LogDatabaseProxyModel::formatter() const
+{
+  LogFormatter formatter;
+  formatter.display_time = display_time_;
+  formatter.absolute_time = display_absolute_time_;
+  formatter.min_time = db_->minTime();
+  return formatter;
+}
+
+void LogDatabaseProxyModel::appendDisplayText(
+  QString &buffer, const LineMap &line_idx, int max_length) const
+{
+  formatter().appendLine(buffer,
+                         db_->log()[line_idx.log_index],
+                         line_idx.line_index,
+                         max_length);
+}
+
+void LogDatabaseProxyModel::appendExtendedText(
+  QString &buffer, const LogEntry &item) const
+{
+  char header[4096];
+  snprintf(header, sizeof(header),
+           "Timestamp: %d.%09d\n"
+           "Node: %s\n"
+           "Function: %s\n"
+           "File: %s\n"
+           "Line: %d\n"
+           "Message: ",
+           item.stamp.sec,
+           item.stamp.nsec,
+           item.node.c_str(),
+           item.function.c_str(),
+           item.file.c_str(),
+           item.line);
+
+  if (item.source != LogEntry::LIVE_SOURCE) {
+    buffer.append(QString("Source: %1\n").arg(db_->sourceName(item.source)));
+  }
+  buffer.append(QString::fromUtf8(header));
+  for (int i = 0; i < item.text.size(); i++) {
+    if (i != 0) {
+      buffer.append('\n');
     }
+    buffer.append(item.text[i]);
+  }
+}
 
-    char header[1024];
-    if (display_time_) {
-      snprintf(header, sizeof(header),
-               "[%c %s] ", level, stamp);
-    } else {
-      snprintf(header, sizeof(header),
-               "[%c] ", level);
+QString LogDatabaseProxyModel::selectionText(
+  const std::vector<RowRange> &ranges, bool extended) const
+{
+  CopyJob job;
+  initCopyJob(job, ranges, extended);
+  appendCopyRows(job, job.rows_total);
+  return job.buffer;
+}
+
+void LogDatabaseProxyModel::startSelectionCopy(
+  const std::vector<RowRange> &ranges, bool extended)
+{
+  cancelSelectionCopy();
+
+  initCopyJob(copy_job_, ranges, extended);
+  copy_job_.active = true;
+  QTimer::singleShot(0, this, SLOT(processSelectionCopy()));
+}
+
+void LogDatabaseProxyModel::cancelSelectionCopy()
+{
+  if (!copy_job_.active) {
+    return;
+  }
+
+  copy_job_ = CopyJob();
+  Q_EMIT selectionCopyFinished(QString(), false);
+}
+
+void LogDatabaseProxyModel::processSelectionCopy()
+{
+  if (!copy_job_.active) {
+    return;
+  }
+
+  appendCopyRows(copy_job_, COPY_CHUNK_SIZE);
+
+  if (copy_job_.rows_done < copy_job_.rows_total) {
+    Q_EMIT selectionCopyProgress(
+      static_cast<int>(100.0 * copy_job_.rows_done / copy_job_.rows_total));
+    QTimer::singleShot(0, this, SLOT(processSelectionCopy()));
+    return;
+  }
+
+  QString text;
+  text.swap(copy_job_.buffer);
+  copy_job_ = CopyJob();
+  Q_EMIT selectionCopyFinished(text, true);
+}
+
+void LogDatabaseProxyModel::initCopyJob(
+  CopyJob &job, const std::vector<RowRange> &ranges, bool extended) const
+{
+  job = CopyJob();
+  job.ranges = ranges;
+  job.extended = extended;
+  job.row_offset = rows_prepended_;
+
+  for (size_t i = 0; i < ranges.size(); i++) {
+    if (ranges[i].last >= ranges[i].first) {
+      job.rows_total += ranges[i].last - ranges[i].first + 1;
     }
+  }
 
-    // For multiline messages, we only want to display the header for
-    // the first line.  For the subsequent lines, we generate a header
-    // and then fill it with blank lines so that the messages are
-    // aligned properly (assuming monospaced font).  
-    if (line_idx.line_index != 0) {
-      size_t len = strnlen(header, sizeof(header));
-      for (size_t i = 0; i < len; i++) {
-        header[i] = ' ';
+  // The size of the output is estimated from the number of rows, so
+  // that the selected rows are not walked on the GUI thread before
+  // the copy even starts.
+  const size_t row_chars = extended ? COPY_EXTENDED_ROW_CHARS : COPY_ROW_CHARS;
+  job.buffer.reserve(static_cast<int>(std::min(job.rows_total * row_chars, COPY_MAX_RESERVE)));
+
+  if (!job.ranges.empty()) {
+    job.next_row = job.ranges[0].first;
+  }
+}
+
+void LogDatabaseProxyModel::appendCopyRows(CopyJob &job, size_t max_rows) const
+{
+  // Rows may have been inserted at the front of the model by
+  // processOldMessages() since the job was started, so shift the
+  // selected rows to account for them.
+  const size_t shift = rows_prepended_ - job.row_offset;
+
+  size_t count = 0;
+  while (count < max_rows && job.range_index < job.ranges.size()) {
+    const RowRange &range = job.ranges[job.range_index];
+    if (job.next_row > range.last) {
+      job.range_index++;
+      if (job.range_index < job.ranges.size()) {
+        job.next_row = job.ranges[job.range_index].first;
       }
+      continue;
     }
-    
-    return QVariant(QString(header) + item.text[line_idx.line_index]);
-  }
-  else if (role == Qt::ForegroundRole && colorize_logs_) {
-    switch (item.level) {
-      case rosgraph_msgs::Log::DEBUG:
-        return QVariant(debug_color_);
-      case rosgraph_msgs::Log::INFO:
-        return QVariant(info_color_);
-      case rosgraph_msgs::Log::WARN:
-        return QVariant(warn_color_);
-      case rosgraph_msgs::Log::ERROR:
-        return QVariant(error_color_);
-      case rosgraph_msgs::Log::FATAL:
-        return QVariant(fatal_color_);
-      default:
-        return QVariant(info_color_);
+
+    size_t row = job.next_row + shift;
+    job.next_row++;
+    job.rows_done++;
+    count++;
+
+    if (row >= msg_mapping_.size()) {
+      continue;
     }
+
+    const LineMap &line_idx = msg_mapping_[row];
+    if (job.extended) {
+      // Multi-line messages span several rows, but the extended
+      // format includes every line, so only output them once.
+      if (job.has_output && line_idx.log_index == job.prev_log) {
+        continue;
+      }
+      if (job.has_output) {
+        job.buffer.append(QLatin1String("\n\n"));
+      }
+      appendExtendedText(job.buffer, db_->log()[line_idx.log_index]);
+    } else {
+      if (job.has_output) {
+        job.buffer.append('\n');
+      }
+      appendDisplayText(job.buffer, line_idx);
+
+      // Collapsed messages are copied in full rather than as they
+      // are displayed.
+      const LogEntry &item = db_->log()[line_idx.log_index];
+      if (isCollapsed(line_idx.log_index, item)) {
+        for (int i = 1; i < item.text.size(); i++) {
+          job.buffer.append('\n');
+          appendDisplayText(job.buffer, LineMap(line_idx.log_index, i));
+        }
+      }
+    }
+    job.prev_log = line_idx.log_index;
+    job.has_output = true;
   }
-  else if (role == Qt::ToolTipRole) {
-    char buffer[4096];
-    snprintf(buffer, sizeof(buffer),
-             "<p style='white-space:pre'>"
-             "Timestamp: %d.%09d\n"
-             "Seq: %d\n"
-             "Node: %s\n"
-             "Function: %s\n"
-             "File: %s\n"
-             "Line: %d\n"
-             "\n",
-             item.stamp.sec,
-             item.stamp.nsec,
-             item.seq,
-             item.node.c_str(),
-             item.function.c_str(),
-             item.file.c_str(),
-             item.line);
-    
-    QString text = (QString(buffer) +
-                    item.text.join("\n") + 
-                    QString("</p>"));
-                            
-    return QVariant(text);
-  } else if (role == LogDatabaseProxyModel::ExtendedLogRole) {
-    char buffer[4096];
-    snprintf(buffer, sizeof(buffer),
-             "Timestamp: %d.%09d\n"
-             "Node: %s\n"
-             "Function: %s\n"
-             "File: %s\n"
-             "Line: %d\n"
-             "Message: ",
-             item.stamp.sec,
-             item.stamp.nsec,
-             item.node.c_str(),
-             item.function.c_str(),
-             item.file.c_str(),
-             item.line);
-    
-    QString text = (QString(buffer) +
-                    item.text.join("\n")); 
-                            
-    return QVariant(text);
-  }
-      
-  return QVariant();
 }
 
 void LogDatabaseProxyModel::reset()
 {
+  // Row numbers are meaningless after a reset, so any pending copy
+  // has to be abandoned.
+  cancelSelectionCopy();
+
   beginResetModel();
   msg_mapping_.clear();
   early_mapping_.clear();
@@ -404,71 +657,28 @@ void LogDatabaseProxyModel::reset()
 }
 
 
-void LogDatabaseProxyModel::saveToFile(const QString& filename) const
-{
-  if (filename.endsWith(".bag", Qt::CaseInsensitive)) {
-    saveBagFile(filename);
-  }
-  else {
-    saveTextFile(filename);
-  }
-}
-
-void LogDatabaseProxyModel::saveBagFile(const QString& filename) const
+LogBatchPtr LogDatabaseProxyModel::snapshotEntries() const
 {
-  rosbag::Bag bag(filename.toStdString().c_str(), rosbag::bagmode::Write);
+  LogBatchPtr entries(new std::vector<LogEntry>());
 
   size_t idx = 0;
   while (idx < msg_mapping_.size()) {
-    const LineMap line_map = msg_mapping_[idx];    
-    const LogEntry &item = db_->log()[line_map.log_index];
-    
-    rosgraph_msgs::Log log;
-    log.file = item.file;
-    log.function = item.function;
-    log.header.seq = item.seq;
-    if (item.stamp < ros::TIME_MIN) {
-      // Note: I think TIME_MIN is the minimum representation of
-      // ros::Time, so this branch should be impossible.  Nonetheless,
-      // it doesn't hurt.
-      log.header.stamp = ros::Time::now();
-      qWarning("Msg with seq %d had time (%d); it's less than ros::TIME_MIN, which is invalid. "
-               "Writing 'now' instead.",
-               log.header.seq, item.stamp.sec);
-    } else {
-      log.header.stamp = item.stamp;
-    }
-    log.level = item.level;
-    log.line = item.line;
-    log.msg = item.text.join("\n").toStdString();
-    log.name = item.node;
-    bag.write("/rosout", log.header.stamp, log);
+    const size_t log_index = msg_mapping_[idx].log_index;
+    entries->push_back(db_->log()[log_index]);
 
     // Advance to the next line with a different log index.
     idx++;
-    while (idx < msg_mapping_.size() && msg_mapping_[idx].log_index == line_map.log_index) {
+    while (idx < msg_mapping_.size() && msg_mapping_[idx].log_index == log_index) {
       idx++;
     }
   }
-  bag.close();
-}
 
-void LogDatabaseProxyModel::saveTextFile(const QString& filename) const
-{
-  QFile outFile(filename);
-  outFile.open(QFile::WriteOnly);
-  QTextStream outstream(&outFile);
-  for(int i = 0; i < msg_mapping_.size(); i++)
-  {
-    QString line = data(index(i), Qt::DisplayRole).toString();
-    outstream << line << '\n';
-  }
-  outstream.flush();
-  outFile.close();
+  return entries;
 }
 
 void LogDatabaseProxyModel::handleDatabaseCleared()
 {
+  expanded_logs_.clear();
   reset();
 }
 
@@ -483,11 +693,12 @@ void LogDatabaseProxyModel::processNewMessages()
        latest_log_index_++)
   {
     const LogEntry &item = db_->log()[latest_log_index_];    
-    if (!acceptLogEntry(item)) {
+    if (!filter_.accept(item)) {
       continue;
     }    
 
-    for (int i = 0; i < item.text.size(); i++) {
+    int lines = visibleLineCount(latest_log_index_, item);
+    for (int i = 0; i < lines; i++) {
       new_items.push_back(LineMap(latest_log_index_, i));
     }
   }
@@ -520,14 +731,15 @@ void LogDatabaseProxyModel::processOldMessages()
        earliest_log_index_--, i++)
   {
     const LogEntry &item = db_->log()[earliest_log_index_-1];
-    if (!acceptLogEntry(item)) {
+    if (!filter_.accept(item)) {
       continue;
     }
 
-    for (int i = 0; i < item.text.size(); i++) {
+    int lines = visibleLineCount(earliest_log_index_-1, item);
+    for (int i = 0; i < lines; i++) {
       // Note that we have to add the lines backwards to maintain the proper order.
       early_mapping_.push_front(
-        LineMap(earliest_log_index_-1, item.text.size()-1-i));
+        LineMap(earliest_log_index_-1, lines-1-i));
     }
   }
  
@@ -539,6 +751,7 @@ void LogDatabaseProxyModel::processOldMessages()
     msg_mapping_.insert(msg_mapping_.begin(),
                         early_mapping_.begin(),
                         early_mapping_.end());
+    rows_prepended_ += early_mapping_.size();
     early_mapping_.clear();
     endInsertRows();
 
@@ -557,60 +770,6 @@ void LogDatabaseProxyModel::scheduleIdleProcessing()
   }
 }
 
-bool LogDatabaseProxyModel::acceptLogEntry(const LogEntry &item)
-{
-  if (!(item.level & severity_mask_)) {
-    return false;
-  }
-  
-  if (names_.count(item.node) == 0) {
-    return false;
-  }
-
-  if (!testIncludeFilter(item)) {
-    return false;
-  }
-
-  if (use_regular_expressions_) {
-    // For multi-line messages, we join the lines together with a
-    // space to make it easy for users to use filters that spread
-    // across the new lines.
-    
-    // Don't let an empty regexp filter out everything
-    return exclude_regexp_.isEmpty() || exclude_regexp_.indexIn(item.text.join(" ")) < 0;
-  } else {
-    for (int i = 0; i < exclude_strings_.size(); i++) {
-      if (item.text.join(" ").contains(exclude_strings_[i], Qt::CaseInsensitive)) {
-        return false;
-      }
-    }
-  }
-  
-  return true;
-}
-
-// Return true if the item message contains at least one of the
-// strings in include_filter_.  Always returns true if there are no
-// include strings.
-bool LogDatabaseProxyModel::testIncludeFilter(const LogEntry &item)
-{
-  if (use_regular_expressions_) {
-    return include_regexp_.indexIn(item.text.join(" ")) >= 0;
-  } else {
-    if (include_strings_.empty()) {
-      return true;
-    }
-
-    for (int i = 0; i < include_strings_.size(); i++) {
-      if (item.text.join(" ").contains(include_strings_[i], Qt::CaseInsensitive)) {
-        return true;
-      }
-    }
-  }
-
-  return false;
-}
-
 void LogDatabaseProxyModel::minTimeUpdated()
 {
   if (display_time_ &&
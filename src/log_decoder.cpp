@@ -0,0 +1,185 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#include <swri_console/log_decoder.h>
+#include <swri_console/log_database.h>
+
+namespace swri_console
+{
+namespace
+{
+// Reads the little-endian primitives used by the ROS serialization
+// format from a buffer, failing instead of reading past the end.
+class WireReader
+{
+ public:
+  WireReader(const uint8_t *data, size_t size)
+    : data_(data), size_(size), pos_(0) {}
+
+  bool readUInt8(uint8_t *value)
+  {
+    if (size_ - pos_ < 1) {
+      return false;
+    }
+    *value = data_[pos_];
+    pos_ += 1;
+    return true;
+  }
+
+  bool readUInt32(uint32_t *value)
+  {
+    if (size_ - pos_ < 4) {
+      return false;
+    }
+    *value = (static_cast<uint32_t>(data_[pos_]) |
+              static_cast<uint32_t>(data_[pos_+1]) << 8 |
+              static_cast<uint32_t>(data_[pos_+2]) << 16 |
+              static_cast<uint32_t>(data_[pos_+3]) << 24);
+    pos_ += 4;
+    return true;
+  }
+
+  // Returns a pointer to the string's bytes inside the buffer.  The
+  // string is not null terminated.
+  bool readString(const char **str, uint32_t *length)
+  {
+    if (!readUInt32(length) || size_ - pos_ < *length) {
+      return false;
+    }
+    *str = reinterpret_cast<const char*>(data_ + pos_);
+    pos_ += *length;
+    return true;
+  }
+
+  bool skipString()
+  {
+    const char *str;
+    uint32_t length;
+    return readString(&str, &length);
+  }
+
+ private:
+  const uint8_t *data_;
+  size_t size_;
+  size_t pos_;
+};
+}  // namespace
+
+bool decodeLogMessage(const uint8_t *data, size_t size, LogEntry *entry)
+{
+  return decodeLogMessage(data, size, LogDecodeFilter(), entry) == DECODE_ACCEPTED;
+}
+
+DecodeStatus decodeLogMessage(const uint8_t *data, size_t size,
+                              const LogDecodeFilter &filter,
+                              LogEntry *entry)
+{
+  WireReader reader(data, size);
+
+  uint32_t sec;
+  uint32_t nsec;
+  uint8_t level;
+  const char *name;
+  uint32_t name_len;
+  const char *msg;
+  uint32_t msg_len;
+  const char *file;
+  uint32_t file_len;
+  const char *function;
+  uint32_t function_len;
+  uint32_t line;
+  uint32_t topic_count;
+
+  // The field order follows rosgraph_msgs/Log: header (seq, stamp,
+  // frame_id), level, name, msg, file, function, line, topics.
+  if (!reader.readUInt32(&entry->seq) ||
+      !reader.readUInt32(&sec) ||
+      !reader.readUInt32(&nsec) ||
+      !isValidNsec(nsec) ||
+      !reader.skipString() ||
+      !reader.readUInt8(&level) ||
+      !reader.readString(&name, &name_len)) {
+    return DECODE_INVALID;
+  }
+
+  if (level < filter.min_level) {
+    return DECODE_REJECTED;
+  }
+
+  entry->node.assign(name, name_len);
+  if (!filter.nodes.empty() && filter.nodes.count(entry->node) == 0) {
+    return DECODE_REJECTED;
+  }
+
+  if (!reader.readString(&msg, &msg_len) ||
+      !reader.readString(&file, &file_len) ||
+      !reader.readString(&function, &function_len) ||
+      !reader.readUInt32(&line) ||
+      !reader.readUInt32(&topic_count)) {
+    return DECODE_INVALID;
+  }
+
+  for (uint32_t i = 0; i < topic_count; i++) {
+    if (!reader.skipString()) {
+      return DECODE_INVALID;
+    }
+  }
+
+  entry->stamp = ros::Time(sec, nsec);
+  entry->level = level;
+  entry->file.assign(file, file_len);
+  entry->function.assign(function, function_len);
+  entry->line = line;
+  entry->text = QString::fromUtf8(msg, msg_len).split('\n');
+  return DECODE_ACCEPTED;
+}
+
+bool decodeLogHeader(const uint8_t *data, size_t size,
+                     uint32_t *seq, uint32_t *sec, uint32_t *nsec,
+                     uint8_t *level, std::string *node)
+{
+  WireReader reader(data, size);
+
+  const char *name;
+  uint32_t name_len;
+  if (!reader.readUInt32(seq) ||
+      !reader.readUInt32(sec) ||
+      !reader.readUInt32(nsec) ||
+      !isValidNsec(*nsec) ||
+      !reader.skipString() ||
+      !reader.readUInt8(level) ||
+      !reader.readString(&name, &name_len)) {
+    return false;
+  }
+
+  node->assign(name, name_len);
+  return true;
+}
+}  // namespace swri_console
@@ -0,0 +1,259 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/log_exporter.h>
+#include <swri_console/session_file.h>
+
+#include <algorithm>
+#include <deque>
+
+#include <QFile>
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentRun>
+
+#include <ros/time.h>
+#include <rosbag/bag.h>
+#include <rosgraph_msgs/Log.h>
+
+namespace swri_console
+{
+// Interval (ms) at which progress is reported.
+static const int PROGRESS_INTERVAL = 100;
+
+// Number of messages the worker writes between updating its progress
+// and checking for cancellation.
+static const size_t CHECK_INTERVAL = 1000;
+
+// Number of messages formatted by each task of a text export.
+static const size_t FORMAT_CHUNK_SIZE = 20000;
+
+LogExporter::LogExporter(const QString &filename,
+                         const LogBatchPtr &entries,
+                         Format format,
+                         const LogFormatter &formatter,
+                         QObject *parent)
+  :
+  QObject(parent),
+  filename_(filename),
+  entries_(entries),
+  format_(format),
+  formatter_(formatter),
+  state_(new State()),
+  timer_id_(0)
+{
+  QObject::connect(&watcher_, SIGNAL(finished()),
+                   this, SLOT(handleFinished()));
+}
+
+LogExporter::~LogExporter()
+{
+  cancel();
+  watcher_.waitForFinished();
+}
+
+void LogExporter::start()
+{
+  if (timer_id_) {
+    return;
+  }
+
+  watcher_.setFuture(QtConcurrent::run(&LogExporter::write,
+                                       filename_, entries_, format_, formatter_, state_));
+  timer_id_ = startTimer(PROGRESS_INTERVAL);
+}
+
+void LogExporter::cancel()
+{
+  state_->cancelled.fetchAndStoreOrdered(1);
+}
+
+void LogExporter::timerEvent(QTimerEvent *)
+{
+  if (entries_->empty()) {
+    return;
+  }
+  size_t written = state_->written.fetchAndAddOrdered(0);
+  Q_EMIT progress(static_cast<int>(100 * written / entries_->size()));
+}
+
+void LogExporter::handleFinished()
+{
+  killTimer(timer_id_);
+
+  QString error_msg = watcher_.result();
+  if (!error_msg.isEmpty()) {
+    QFile::remove(filename_);
+  }
+  Q_EMIT finished(error_msg.isEmpty(), error_msg);
+}
+
+QString LogExporter::write(QString filename, LogBatchPtr entries, Format format,
+                           LogFormatter formatter, StatePtr state)
+{
+  if (format == TEXT || format == NDJSON) {
+    return writeText(filename, entries, format, formatter, state);
+  } else if (format == SESSION) {
+    // Session files are written in a single pass with large blocks,
+    // so this only reports progress when it is done.
+    QString error_msg = writeSessionFile(filename, *entries);
+    state->written.fetchAndStoreOrdered(entries->size());
+    return error_msg;
+  }
+  return writeBag(filename, entries, format, state);
+}
+
+QString LogExporter::writeBag(const QString &filename, const LogBatchPtr &entries,
+                              Format format, const StatePtr &state)
+{
+  try {
+    rosbag::Bag bag(filename.toStdString(), rosbag::bagmode::Write);
+    if (format == BAG_BZ2) {
+      bag.setCompression(rosbag::compression::BZ2);
+    } else if (format == BAG_LZ4) {
+      bag.setCompression(rosbag::compression::LZ4);
+    }
+
+    rosgraph_msgs::Log log;
+    for (size_t i = 0; i < entries->size(); i++) {
+      if (i % CHECK_INTERVAL == 0) {
+        state->written.fetchAndStoreOrdered(i);
+        if (state->cancelled.fetchAndAddOrdered(0) != 0) {
+          return "Export cancelled";
+        }
+      }
+
+      const LogEntry &item = (*entries)[i];
+      log.file = item.file;
+      log.function = item.function;
+      log.header.seq = item.seq;
+      if (item.stamp < ros::TIME_MIN) {
+        // Note: I think TIME_MIN is the minimum representation of
+        // ros::Time, so this branch should be impossible.  Nonetheless,
+        // it doesn't hurt.
+        log.header.stamp = ros::Time::now();
+        qWarning("Msg with seq %d had time (%d); it's less than ros::TIME_MIN, which is invalid. "
+                 "Writing 'now' instead.",
+                 log.header.seq, item.stamp.sec);
+      } else {
+        log.header.stamp = item.stamp;
+      }
+      log.level = item.level;
+      log.line = item.line;
+      log.msg = item.text.join("\n").toStdString();
+      log.name = item.node;
+      bag.write("/rosout", log.header.stamp, log);
+    }
+
+    bag.close();
+    state->written.fetchAndStoreOrdered(entries->size());
+  } catch (const rosbag::BagException &e) {
+    return QString("Bag file error: %1").arg(e.what());
+  }
+
+  return QString();
+}
+
+QString LogExporter::writeText(const QString &filename, const LogBatchPtr &entries,
+                               Format format, const LogFormatter &formatter,
+                               const StatePtr &state)
+{
+  QFile file(filename);
+  if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+    return QString("Could not open file: %1").arg(file.errorString());
+  }
+
+  // Chunks are formatted concurrently, but only a few are kept in
+  // flight so that memory use does not grow with the size of the
+  // export.  They are written strictly in the order they were started.
+  const size_t max_in_flight = 2 * std::max(QThread::idealThreadCount(), 1);
+  std::deque<QFuture<QByteArray> > in_flight;
+  std::deque<size_t> chunk_ends;
+  size_t next_chunk = 0;
+
+  QString error_msg;
+  while (next_chunk < entries->size() || !in_flight.empty()) {
+    while (next_chunk < entries->size() && in_flight.size() < max_in_flight) {
+      size_t end = std::min(next_chunk + FORMAT_CHUNK_SIZE, entries->size());
+      in_flight.push_back(QtConcurrent::run(&LogExporter::formatChunk,
+                                            entries, next_chunk, end, format, formatter));
+      chunk_ends.push_back(end);
+      next_chunk = end;
+    }
+
+    QByteArray data = in_flight.front().result();
+    in_flight.pop_front();
+    size_t written = chunk_ends.front();
+    chunk_ends.pop_front();
+
+    if (!error_msg.isEmpty()) {
+      // Wait for the remaining tasks, since they share entries.
+      continue;
+    }
+
+    if (file.write(data) != data.size()) {
+      error_msg = QString("Write failed: %1").arg(file.errorString());
+      next_chunk = entries->size();
+      continue;
+    }
+
+    state->written.fetchAndStoreOrdered(written);
+    if (state->cancelled.fetchAndAddOrdered(0) != 0) {
+      error_msg = "Export cancelled";
+      next_chunk = entries->size();
+    }
+  }
+
+  file.close();
+  return error_msg;
+}
+
+QByteArray LogExporter::formatChunk(LogBatchPtr entries, size_t begin, size_t end,
+                                    Format format, LogFormatter formatter)
+{
+  if (format == NDJSON) {
+    std::string buffer;
+    for (size_t i = begin; i < end; i++) {
+      LogFormatter::appendJson(buffer, (*entries)[i]);
+      buffer.push_back('\n');
+    }
+    return QByteArray(buffer.data(), buffer.size());
+  }
+
+  QString buffer;
+  for (size_t i = begin; i < end; i++) {
+    const LogEntry &item = (*entries)[i];
+    for (int line = 0; line < item.text.size(); line++) {
+      formatter.appendLine(buffer, item, line);
+      buffer.append('\n');
+    }
+  }
+  return buffer.toUtf8();
+}
+}  // namespace swri_console
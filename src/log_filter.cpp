@@ -0,0 +1,168 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/log_filter.h>
+
+namespace swri_console
+{
+LogFilter::LogFilter()
+  :
+  filter_nodes_(false),
+  severity_mask_(0xFF),
+  use_regular_expressions_(false)
+{
+}
+
+void LogFilter::setNodeFilter(const std::set<std::string> &names)
+{
+  filter_nodes_ = true;
+  names_ = names;
+}
+
+void LogFilter::setSeverityFilter(uint8_t severity_mask)
+{
+  severity_mask_ = severity_mask;
+}
+
+void LogFilter::setIncludeFilters(const QStringList &list)
+{
+  include_strings_ = list;
+}
+
+void LogFilter::setExcludeFilters(const QStringList &list)
+{
+  exclude_strings_ = list;
+}
+
+void LogFilter::setIncludeRegexpPattern(const QString &pattern)
+{
+  include_regexp_.setPattern(pattern);
+}
+
+void LogFilter::setExcludeRegexpPattern(const QString &pattern)
+{
+  exclude_regexp_.setPattern(pattern);
+}
+
+void LogFilter::setUseRegularExpressions(bool use_regexps)
+{
+  use_regular_expressions_ = use_regexps;
+}
+
+bool LogFilter::isIncludeValid() const
+{
+  if (use_regular_expressions_ && !include_regexp_.isValid()) {
+    return false;
+  }
+  return true;
+}
+
+bool LogFilter::isExcludeValid() const
+{
+  if (use_regular_expressions_ && !exclude_regexp_.isValid()) {
+    return false;
+  }
+  return true;
+}
+
+bool LogFilter::accept(const LogEntry &item) const
+{
+  if (!(item.level & severity_mask_)) {
+    return false;
+  }
+  
+  if (filter_nodes_ && names_.count(item.node) == 0) {
+    return false;
+  }
+
+  if (!testIncludeFilter(item)) {
+    return false;
+  }
+
+  if (use_regular_expressions_) {
+    // For multi-line messages, we join the lines together with a
+    // space to make it easy for users to use filters that spread
+    // across the new lines.
+    
+    // Don't let an empty regexp filter out everything
+    return exclude_regexp_.isEmpty() || exclude_regexp_.indexIn(item.text.join(" ")) < 0;
+  } else {
+    for (int i = 0; i < exclude_strings_.size(); i++) {
+      if (item.text.join(" ").contains(exclude_strings_[i], Qt::CaseInsensitive)) {
+        return false;
+      }
+    }
+  }
+  
+  return true;
+}
+
+// Return true if the item message contains at least one of the
+// strings in include_filter_.  Always returns true if there are no
+// include strings.
+bool LogFilter::testIncludeFilter(const LogEntry &item) const
+{
+  if (use_regular_expressions_) {
+    return include_regexp_.indexIn(item.text.join(" ")) >= 0;
+  } else {
+    if (include_strings_.empty()) {
+      return true;
+    }
+
+    for (int i = 0; i < include_strings_.size(); i++) {
+      if (item.text.join(" ").contains(include_strings_[i], Qt::CaseInsensitive)) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+LogDecodeFilter LogFilter::decodeFilter() const
+{
+  LogDecodeFilter filter;
+
+  // Levels are bit values, so the lowest bit of the mask is the
+  // lowest level that can pass.
+  for (int bit = 0; bit < 8; bit++) {
+    if (severity_mask_ & (1 << bit)) {
+      filter.min_level = 1 << bit;
+      break;
+    }
+  }
+
+  // An empty node set means all nodes to the decoder, so it is only
+  // passed on when it selects something.
+  if (filter_nodes_ && !names_.empty()) {
+    filter.nodes = names_;
+  }
+  return filter;
+}
+}  // namespace swri_console
@@ -0,0 +1,181 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/log_formatter.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rosgraph_msgs/Log.h>
+
+namespace swri_console
+{
+void LogFormatter::appendLine(
+  QString &buffer, const LogEntry &item, int line, int max_length) const
+{
+  char level = '?';
+  if (item.level == rosgraph_msgs::Log::DEBUG) {
+    level = 'D';
+  } else if (item.level == rosgraph_msgs::Log::INFO) {
+    level = 'I';
+  } else if (item.level == rosgraph_msgs::Log::WARN) {
+    level = 'W';
+  } else if (item.level == rosgraph_msgs::Log::ERROR) {
+    level = 'E';
+  } else if (item.level == rosgraph_msgs::Log::FATAL) {
+    level = 'F';
+  }
+
+  char stamp[128];
+  if (absolute_time) {
+    snprintf(stamp, sizeof(stamp),
+             "%u.%09u",
+             item.stamp.sec,
+             item.stamp.nsec);
+  } else {
+    ros::Duration t = item.stamp - min_time;
+
+    int32_t secs = t.sec;
+    int hours = secs / 60 / 60;
+    int minutes = (secs / 60) % 60;
+    int seconds = (secs % 60);
+    int milliseconds = t.nsec / 1000000;
+      
+    snprintf(stamp, sizeof(stamp),
+             "%d:%02d:%02d:%03d",
+             hours, minutes, seconds, milliseconds);
+  }
+
+  char header[1024];
+  if (display_time) {
+    snprintf(header, sizeof(header),
+             "[%c %s] ", level, stamp);
+  } else {
+    snprintf(header, sizeof(header),
+             "[%c] ", level);
+  }
+
+  // For multiline messages, we only want to display the header for
+  // the first line.  For the subsequent lines, we generate a header
+  // and then fill it with blank lines so that the messages are
+  // aligned properly (assuming monospaced font).  
+  if (line != 0) {
+    size_t len = strnlen(header, sizeof(header));
+    for (size_t i = 0; i < len; i++) {
+      header[i] = ' ';
+    }
+  }
+
+  buffer.append(QLatin1String(header));
+  appendElided(buffer, item.text[line], max_length);
+}
+
+void LogFormatter::appendElided(
+  QString &buffer, const QString &text, int max_length)
+{
+  if (max_length < 0 || text.size() <= max_length) {
+    buffer.append(text);
+    return;
+  }
+
+  buffer.append(text.midRef(0, max_length));
+  buffer.append(QChar(0x2026));
+}
+
+// Appends str to buffer as a quoted JSON string.  str must be UTF-8.
+static void appendJsonString(std::string &buffer, const char *str, size_t length)
+{
+  static const char hex[] = "0123456789abcdef";
+
+  buffer.push_back('"');
+  for (size_t i = 0; i < length; i++) {
+    const unsigned char c = str[i];
+    switch (c) {
+      case '"': buffer.append("\\\""); break;
+      case '\\': buffer.append("\\\\"); break;
+      case '\n': buffer.append("\\n"); break;
+      case '\r': buffer.append("\\r"); break;
+      case '\t': buffer.append("\\t"); break;
+      default:
+        if (c < 0x20) {
+          buffer.append("\\u00");
+          buffer.push_back(hex[c >> 4]);
+          buffer.push_back(hex[c & 0xF]);
+        } else {
+          buffer.push_back(c);
+        }
+    }
+  }
+  buffer.push_back('"');
+}
+
+static void appendJsonString(std::string &buffer, const std::string &str)
+{
+  appendJsonString(buffer, str.data(), str.size());
+}
+
+void LogFormatter::appendJson(std::string &buffer, const LogEntry &item,
+                              const std::string &source)
+{
+  const char *level = "UNKNOWN";
+  if (item.level == rosgraph_msgs::Log::DEBUG) {
+    level = "DEBUG";
+  } else if (item.level == rosgraph_msgs::Log::INFO) {
+    level = "INFO";
+  } else if (item.level == rosgraph_msgs::Log::WARN) {
+    level = "WARN";
+  } else if (item.level == rosgraph_msgs::Log::ERROR) {
+    level = "ERROR";
+  } else if (item.level == rosgraph_msgs::Log::FATAL) {
+    level = "FATAL";
+  }
+
+  // The stamp is split into integers because a JSON number is read as
+  // a double by most parsers, which can not hold it to the nanosecond.
+  char numbers[128];
+  snprintf(numbers, sizeof(numbers),
+           "{\"sec\":%u,\"nsec\":%u,\"seq\":%u,\"level\":\"%s\",\"node\":",
+           item.stamp.sec, item.stamp.nsec, item.seq, level);
+  buffer.append(numbers);
+  appendJsonString(buffer, item.node);
+  buffer.append(",\"file\":");
+  appendJsonString(buffer, item.file);
+  buffer.append(",\"function\":");
+  appendJsonString(buffer, item.function);
+  snprintf(numbers, sizeof(numbers), ",\"line\":%u,\"msg\":", item.line);
+  buffer.append(numbers);
+  QByteArray msg = item.text.join("\n").toUtf8();
+  appendJsonString(buffer, msg.constData(), msg.size());
+  if (!source.empty()) {
+    buffer.append(",\"source\":");
+    appendJsonString(buffer, source);
+  }
+  buffer.push_back('}');
+}
+}  // namespace swri_console
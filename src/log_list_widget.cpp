@@ -0,0 +1,592 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#include <algorithm>
+#include <cmath>
+
+#include <swri_console/log_list_widget.h>
+
+#include <QApplication>
+#include <QHelpEvent>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QToolTip>
+#include <QWheelEvent>
+
+namespace swri_console
+{
+// QScrollBar only supports int ranges.  When there are more rows than
+// this, the scroll bar position is scaled to the row count.
+static const int MAX_SCROLL_VALUE = 1 << 30;
+
+// Padding between the left edge of the viewport and the text.
+static const int TEXT_MARGIN = 3;
+
+LogListWidget::LogListWidget(QWidget *parent)
+  :
+  QAbstractScrollArea(parent),
+  model_(NULL),
+  top_row_(0),
+  updating_scroll_bar_(false),
+  max_line_width_(0),
+  alternating_row_colors_(false),
+  anchor_row_(0),
+  current_row_(0)
+{
+  setFocusPolicy(Qt::StrongFocus);
+  setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+  setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+  viewport()->setBackgroundRole(QPalette::Base);
+
+  QObject::connect(verticalScrollBar(), SIGNAL(valueChanged(int)),
+                   this, SLOT(handleVerticalScroll(int)));
+}
+
+LogListWidget::~LogListWidget()
+{
+}
+
+void LogListWidget::setModel(LogDatabaseProxyModel *model)
+{
+  if (model_) {
+    QObject::disconnect(model_, 0, this, 0);
+  }
+
+  model_ = model;
+
+  if (model_) {
+    QObject::connect(model_, SIGNAL(rowsInserted(const QModelIndex &, int, int)),
+                     this, SLOT(handleRowsInserted(const QModelIndex &, int, int)));
+    QObject::connect(model_, SIGNAL(rowsRemoved(const QModelIndex &, int, int)),
+                     this, SLOT(handleRowsRemoved(const QModelIndex &, int, int)));
+    QObject::connect(model_, SIGNAL(modelReset()),
+                     this, SLOT(handleModelReset()));
+    QObject::connect(model_, SIGNAL(dataChanged(const QModelIndex &, const QModelIndex &)),
+                     this, SLOT(handleDataChanged()));
+  }
+
+  handleModelReset();
+}
+
+void LogListWidget::setAlternatingRowColors(bool enable)
+{
+  alternating_row_colors_ = enable;
+  viewport()->update();
+}
+
+bool LogListWidget::isRowSelected(size_t row) const
+{
+  // Find the last range that starts at or before row.
+  size_t lo = 0;
+  size_t hi = selection_.size();
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (selection_[mid].first <= row) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return lo > 0 && selection_[lo-1].last >= row;
+}
+
+bool LogListWidget::rowAt(const QPoint &pos, size_t *row) const
+{
+  if (!model_ || pos.y() < 0) {
+    return false;
+  }
+
+  size_t candidate = top_row_ + pos.y() / rowHeight();
+  if (candidate >= model_->lineCount()) {
+    return false;
+  }
+
+  *row = candidate;
+  return true;
+}
+
+void LogListWidget::selectAll()
+{
+  selection_.clear();
+  if (model_ && model_->lineCount()) {
+    selection_.push_back(RowRange(0, model_->lineCount() - 1));
+  }
+  viewport()->update();
+}
+
+void LogListWidget::clearSelection()
+{
+  selection_.clear();
+  viewport()->update();
+}
+
+void LogListWidget::scrollToBottom()
+{
+  setTopRow(maxTopRow());
+}
+
+void LogListWidget::scrollToRow(size_t row)
+{
+  size_t visible = visibleRowCount();
+  if (row < top_row_) {
+    setTopRow(row);
+  } else if (row >= top_row_ + visible) {
+    setTopRow(row - visible + 1);
+  }
+}
+
+void LogListWidget::paintEvent(QPaintEvent *)
+{
+  QPainter painter(viewport());
+  painter.setFont(font());
+
+  const QPalette &pal = palette();
+  const int height = rowHeight();
+  const int width = viewport()->width();
+  const int x_offset = horizontalScrollBar()->value();
+  const size_t count = model_ ? model_->lineCount() : 0;
+  const QFontMetrics metrics(font());
+
+  int widest = max_line_width_;
+  for (size_t i = 0; top_row_ + i < count; i++) {
+    const int y = i * height;
+    if (y >= viewport()->height()) {
+      break;
+    }
+
+    const size_t row = top_row_ + i;
+    const QRect rect(0, y, width, height);
+    const bool selected = isRowSelected(row);
+
+    if (selected) {
+      painter.fillRect(rect, pal.highlight());
+    } else if (alternating_row_colors_ && (row % 2)) {
+      painter.fillRect(rect, pal.alternateBase());
+    }
+
+    QColor color = selected ? pal.color(QPalette::HighlightedText) : model_->lineColor(row);
+    if (!color.isValid()) {
+      color = pal.color(QPalette::Text);
+    }
+    painter.setPen(color);
+
+    const QString text = model_->lineText(row);
+    const int text_width = metrics.width(text);
+    widest = std::max(widest, text_width);
+    painter.drawText(QRect(TEXT_MARGIN - x_offset, y, text_width + TEXT_MARGIN, height),
+                     Qt::AlignLeft | Qt::AlignVCenter | Qt::TextSingleLine,
+                     text);
+
+    if (row == current_row_ && hasFocus()) {
+      painter.setPen(QPen(pal.color(QPalette::Highlight), 1, Qt::DotLine));
+      painter.drawRect(rect.adjusted(0, 0, -1, -1));
+    }
+  }
+
+  if (widest > max_line_width_) {
+    max_line_width_ = widest;
+    updateScrollBars();
+  }
+}
+
+void LogListWidget::resizeEvent(QResizeEvent *event)
+{
+  QAbstractScrollArea::resizeEvent(event);
+  setTopRow(top_row_);
+}
+
+void LogListWidget::changeEvent(QEvent *event)
+{
+  QAbstractScrollArea::changeEvent(event);
+  if (event->type() == QEvent::FontChange) {
+    max_line_width_ = 0;
+    setTopRow(top_row_);
+  }
+}
+
+void LogListWidget::scrollContentsBy(int, int)
+{
+  // Rows are painted from top_row_ and the horizontal scroll bar
+  // value, so there is nothing to scroll.  Just repaint.
+  viewport()->update();
+}
+
+bool LogListWidget::viewportEvent(QEvent *event)
+{
+  if (event->type() == QEvent::ToolTip && model_) {
+    QHelpEvent *help = static_cast<QHelpEvent*>(event);
+    size_t row;
+    if (rowAt(help->pos(), &row)) {
+      QToolTip::showText(help->globalPos(), model_->lineToolTip(row), viewport());
+    } else {
+      QToolTip::hideText();
+    }
+    return true;
+  }
+
+  return QAbstractScrollArea::viewportEvent(event);
+}
+
+void LogListWidget::wheelEvent(QWheelEvent *event)
+{
+  if (event->orientation() == Qt::Horizontal) {
+    QAbstractScrollArea::wheelEvent(event);
+    return;
+  }
+
+  // Scroll by rows directly instead of through the scroll bar, which
+  // may be scaled to less than one step per row.
+  long rows = -static_cast<long>(event->delta()) * QApplication::wheelScrollLines() / 120;
+  if (rows == 0) {
+    rows = event->delta() > 0 ? -1 : 1;
+  }
+
+  if (rows < 0 && static_cast<size_t>(-rows) > top_row_) {
+    setTopRow(0);
+  } else {
+    setTopRow(top_row_ + rows);
+  }
+  event->accept();
+}
+
+void LogListWidget::mousePressEvent(QMouseEvent *event)
+{
+  setFocus(Qt::MouseFocusReason);
+
+  size_t row;
+  if (!rowAt(event->pos(), &row)) {
+    if (event->button() == Qt::LeftButton && event->modifiers() == Qt::NoModifier) {
+      clearSelection();
+    }
+    return;
+  }
+
+  if (event->button() == Qt::LeftButton) {
+    setCurrentRow(row, event->modifiers());
+  } else if (event->button() == Qt::RightButton && !isRowSelected(row)) {
+    // Match QListView, which selects the row under a right-click so
+    // the context menu acts on it.
+    setCurrentRow(row, Qt::NoModifier);
+  }
+}
+
+void LogListWidget::mouseMoveEvent(QMouseEvent *event)
+{
+  if (!(event->buttons() & Qt::LeftButton) || !model_ || model_->lineCount() == 0) {
+    return;
+  }
+
+  // Dragging past the top or bottom of the viewport extends the
+  // selection and scrolls.
+  size_t row;
+  if (event->pos().y() < 0) {
+    row = top_row_ > 0 ? top_row_ - 1 : 0;
+  } else if (!rowAt(event->pos(), &row)) {
+    row = std::min(top_row_ + visibleRowCount(), model_->lineCount() - 1);
+  }
+
+  setCurrentRow(row, Qt::ShiftModifier);
+}
+
+void LogListWidget::mouseDoubleClickEvent(QMouseEvent *event)
+{
+  size_t row;
+  if (event->button() == Qt::LeftButton && rowAt(event->pos(), &row)) {
+    Q_EMIT rowDoubleClicked(row);
+  }
+}
+
+void LogListWidget::keyPressEvent(QKeyEvent *event)
+{
+  const size_t count = model_ ? model_->lineCount() : 0;
+  if (count == 0) {
+    QAbstractScrollArea::keyPressEvent(event);
+    return;
+  }
+
+  const size_t page = std::max<size_t>(visibleRowCount(), 1);
+  size_t row = std::min(current_row_, count - 1);
+
+  switch (event->key()) {
+    case Qt::Key_Up:
+      row = row > 0 ? row - 1 : 0;
+      break;
+    case Qt::Key_Down:
+      row = std::min(row + 1, count - 1);
+      break;
+    case Qt::Key_PageUp:
+      row = row > page ? row - page : 0;
+      break;
+    case Qt::Key_PageDown:
+      row = std::min(row + page, count - 1);
+      break;
+    case Qt::Key_Home:
+      row = 0;
+      break;
+    case Qt::Key_End:
+      row = count - 1;
+      break;
+    default:
+      QAbstractScrollArea::keyPressEvent(event);
+      return;
+  }
+
+  setCurrentRow(row, event->modifiers() & Qt::ShiftModifier);
+  event->accept();
+}
+
+void LogListWidget::handleVerticalScroll(int value)
+{
+  if (updating_scroll_bar_) {
+    return;
+  }
+
+  const size_t max_top = maxTopRow();
+  if (max_top <= static_cast<size_t>(MAX_SCROLL_VALUE)) {
+    top_row_ = std::min(static_cast<size_t>(std::max(value, 0)), max_top);
+  } else {
+    top_row_ = static_cast<size_t>(
+      std::floor(static_cast<double>(value) / MAX_SCROLL_VALUE * max_top));
+    top_row_ = std::min(top_row_, max_top);
+  }
+  viewport()->update();
+}
+
+void LogListWidget::handleRowsInserted(const QModelIndex &parent, int first, int last)
+{
+  if (parent.isValid()) {
+    return;
+  }
+
+  const size_t start = first;
+  const size_t count = last - first + 1;
+
+  for (size_t i = 0; i < selection_.size(); i++) {
+    if (selection_[i].first >= start) {
+      selection_[i].first += count;
+      selection_[i].last += count;
+    } else if (selection_[i].last >= start) {
+      selection_[i].last += count;
+    }
+  }
+
+  if (anchor_row_ >= start) {
+    anchor_row_ += count;
+  }
+  if (current_row_ >= start) {
+    current_row_ += count;
+  }
+
+  // Keep the same rows in view when rows are inserted above them.
+  if (top_row_ > 0 && start <= top_row_) {
+    top_row_ += count;
+  }
+
+  setTopRow(top_row_);
+}
+
+void LogListWidget::handleRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+  if (parent.isValid()) {
+    return;
+  }
+
+  const size_t start = first;
+  const size_t end = last;
+  const size_t count = end - start + 1;
+
+  std::vector<RowRange> selection;
+  for (size_t i = 0; i < selection_.size(); i++) {
+    RowRange range = selection_[i];
+    if (range.last < start) {
+      selection.push_back(range);
+    } else if (range.first > end) {
+      selection.push_back(RowRange(range.first - count, range.last - count));
+    } else if (range.first < start || range.last > end) {
+      // The range overlaps the removed rows.  Keep whatever is left
+      // on either side, merged into a single range.
+      size_t new_first = range.first < start ? range.first : start;
+      size_t new_last = range.last > end ? range.last - count : start - 1;
+      selection.push_back(RowRange(new_first, new_last));
+    }
+  }
+  selection_.swap(selection);
+
+  if (anchor_row_ > end) {
+    anchor_row_ -= count;
+  } else if (anchor_row_ >= start) {
+    anchor_row_ = start;
+  }
+  if (current_row_ > end) {
+    current_row_ -= count;
+  } else if (current_row_ >= start) {
+    current_row_ = start;
+  }
+
+  if (top_row_ > end) {
+    top_row_ -= count;
+  } else if (top_row_ >= start) {
+    top_row_ = start;
+  }
+
+  setTopRow(top_row_);
+}
+
+void LogListWidget::handleModelReset()
+{
+  selection_.clear();
+  top_row_ = 0;
+  anchor_row_ = 0;
+  current_row_ = 0;
+  max_line_width_ = 0;
+  setTopRow(0);
+}
+
+void LogListWidget::handleDataChanged()
+{
+  viewport()->update();
+}
+
+int LogListWidget::rowHeight() const
+{
+  return std::max(fontMetrics().height(), 1);
+}
+
+size_t LogListWidget::visibleRowCount() const
+{
+  return std::max(viewport()->height() / rowHeight(), 1);
+}
+
+size_t LogListWidget::maxTopRow() const
+{
+  const size_t count = model_ ? model_->lineCount() : 0;
+  const size_t visible = visibleRowCount();
+  return count > visible ? count - visible : 0;
+}
+
+void LogListWidget::updateScrollBars()
+{
+  const size_t max_top = maxTopRow();
+  QScrollBar *bar = verticalScrollBar();
+
+  updating_scroll_bar_ = true;
+  if (max_top <= static_cast<size_t>(MAX_SCROLL_VALUE)) {
+    bar->setRange(0, max_top);
+    bar->setValue(top_row_);
+  } else {
+    bar->setRange(0, MAX_SCROLL_VALUE);
+    bar->setValue(static_cast<int>(
+      std::floor(static_cast<double>(top_row_) / max_top * MAX_SCROLL_VALUE)));
+  }
+  bar->setPageStep(std::min(visibleRowCount(), static_cast<size_t>(MAX_SCROLL_VALUE)));
+  bar->setSingleStep(1);
+  updating_scroll_bar_ = false;
+
+  QScrollBar *hbar = horizontalScrollBar();
+  hbar->setRange(0, std::max(0, max_line_width_ + 2*TEXT_MARGIN - viewport()->width()));
+  hbar->setPageStep(viewport()->width());
+  hbar->setSingleStep(std::max(fontMetrics().averageCharWidth(), 1));
+}
+
+void LogListWidget::setTopRow(size_t row)
+{
+  top_row_ = std::min(row, maxTopRow());
+  updateScrollBars();
+  viewport()->update();
+}
+
+void LogListWidget::selectRange(size_t first, size_t last)
+{
+  selection_.clear();
+  selection_.push_back(RowRange(std::min(first, last), std::max(first, last)));
+}
+
+void LogListWidget::toggleRow(size_t row)
+{
+  std::vector<RowRange> selection;
+  bool found = false;
+  for (size_t i = 0; i < selection_.size(); i++) {
+    const RowRange &range = selection_[i];
+    if (row < range.first || row > range.last) {
+      selection.push_back(range);
+      continue;
+    }
+
+    // Split the range around the deselected row.
+    found = true;
+    if (range.first < row) {
+      selection.push_back(RowRange(range.first, row - 1));
+    }
+    if (range.last > row) {
+      selection.push_back(RowRange(row + 1, range.last));
+    }
+  }
+
+  if (!found) {
+    // Insert the new row and merge it with its neighbors.
+    std::vector<RowRange>::iterator it = selection.begin();
+    while (it != selection.end() && it->first < row) {
+      ++it;
+    }
+    it = selection.insert(it, RowRange(row, row));
+
+    if (it + 1 != selection.end() && (it + 1)->first == row + 1) {
+      it->last = (it + 1)->last;
+      selection.erase(it + 1);
+    }
+    if (it != selection.begin() && (it - 1)->last + 1 == row) {
+      (it - 1)->last = it->last;
+      selection.erase(it);
+    }
+  }
+
+  selection_.swap(selection);
+}
+
+void LogListWidget::setCurrentRow(size_t row, Qt::KeyboardModifiers modifiers)
+{
+  if (modifiers & Qt::ShiftModifier) {
+    selectRange(anchor_row_, row);
+  } else if (modifiers & Qt::ControlModifier) {
+    toggleRow(row);
+    anchor_row_ = row;
+  } else {
+    selectRange(row, row);
+    anchor_row_ = row;
+  }
+
+  current_row_ = row;
+  scrollToRow(row);
+  viewport()->update();
+}
+}  // namespace swri_console
@@ -0,0 +1,360 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/log_query.h>
+#include <swri_console/bag_source.h>
+#include <swri_console/session_source.h>
+#include <swri_console/text_log_source.h>
+
+#include <algorithm>
+#include <limits>
+#include <set>
+
+#include <QCoreApplication>
+#include <QThread>
+#include <QTimerEvent>
+#include <QtConcurrentRun>
+#include <rosgraph_msgs/Log.h>
+
+namespace swri_console
+{
+void registerMetaTypes();
+
+const char QUERY_ARGUMENT[] = "--query";
+
+// Interval (ms) at which formatted batches are written out.
+static const int POLL_INTERVAL = 10;
+
+LogQuery::LogQuery(const QStringList &filenames,
+                   const LogFilter &filter,
+                   const LogFormatter &formatter,
+                   Format format,
+                   FILE *output)
+  :
+  filenames_(filenames),
+  filter_(filter),
+  formatter_(formatter),
+  format_(format),
+  output_(output),
+  next_file_(0),
+  running_files_(0),
+  timer_id_(0),
+  match_count_(0),
+  error_count_(0)
+{
+  std::vector<std::string> *names = new std::vector<std::string>();
+  if (filenames_.size() > 1) {
+    for (int i = 0; i < filenames_.size(); i++) {
+      names->push_back(filenames_[i].toUtf8().constData());
+    }
+  }
+  names_.reset(names);
+}
+
+LogQuery::~LogQuery()
+{
+  for (size_t i = 0; i < outputs_.size(); i++) {
+    outputs_[i].waitForFinished();
+  }
+}
+
+void LogQuery::start()
+{
+  if (timer_id_) {
+    return;
+  }
+  timer_id_ = startTimer(POLL_INTERVAL);
+  startFiles();
+}
+
+void LogQuery::startFiles()
+{
+  // Every source reads on the thread pool, so a few files at a time
+  // are enough to keep all of the cores busy.
+  const int max_running = std::max(QThread::idealThreadCount(), 1);
+
+  while (running_files_ < max_running && next_file_ < filenames_.size()) {
+    const QString filename = filenames_[next_file_];
+    const uint16_t source = std::min(next_file_,
+                                     static_cast<int>(std::numeric_limits<uint16_t>::max()));
+    next_file_++;
+    running_files_++;
+
+    LogSource *log_source;
+    if (filename.endsWith(".swrilog", Qt::CaseInsensitive)) {
+      log_source = new SessionSource(filename, source);
+    } else if (filename.endsWith(".log", Qt::CaseInsensitive)) {
+      log_source = new TextLogSource(filename, source);
+    } else {
+      log_source = new BagSource(QStringList(filename), std::vector<uint16_t>(1, source));
+      QObject::connect(log_source, SIGNAL(indexRead(const swri_console::BagIndex &)),
+                       this, SLOT(bagIndexRead(const swri_console::BagIndex &)));
+    }
+
+    QObject::connect(log_source, SIGNAL(batchRead(const swri_console::LogBatchPtr &)),
+                     this, SLOT(handleBatch(const swri_console::LogBatchPtr &)));
+    QObject::connect(log_source, SIGNAL(finished(const QString&, bool, size_t, const QString&)),
+                     this, SLOT(fileFinished(const QString&, bool, size_t, const QString&)));
+    QObject::connect(log_source, SIGNAL(finished(const QString&, bool, size_t, const QString&)),
+                     log_source, SLOT(deleteLater()));
+    log_source->start();
+  }
+}
+
+void LogQuery::bagIndexRead(const swri_console::BagIndex &index)
+{
+  BagSource *bag = qobject_cast<BagSource*>(sender());
+  if (!bag || index.msg_count == 0) {
+    return;
+  }
+
+  // The severity and node filters are applied while decoding, so the
+  // text of rejected messages is never decoded.
+  BagQuery query(index.begin_time, index.end_time);
+  query.filter = filter_.decodeFilter();
+  bag->load(query);
+}
+
+void LogQuery::handleBatch(const swri_console::LogBatchPtr &batch)
+{
+  outputs_.push_back(QtConcurrent::run(&LogQuery::formatBatch,
+                                       batch, filter_, formatter_, format_, names_));
+}
+
+void LogQuery::fileFinished(const QString &name, bool success,
+                            size_t, const QString &error_msg)
+{
+  if (!success) {
+    fprintf(stderr, "%s: %s\n", qPrintable(name), qPrintable(error_msg));
+    error_count_++;
+  }
+  running_files_--;
+  startFiles();
+}
+
+void LogQuery::timerEvent(QTimerEvent *event)
+{
+  if (event->timerId() != timer_id_) {
+    return;
+  }
+
+  writeOutputs();
+
+  if (running_files_ == 0 && next_file_ == filenames_.size() && outputs_.empty()) {
+    killTimer(timer_id_);
+    fflush(output_);
+    Q_EMIT finished();
+  }
+}
+
+void LogQuery::writeOutputs()
+{
+  while (!outputs_.empty() && outputs_.front().isFinished()) {
+    Output output = outputs_.front().result();
+    outputs_.pop_front();
+    fwrite(output.data.constData(), 1, output.data.size(), output_);
+    match_count_ += output.match_count;
+  }
+}
+
+LogQuery::Output LogQuery::formatBatch(LogBatchPtr batch, LogFilter filter,
+                                       LogFormatter formatter, Format format,
+                                       NamesPtr names)
+{
+  static const std::string no_name;
+
+  Output output;
+  QString text;
+  std::string json;
+
+  for (size_t i = 0; i < batch->size(); i++) {
+    const LogEntry &item = (*batch)[i];
+    if (!filter.accept(item)) {
+      continue;
+    }
+    output.match_count++;
+
+    const std::string &name = (item.source < names->size()) ? (*names)[item.source] : no_name;
+    if (format == NDJSON) {
+      LogFormatter::appendJson(json, item, name);
+      json.push_back('\n');
+    } else {
+      for (int line = 0; line < item.text.size(); line++) {
+        if (!name.empty()) {
+          text.append(QString::fromUtf8(name.c_str()));
+          text.append(':');
+        }
+        formatter.appendLine(text, item, line);
+        text.append('\n');
+      }
+    }
+  }
+
+  if (format == NDJSON) {
+    output.data = QByteArray(json.data(), json.size());
+  } else {
+    output.data = text.toUtf8();
+  }
+  return output;
+}
+
+static int printUsage(const char *program)
+{
+  fprintf(stderr,
+          "usage: %s %s [options] FILE...\n"
+          "\n"
+          "Prints the log messages in bags, session files (*.swrilog) and\n"
+          "text logs (*.log) that pass the filters.\n"
+          "\n"
+          "  --node NAME      only messages from NAME; may be repeated\n"
+          "  --level LEVELS   only these severities, e.g. warn,error,fatal\n"
+          "  --include TEXT   only messages containing TEXT; may be repeated\n"
+          "  --exclude TEXT   no messages containing TEXT; may be repeated\n"
+          "  --regexp         match --include and --exclude as regular expressions\n"
+          "  --json           print one JSON object per message\n"
+          "  --no-time        leave the timestamps out of the text output\n",
+          program, QUERY_ARGUMENT);
+  return 2;
+}
+
+// Parses a comma separated list of severities into a mask.  Returns 0
+// if a name is not recognized.
+static uint8_t parseLevels(const QString &levels)
+{
+  uint8_t mask = 0;
+  QStringList names = levels.toLower().split(',', QString::SkipEmptyParts);
+  for (int i = 0; i < names.size(); i++) {
+    const QString name = names[i].trimmed();
+    if (name == "debug") {
+      mask |= rosgraph_msgs::Log::DEBUG;
+    } else if (name == "info") {
+      mask |= rosgraph_msgs::Log::INFO;
+    } else if (name == "warn") {
+      mask |= rosgraph_msgs::Log::WARN;
+    } else if (name == "error") {
+      mask |= rosgraph_msgs::Log::ERROR;
+    } else if (name == "fatal") {
+      mask |= rosgraph_msgs::Log::FATAL;
+    } else {
+      return 0;
+    }
+  }
+  return mask;
+}
+
+int runQuery(int argc, char **argv)
+{
+  QCoreApplication app(argc, argv);
+  registerMetaTypes();
+
+  // The same names as the GUI, so the bag index cache is shared.
+  QCoreApplication::setOrganizationName("Southwest Research Institute");
+  QCoreApplication::setOrganizationDomain("swri.org");
+  QCoreApplication::setApplicationName("SwRI Console");
+
+  std::set<std::string> nodes;
+  uint8_t severity_mask = 0;
+  QStringList includes;
+  QStringList excludes;
+  bool use_regexps = false;
+  LogQuery::Format format = LogQuery::TEXT;
+  LogFormatter formatter;
+  formatter.absolute_time = true;
+  QStringList filenames;
+
+  QStringList args = app.arguments();
+  for (int i = 2; i < args.size(); i++) {
+    const bool has_value = i + 1 < args.size();
+    if (args[i] == "--node" && has_value) {
+      nodes.insert(args[++i].toStdString());
+    } else if (args[i] == "--level" && has_value) {
+      severity_mask = parseLevels(args[++i]);
+      if (!severity_mask) {
+        return printUsage(argv[0]);
+      }
+    } else if (args[i] == "--include" && has_value) {
+      includes.append(args[++i]);
+    } else if (args[i] == "--exclude" && has_value) {
+      excludes.append(args[++i]);
+    } else if (args[i] == "--regexp") {
+      use_regexps = true;
+    } else if (args[i] == "--json") {
+      format = LogQuery::NDJSON;
+    } else if (args[i] == "--no-time") {
+      formatter.display_time = false;
+    } else if (args[i].startsWith("--")) {
+      return printUsage(argv[0]);
+    } else {
+      filenames.append(args[i]);
+    }
+  }
+
+  if (filenames.isEmpty()) {
+    return printUsage(argv[0]);
+  }
+
+  LogFilter filter;
+  if (!nodes.empty()) {
+    filter.setNodeFilter(nodes);
+  }
+  if (severity_mask) {
+    filter.setSeverityFilter(severity_mask);
+  }
+  if (use_regexps) {
+    // Several patterns match like the GUI's list of strings: any of
+    // the includes, none of the excludes.
+    filter.setUseRegularExpressions(true);
+    filter.setIncludeRegexpPattern(includes.join("|"));
+    filter.setExcludeRegexpPattern(excludes.join("|"));
+    if (!filter.isIncludeValid() || !filter.isExcludeValid()) {
+      fprintf(stderr, "Invalid regular expression.\n");
+      return 2;
+    }
+  } else {
+    filter.setIncludeFilters(includes);
+    filter.setExcludeFilters(excludes);
+  }
+
+  // stdout is written in large blocks, so it is fully buffered even
+  // when it is a terminal.
+  static char output_buffer[256 * 1024];
+  setvbuf(stdout, output_buffer, _IOFBF, sizeof(output_buffer));
+
+  LogQuery query(filenames, filter, formatter, format, stdout);
+  QObject::connect(&query, SIGNAL(finished()),
+                   &app, SLOT(quit()));
+  query.start();
+  app.exec();
+
+  if (query.errorCount() > 0) {
+    return 2;
+  }
+  return query.matchCount() > 0 ? 0 : 1;
+}
+}  // namespace swri_console
@@ -0,0 +1,224 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/log_server.h>
+#include <swri_console/session_file.h>
+
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include <QDateTime>
+#include <QLocalSocket>
+
+namespace swri_console
+{
+const char DEFAULT_SERVER_NAME[] = "swri_console";
+
+// Maximum number of entries encoded in one frame.
+static const size_t BLOCK_SIZE = 20000;
+
+// Data queued on a socket before the server waits for the client to
+// catch up.
+static const qint64 MAX_QUEUED_BYTES = 8 * 1024 * 1024;
+
+static uint64_t newInstanceId()
+{
+  return (static_cast<uint64_t>(getpid()) << 48) ^
+    static_cast<uint64_t>(QDateTime::currentMSecsSinceEpoch());
+}
+
+bool writeServerFrame(QIODevice *device, uint8_t type, const void *data, uint32_t size)
+{
+  char header[RELAY_HEADER_SIZE] = {
+    static_cast<char>(type),
+    static_cast<char>(size),
+    static_cast<char>(size >> 8),
+    static_cast<char>(size >> 16),
+    static_cast<char>(size >> 24)
+  };
+  return (device->write(header, sizeof(header)) == RELAY_HEADER_SIZE &&
+          device->write(static_cast<const char*>(data), size) == size);
+}
+
+LogServer::LogServer(LogDatabase *db, QObject *parent)
+  :
+  QObject(parent),
+  db_(db),
+  instance_id_(newInstanceId())
+{
+  QObject::connect(&server_, SIGNAL(newConnection()),
+                   this, SLOT(acceptClients()));
+  QObject::connect(db_, SIGNAL(messagesAdded()),
+                   this, SLOT(sendEntries()));
+}
+
+LogServer::~LogServer()
+{
+  server_.close();
+  for (int i = 0; i < clients_.size(); i++) {
+    clients_[i]->socket->disconnect(this);
+    delete clients_[i]->socket;
+    delete clients_[i];
+  }
+}
+
+bool LogServer::listen(const QString &name)
+{
+  QLocalServer::removeServer(name);
+  return server_.listen(name);
+}
+
+void LogServer::setStatus(bool connected, const QString &master_uri)
+{
+  master_uri_ = connected ? master_uri.toUtf8() : QByteArray();
+  for (int i = 0; i < clients_.size(); i++) {
+    writeServerFrame(clients_[i]->socket, SERVER_STATUS,
+                     master_uri_.constData(), master_uri_.size());
+  }
+}
+
+void LogServer::acceptClients()
+{
+  while (server_.hasPendingConnections()) {
+    Client *client = new Client();
+    client->socket = server_.nextPendingConnection();
+    client->socket->setParent(NULL);
+    client->resumed = false;
+    client->sent = 0;
+    clients_.append(client);
+
+    QObject::connect(client->socket, SIGNAL(readyRead()),
+                     this, SLOT(readClient()));
+    QObject::connect(client->socket, SIGNAL(bytesWritten(qint64)),
+                     this, SLOT(sendEntries()));
+    QObject::connect(client->socket, SIGNAL(disconnected()),
+                     this, SLOT(removeClient()));
+
+    writeServerFrame(client->socket, SERVER_HELLO, &instance_id_, sizeof(instance_id_));
+    writeServerFrame(client->socket, SERVER_STATUS, master_uri_.constData(), master_uri_.size());
+  }
+}
+
+LogServer::Client* LogServer::findClient(QObject *socket)
+{
+  for (int i = 0; i < clients_.size(); i++) {
+    if (clients_[i]->socket == socket) {
+      return clients_[i];
+    }
+  }
+  return NULL;
+}
+
+void LogServer::readClient()
+{
+  Client *client = findClient(sender());
+  if (!client) {
+    return;
+  }
+
+  QByteArray data = client->socket->readAll();
+  client->reader.append(data.constData(), data.size());
+
+  uint8_t type;
+  const uint8_t *frame;
+  uint32_t size;
+  while (client->reader.next(&type, &frame, &size)) {
+    if (type != CLIENT_RESUME || client->resumed) {
+      continue;
+    }
+
+    // A client that was attached to this instance, or to an earlier
+    // one whose entries were read back from the spill file, only needs
+    // the entries it has not seen.  Entries that an earlier instance
+    // sent but never spilled are gone, so the client continues from
+    // the end of that instance's entries.
+    uint64_t ids[2] = { 0, 0 };
+    memcpy(ids, frame, std::min(static_cast<size_t>(size), sizeof(ids)));
+    std::map<uint64_t, size_t>::const_iterator earlier = history_.find(ids[0]);
+    if (ids[0] == instance_id_) {
+      client->sent = std::min<uint64_t>(ids[1], db_->log().size());
+    } else if (earlier != history_.end()) {
+      client->sent = std::min<uint64_t>(ids[1], earlier->second);
+    } else {
+      client->sent = 0;
+    }
+    client->resumed = true;
+
+    const uint64_t skipped = client->sent;
+    writeServerFrame(client->socket, SERVER_RESUME, &skipped, sizeof(skipped));
+    sendEntries(client);
+  }
+}
+
+void LogServer::removeClient()
+{
+  Client *client = findClient(sender());
+  if (!client) {
+    return;
+  }
+
+  clients_.removeOne(client);
+  client->socket->deleteLater();
+  delete client;
+}
+
+void LogServer::sendEntries()
+{
+  for (int i = 0; i < clients_.size(); i++) {
+    sendEntries(clients_[i]);
+  }
+}
+
+void LogServer::sendEntries(Client *client)
+{
+  if (!client->resumed) {
+    return;
+  }
+
+  const std::deque<LogEntry> &log = db_->log();
+  client->sent = std::min(client->sent, log.size());
+
+  std::vector<LogEntry> block;
+  while (client->sent < log.size() &&
+         client->socket->bytesToWrite() < MAX_QUEUED_BYTES) {
+    const size_t end = std::min(client->sent + BLOCK_SIZE, log.size());
+    block.assign(log.begin() + client->sent, log.begin() + end);
+
+    QByteArray data = encodeSessionData(block);
+    if (data.isEmpty()) {
+      qWarning("Failed to encode entries for a log server client.");
+      return;
+    }
+    writeServerFrame(client->socket, SERVER_ENTRIES, data.constData(), data.size());
+    client->sent = end;
+  }
+}
+}  // namespace swri_console
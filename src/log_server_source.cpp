@@ -0,0 +1,234 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/log_server_source.h>
+#include <swri_console/log_server.h>
+#include <swri_console/session_file.h>
+
+#include <string.h>
+
+#include <algorithm>
+
+#include <QThread>
+#include <QTimerEvent>
+#include <QtConcurrentRun>
+
+namespace swri_console
+{
+// Interval (ms) at which decoded blocks are collected.
+static const int POLL_INTERVAL = 10;
+
+// First and longest intervals (ms) between attempts to reach the
+// server.
+static const int MIN_RETRY_INTERVAL = 250;
+static const int MAX_RETRY_INTERVAL = 5000;
+
+// Bytes buffered from the socket while blocks are being decoded.
+static const qint64 READ_BUFFER_SIZE = 8 * 1024 * 1024;
+
+LogServerSource::LogServerSource(const QString &server_name, uint16_t source, QObject *parent)
+  :
+  LogSource(parent),
+  server_name_(server_name),
+  source_(source),
+  poll_timer_id_(0),
+  attached_(false),
+  retry_interval_(MIN_RETRY_INTERVAL),
+  retry_timer_id_(0),
+  server_id_(0),
+  received_(0),
+  hello_id_(0)
+{
+  socket_.setReadBufferSize(READ_BUFFER_SIZE);
+  QObject::connect(&socket_, SIGNAL(readyRead()),
+                   this, SLOT(readFrames()));
+  QObject::connect(&socket_, SIGNAL(disconnected()),
+                   this, SLOT(handleDisconnected()));
+  QObject::connect(&socket_, SIGNAL(error(QLocalSocket::LocalSocketError)),
+                   this, SLOT(handleDisconnected()));
+}
+
+LogServerSource::~LogServerSource()
+{
+  socket_.disconnect(this);
+  for (size_t i = 0; i < blocks_.size(); i++) {
+    blocks_[i].waitForFinished();
+  }
+}
+
+void LogServerSource::start()
+{
+  if (!isFinished()) {
+    connectToServer();
+  }
+}
+
+void LogServerSource::halt()
+{
+  socket_.disconnect(this);
+  socket_.abort();
+  if (retry_timer_id_) {
+    killTimer(retry_timer_id_);
+    retry_timer_id_ = 0;
+  }
+  if (attached_) {
+    attached_ = false;
+    master_uri_.clear();
+    Q_EMIT statusChanged();
+  }
+}
+
+void LogServerSource::connectToServer()
+{
+  if (socket_.state() != QLocalSocket::UnconnectedState) {
+    socket_.blockSignals(true);
+    socket_.abort();
+    socket_.blockSignals(false);
+  }
+  reader_ = RelayFrameReader();
+  socket_.connectToServer(server_name_);
+}
+
+void LogServerSource::handleDisconnected()
+{
+  if (attached_) {
+    attached_ = false;
+    master_uri_.clear();
+    Q_EMIT statusChanged();
+  }
+
+  // The error and disconnected signals can both arrive for one
+  // failure, so only one attempt is scheduled at a time.
+  if (!retry_timer_id_) {
+    retry_timer_id_ = startTimer(retry_interval_);
+    retry_interval_ = std::min(2 * retry_interval_, MAX_RETRY_INTERVAL);
+  }
+}
+
+void LogServerSource::readFrames()
+{
+  // Only a few blocks are decoded at a time.  The rest of the data
+  // stays in the socket until they have been delivered.
+  const size_t max_in_flight = 2 * std::max(QThread::idealThreadCount(), 1);
+
+  while (blocks_.size() < max_in_flight) {
+    uint8_t type;
+    const uint8_t *data;
+    uint32_t size;
+    if (!reader_.next(&type, &data, &size)) {
+      QByteArray bytes = socket_.readAll();
+      if (bytes.isEmpty()) {
+        break;
+      }
+      reader_.append(bytes.constData(), bytes.size());
+      addBytes(bytes.size());
+      continue;
+    }
+
+    if (type == SERVER_HELLO) {
+      // The server is told which instance the entries came from, even
+      // if it is a new one, so that it can skip those it read back
+      // from its spill file.  It answers with SERVER_RESUME.
+      hello_id_ = 0;
+      memcpy(&hello_id_, data, std::min(static_cast<size_t>(size), sizeof(hello_id_)));
+      uint64_t resume[2] = { server_id_, received_ };
+      writeServerFrame(&socket_, CLIENT_RESUME, resume, sizeof(resume));
+      attached_ = true;
+      retry_interval_ = MIN_RETRY_INTERVAL;
+      Q_EMIT statusChanged();
+    } else if (type == SERVER_RESUME) {
+      server_id_ = hello_id_;
+      received_ = 0;
+      memcpy(&received_, data, std::min(static_cast<size_t>(size), sizeof(received_)));
+    } else if (type == SERVER_STATUS) {
+      master_uri_ = QString::fromUtf8(reinterpret_cast<const char*>(data), size);
+      Q_EMIT statusChanged();
+    } else if (type == SERVER_ENTRIES && size >= sizeof(SessionFileHeader)) {
+      SessionFileHeader header;
+      memcpy(&header, data, sizeof(header));
+      received_ += header.entry_count;
+      // Copied, so the block is aligned and outlives the reader's buffer.
+      QByteArray block(reinterpret_cast<const char*>(data), size);
+      blocks_.push_back(QtConcurrent::run(&LogServerSource::decodeBlock, block, source_));
+    }
+  }
+
+  if (!blocks_.empty() && !poll_timer_id_) {
+    poll_timer_id_ = startTimer(POLL_INTERVAL);
+  }
+}
+
+void LogServerSource::timerEvent(QTimerEvent *event)
+{
+  if (event->timerId() == retry_timer_id_) {
+    killTimer(retry_timer_id_);
+    retry_timer_id_ = 0;
+    connectToServer();
+    return;
+  } else if (event->timerId() != poll_timer_id_) {
+    return;
+  }
+
+  while (!blocks_.empty() && blocks_.front().isFinished()) {
+    LogBatchPtr batch = blocks_.front().result();
+    blocks_.pop_front();
+    deliver(batch);
+  }
+
+  // Picks up data that was left in the socket while the decoders were
+  // busy.
+  readFrames();
+
+  if (blocks_.empty()) {
+    killTimer(poll_timer_id_);
+    poll_timer_id_ = 0;
+  }
+}
+
+QString LogServerSource::statusText() const
+{
+  if (!attached_) {
+    return tr("Recorder: not attached");
+  }
+  if (master_uri_.isEmpty()) {
+    return tr("Recorder: no ROS master");
+  }
+  return tr("Recorder: %1").arg(master_uri_);
+}
+
+LogBatchPtr LogServerSource::decodeBlock(QByteArray data, uint16_t source)
+{
+  LogBatchPtr batch(new std::vector<LogEntry>());
+  QString error_msg = decodeSessionData(data, source, batch.get());
+  if (!error_msg.isEmpty()) {
+    qWarning("Received a bad block from the recorder: %s", qPrintable(error_msg));
+  }
+  return batch;
+}
+}  // namespace swri_console
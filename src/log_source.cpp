@@ -0,0 +1,144 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/log_source.h>
+
+namespace swri_console
+{
+// Interval (ms) at which the rate is measured and statsUpdated() is
+// emitted.
+static const int STATS_INTERVAL = 1000;
+
+LogSource::LogSource(QObject *parent)
+  :
+  QObject(parent),
+  finished_(false),
+  backlog_(new QAtomicInt(0)),
+  last_msg_count_(0),
+  last_elapsed_(0.0),
+  changed_(false)
+{
+  elapsed_timer_.start();
+  stats_timer_.setInterval(STATS_INTERVAL);
+  QObject::connect(&stats_timer_, SIGNAL(timeout()),
+                   this, SLOT(updateStats()));
+}
+
+LogSource::~LogSource()
+{
+}
+
+void LogSource::stop()
+{
+  if (finished_) {
+    return;
+  }
+  halt();
+  finish(true);
+}
+
+void LogSource::cancel()
+{
+  if (finished_) {
+    return;
+  }
+  halt();
+  finish(false, "Cancelled");
+}
+
+void LogSource::deliver(const LogBatchPtr &batch, uint64_t bytes)
+{
+  if (finished_) {
+    return;
+  }
+
+  stats_.byte_count += bytes;
+  if (batch->empty()) {
+    return;
+  }
+  stats_.msg_count += batch->size();
+  changed_ = true;
+  if (!stats_timer_.isActive()) {
+    stats_timer_.start();
+  }
+  Q_EMIT batchRead(batch);
+}
+
+void LogSource::deliverQueued(const LogBatchPtr &batch, uint64_t bytes)
+{
+  backlog_->fetchAndAddOrdered(-static_cast<int>(batch->size()));
+  deliver(batch, bytes);
+}
+
+void LogSource::addBytes(uint64_t bytes)
+{
+  stats_.byte_count += bytes;
+}
+
+void LogSource::addDrops(size_t count)
+{
+  if (count) {
+    stats_.drop_count += count;
+    changed_ = true;
+    if (!finished_ && !stats_timer_.isActive()) {
+      stats_timer_.start();
+    }
+  }
+}
+
+void LogSource::finish(bool success, const QString &error_msg)
+{
+  if (finished_) {
+    return;
+  }
+  finished_ = true;
+  stats_timer_.stop();
+  updateStats();
+  Q_EMIT finished(name(), success, stats_.msg_count, error_msg);
+}
+
+void LogSource::updateStats()
+{
+  stats_.elapsed = elapsed_timer_.elapsed() / 1000.0;
+  const double interval = stats_.elapsed - last_elapsed_;
+  if (interval > 0.0) {
+    stats_.rate = (stats_.msg_count - last_msg_count_) / interval;
+  }
+  last_msg_count_ = stats_.msg_count;
+  last_elapsed_ = stats_.elapsed;
+
+  // The timer keeps running while entries arrive, and one more time
+  // so the rate drops back to zero.
+  if (!changed_ && stats_.rate == 0.0) {
+    stats_timer_.stop();
+  }
+  changed_ = false;
+  Q_EMIT statsUpdated(stats_);
+}
+}  // namespace swri_console
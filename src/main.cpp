@@ -34,7 +34,12 @@
 #include <QDirIterator>
 #include <QStringList>
 
+#include <string.h>
+
 #include <swri_console/console_master.h>
+#include <swri_console/headless_recorder.h>
+#include <swri_console/log_query.h>
+#include <swri_console/ros_relay.h>
 
 namespace swri_console {
 void registerMetaTypes();
@@ -79,6 +84,17 @@ void loadFonts()
 
 int main(int argc, char **argv)
 {
+  // Relays for additional ROS masters are copies of this program.
+  if (argc > 1 && strcmp(argv[1], swri_console::RELAY_ARGUMENT) == 0) {
+    return swri_console::runRelay(argc, argv);
+  }
+  if (argc > 1 && strcmp(argv[1], swri_console::HEADLESS_ARGUMENT) == 0) {
+    return swri_console::runHeadless(argc, argv);
+  }
+  if (argc > 1 && strcmp(argv[1], swri_console::QUERY_ARGUMENT) == 0) {
+    return swri_console::runQuery(argc, argv);
+  }
+
   QApplication app(argc, argv);
   swri_console::registerMetaTypes();
   loadFonts();
@@ -88,6 +104,17 @@ int main(int argc, char **argv)
   QCoreApplication::setApplicationName("SwRI Console");
   
   swri_console::ConsoleMaster master;
+
+  // "--attach NAME" takes the logs from a headless recorder instead of
+  // subscribing to the ROS master.
+  QStringList args = app.arguments();
+  int attach = args.indexOf("--attach");
+  if (attach > 0 && attach + 1 < args.size()) {
+    master.attachToRecorder(args[attach + 1]);
+  } else {
+    master.startRosSource();
+  }
+
   master.createNewWindow();
   app.connect(&app, SIGNAL(lastWindowClosed()), &app, SLOT(quit()));
   int result = app.exec();
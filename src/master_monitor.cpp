@@ -0,0 +1,83 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/master_monitor.h>
+
+#include <algorithm>
+
+#include <ros/master.h>
+
+namespace swri_console
+{
+// Interval (ms) between checks while the master is up.
+static const int CHECK_INTERVAL = 1000;
+
+// First and longest intervals (ms) between checks while the master is
+// down.
+static const int MIN_RETRY_INTERVAL = 250;
+static const int MAX_RETRY_INTERVAL = 5000;
+
+MasterMonitor::MasterMonitor()
+  :
+  timer_(this),
+  checked_(false),
+  is_up_(false),
+  retry_interval_(MIN_RETRY_INTERVAL)
+{
+  timer_.setSingleShot(true);
+  QObject::connect(&timer_, SIGNAL(timeout()),
+                   this, SLOT(checkMaster()));
+}
+
+void MasterMonitor::start()
+{
+  if (!checked_ && !timer_.isActive()) {
+    timer_.start(0);
+  }
+}
+
+void MasterMonitor::checkMaster()
+{
+  bool is_up = ros::master::check();
+
+  if (!checked_ || is_up != is_up_) {
+    checked_ = true;
+    is_up_ = is_up;
+    Q_EMIT masterStatusChanged(is_up_);
+  }
+
+  if (is_up_) {
+    retry_interval_ = MIN_RETRY_INTERVAL;
+    timer_.start(CHECK_INTERVAL);
+  } else {
+    timer_.start(retry_interval_);
+    retry_interval_ = std::min(2 * retry_interval_, MAX_RETRY_INTERVAL);
+  }
+}
+}  // namespace swri_console
@@ -29,6 +29,7 @@
 // *****************************************************************************
 
 #include <stdio.h>
+#include <algorithm>
 #include <vector>
 
 #include <swri_console/node_list_model.h>
@@ -58,7 +59,7 @@ int NodeListModel::rowCount(const QModelIndex &parent) const
 std::string NodeListModel::nodeName(const QModelIndex &index) const
 {
   if (index.parent().isValid() ||
-      index.row() > ordering_.size()) {
+      index.row() >= ordering_.size()) {
     return "";
   }
 
@@ -68,11 +69,11 @@ std::string NodeListModel::nodeName(const QModelIndex &index) const
 QVariant NodeListModel::data(const QModelIndex &index, int role) const
 {
   if (index.parent().isValid() ||
-      index.row() > ordering_.size()) {
+      index.row() >= ordering_.size()) {
     return QVariant();
   } 
 
-  std::string name = ordering_[index.row()];
+  const std::string &name = ordering_[index.row()];
   
   if (role == Qt::DisplayRole) {
     char buffer[1023];
@@ -93,6 +94,7 @@ void NodeListModel::clear()
   beginRemoveRows(QModelIndex(), 0, ordering_.size()-1);
   data_.clear();
   ordering_.clear();
+  row_index_.clear();
   endRemoveRows();
 }
 
@@ -103,35 +105,82 @@ void NodeListModel::handleDatabaseCleared()
   // clear out the logs while retaining their node selection so that
   // they can easily reset the data without having to choose the
   // selection again.  
-  std::map<std::string, size_t>::iterator iter;
+  if (ordering_.empty()) {
+    return;
+  }
+
+  std::unordered_map<std::string, size_t>::iterator iter;
   for (iter = data_.begin(); iter != data_.end(); ++iter) {
     (*iter).second = 0;
   }
 
-  Q_EMIT dataChanged(index(0), index(data_.size()-1));
+  Q_EMIT dataChanged(index(0), index(ordering_.size()-1));
 }
 
 void NodeListModel::handleMessagesAdded()
 {
+  const std::set<std::string> &changed = db_->changedNodes();
+  if (changed.empty()) {
+    return;
+  }
+
   const std::map<std::string, size_t> &msg_counts = db_->messageCounts();
-  
-  size_t i = 0;
-  for (std::map<std::string, size_t>::const_iterator it = msg_counts.begin();
-       it != msg_counts.end();
+
+  // Update the counts of the nodes in this batch, inserting any new
+  // nodes at their sorted position.  Since the changed set is sorted,
+  // new nodes are always inserted in increasing order.
+  bool inserted = false;
+  for (std::set<std::string>::const_iterator it = changed.begin();
+       it != changed.end();
        ++it)
   {
-    if (!data_.count(it->first)) {
-      beginInsertRows(QModelIndex(), i, i);
-      data_[it->first] = it->second;
-      ordering_.insert(ordering_.begin() + i, it->first);
-      endInsertRows();
-    } else {
-      data_[it->first] = it->second;
+    std::map<std::string, size_t>::const_iterator count = msg_counts.find(*it);
+    size_t value = count == msg_counts.end() ? 0 : count->second;
+
+    std::unordered_map<std::string, size_t>::iterator entry = data_.find(*it);
+    if (entry != data_.end()) {
+      entry->second = value;
+      continue;
     }
-    i++;
+
+    int row = std::lower_bound(ordering_.begin(), ordering_.end(), *it) - ordering_.begin();
+    beginInsertRows(QModelIndex(), row, row);
+    data_[*it] = value;
+    ordering_.insert(ordering_.begin() + row, *it);
+    endInsertRows();
+    inserted = true;
+  }
+
+  if (inserted) {
+    rebuildRowIndex();
+  }
+
+  // Notify the views about the touched rows only, coalescing adjacent
+  // rows into a single range.
+  std::vector<int> rows;
+  rows.reserve(changed.size());
+  for (std::set<std::string>::const_iterator it = changed.begin();
+       it != changed.end();
+       ++it)
+  {
+    rows.push_back(row_index_[*it]);
+  }
+  std::sort(rows.begin(), rows.end());
+
+  size_t start = 0;
+  for (size_t i = 1; i <= rows.size(); i++) {
+    if (i == rows.size() || rows[i] != rows[i-1] + 1) {
+      Q_EMIT dataChanged(index(rows[start]), index(rows[i-1]));
+      start = i;
+    }
+  }
+}
+
+void NodeListModel::rebuildRowIndex()
+{
+  row_index_.clear();
+  for (size_t i = 0; i < ordering_.size(); i++) {
+    row_index_[ordering_[i]] = i;
   }
-  
-  Q_EMIT dataChanged(index(0),
-                     index(ordering_.size()-1));
 }
 }  // namespace swri_console
@@ -1,5 +1,9 @@
 #include <QMetaType>
 #include <rosgraph_msgs/Log.h>
+#include <swri_console/bag_index.h>
+#include <swri_console/ingest_monitor.h>
+#include <swri_console/log_database.h>
+#include <swri_console/log_source.h>
 
 namespace swri_console
 {
@@ -7,5 +11,11 @@ void registerMetaTypes()
 {
   qRegisterMetaType<size_t>("size_t");
   qRegisterMetaType<rosgraph_msgs::LogConstPtr>("rosgraph_msgs::LogConstPtr");
+  qRegisterMetaType<swri_console::LogBatchPtr>("swri_console::LogBatchPtr");
+  qRegisterMetaType<swri_console::BagIndex>("swri_console::BagIndex");
+  qRegisterMetaType<swri_console::BagQuery>("swri_console::BagQuery");
+  qRegisterMetaType<swri_console::BagLoadProgress>("swri_console::BagLoadProgress");
+  qRegisterMetaType<swri_console::IngestStats>("swri_console::IngestStats");
+  qRegisterMetaType<swri_console::LogSourceStats>("swri_console::LogSourceStats");
 }
 }  // namespace swri_console
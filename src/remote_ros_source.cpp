@@ -0,0 +1,117 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/remote_ros_source.h>
+#include <swri_console/remote_ros_source_backend.h>
+
+namespace swri_console
+{
+RemoteRosSource::RemoteRosSource(const QString &label, const QString &master_uri,
+                                 uint16_t source, QObject *parent)
+  :
+  LogSource(parent),
+  label_(label),
+  master_uri_(master_uri),
+  source_(source),
+  backend_(NULL),
+  connected_(false)
+{
+  // The rate is shown in the status text.
+  QObject::connect(this, SIGNAL(statsUpdated(const swri_console::LogSourceStats &)),
+                   this, SIGNAL(statusChanged()));
+}
+
+RemoteRosSource::~RemoteRosSource()
+{
+  halt();
+  thread_.quit();
+  thread_.wait();
+}
+
+void RemoteRosSource::halt()
+{
+  if (backend_ && thread_.isRunning()) {
+    // Kill the relay before the thread goes away.
+    QMetaObject::invokeMethod(backend_, "stop", Qt::BlockingQueuedConnection);
+  }
+}
+
+void RemoteRosSource::start()
+{
+  if (backend_ || isFinished()) {
+    return;
+  }
+
+  backend_ = new RemoteRosSourceBackend(label_, master_uri_, source_, backlog());
+  backend_->moveToThread(&thread_);
+
+  QObject::connect(&thread_, SIGNAL(started()),
+                   backend_, SLOT(start()));
+  QObject::connect(&thread_, SIGNAL(finished()),
+                   backend_, SLOT(deleteLater()));
+
+  QObject::connect(backend_, SIGNAL(connected(bool)),
+                   this, SLOT(handleConnected(bool)));
+  QObject::connect(backend_, SIGNAL(batchRead(const swri_console::LogBatchPtr &)),
+                   this, SLOT(handleBatch(const swri_console::LogBatchPtr &)));
+  QObject::connect(backend_, SIGNAL(ingestStatsUpdated(const swri_console::IngestStats &)),
+                   this, SLOT(handleIngestStats(const swri_console::IngestStats &)));
+  thread_.start();
+}
+
+QString RemoteRosSource::statusText() const
+{
+  if (!connected_) {
+    return tr("%1: not connected").arg(label_);
+  }
+  return tr("%1: %2 msg/s").arg(label_).arg(stats().rate, 0, 'f', 0);
+}
+
+void RemoteRosSource::handleConnected(bool connected)
+{
+  connected_ = connected;
+  Q_EMIT statusChanged();
+}
+
+void RemoteRosSource::handleBatch(const swri_console::LogBatchPtr &batch)
+{
+  deliverQueued(batch);
+}
+
+void RemoteRosSource::handleIngestStats(const swri_console::IngestStats &stats)
+{
+  // The counts only grow.
+  const uint64_t total = stats.totalLost() + stats.totalShed();
+  const uint64_t last_total = ingest_stats_.totalLost() + ingest_stats_.totalShed();
+  if (total > last_total) {
+    addDrops(total - last_total);
+  }
+  ingest_stats_ = stats;
+}
+}  // namespace swri_console
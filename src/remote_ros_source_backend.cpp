@@ -0,0 +1,249 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/remote_ros_source_backend.h>
+#include <swri_console/log_decoder.h>
+#include <swri_console/log_source.h>
+
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QProcessEnvironment>
+#include <QStringList>
+#include <QTimerEvent>
+
+namespace swri_console
+{
+// First and longest delays (ms) before a relay that exited is
+// restarted.
+static const int MIN_RETRY_INTERVAL = 250;
+static const int MAX_RETRY_INTERVAL = 5000;
+
+// Interval (ms) at which decoding is retried while the backlog is
+// full.
+static const int RESUME_INTERVAL = 50;
+
+// Minimum interval (ms) between ingestStatsUpdated() signals.
+static const int STATS_INTERVAL = 500;
+
+// Bytes taken from the relay's output at a time.
+static const qint64 READ_SIZE = 1024 * 1024;
+
+RemoteRosSourceBackend::RemoteRosSourceBackend(const QString &label,
+                                               const QString &master_uri,
+                                               uint16_t source,
+                                               const boost::shared_ptr<QAtomicInt> &backlog)
+  :
+  label_(label),
+  master_uri_(master_uri),
+  source_(source),
+  backlog_(backlog),
+  process_(NULL),
+  stats_timer_(this),
+  stopped_(false),
+  connected_(false),
+  retry_interval_(MIN_RETRY_INTERVAL),
+  restart_timer_id_(0),
+  resume_timer_id_(0)
+{
+  stats_timer_.setSingleShot(true);
+  stats_timer_.setInterval(STATS_INTERVAL);
+  QObject::connect(&stats_timer_, SIGNAL(timeout()),
+                   this, SLOT(emitIngestStats()));
+}
+
+RemoteRosSourceBackend::~RemoteRosSourceBackend()
+{
+  stop();
+}
+
+void RemoteRosSourceBackend::start()
+{
+  if (process_ || stopped_) {
+    return;
+  }
+
+  process_ = new QProcess(this);
+  // The relay's log output goes to our stderr.
+  process_->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+  env.insert("ROS_MASTER_URI", master_uri_);
+  process_->setProcessEnvironment(env);
+
+  QObject::connect(process_, SIGNAL(readyReadStandardOutput()),
+                   this, SLOT(readOutput()));
+  QObject::connect(process_, SIGNAL(finished(int, QProcess::ExitStatus)),
+                   this, SLOT(relayFinished()));
+  QObject::connect(process_, SIGNAL(error(QProcess::ProcessError)),
+                   this, SLOT(relayFinished()));
+
+  startRelay();
+}
+
+void RemoteRosSourceBackend::startRelay()
+{
+  reader_ = RelayFrameReader();
+  process_->start(QCoreApplication::applicationFilePath(),
+                  QStringList() << RELAY_ARGUMENT);
+}
+
+void RemoteRosSourceBackend::stop()
+{
+  stopped_ = true;
+  if (resume_timer_id_) {
+    killTimer(resume_timer_id_);
+    resume_timer_id_ = 0;
+  }
+  if (process_ && process_->state() != QProcess::NotRunning) {
+    process_->disconnect(this);
+    process_->kill();
+    process_->waitForFinished(1000);
+  }
+}
+
+void RemoteRosSourceBackend::readOutput()
+{
+  if (resume_timer_id_ || stopped_) {
+    return;
+  }
+
+  // Frames are only decoded while there is room in the backlog.  The
+  // rest of the output is left in the process's buffer.
+  const int backlog = std::max(backlog_->fetchAndAddOrdered(0), 0);
+  const size_t room = (backlog < LogSource::MAX_BACKLOG) ? LogSource::MAX_BACKLOG - backlog : 0;
+
+  LogBatchPtr batch(new std::vector<LogEntry>());
+  const std::string prefix = label_.toStdString() + ":";
+  // The relay only follows /rosout_agg, which /rosout publishes.
+  const std::string publisher = prefix + "/rosout";
+  bool stats_changed = false;
+  std::string node;
+
+  uint8_t type;
+  const uint8_t *frame;
+  uint32_t size;
+  while (batch->size() < room) {
+    if (!reader_.next(&type, &frame, &size)) {
+      QByteArray data = process_->read(READ_SIZE);
+      if (data.isEmpty()) {
+        break;
+      }
+      reader_.append(data.constData(), data.size());
+      continue;
+    }
+
+    if (type == RELAY_CONNECTED) {
+      connected_ = true;
+      retry_interval_ = MIN_RETRY_INTERVAL;
+      Q_EMIT connected(true);
+    } else if (type == RELAY_MESSAGE) {
+      uint32_t seq;
+      uint32_t sec;
+      uint32_t nsec;
+      uint8_t level;
+      if (!decodeLogHeader(frame, size, &seq, &sec, &nsec, &level, &node)) {
+        qWarning("Failed to decode a log message from %s.", qPrintable(label_));
+        continue;
+      }
+
+      // Each message is judged against the backlog including the
+      // messages decoded ahead of it.
+      stats_changed |= ingest_monitor_.trackSequence(publisher, seq);
+      if (!ingest_monitor_.keep(prefix + node, level, backlog + batch->size())) {
+        stats_changed = true;
+        continue;
+      }
+
+      batch->push_back(LogEntry());
+      if (!decodeLogMessage(frame, size, &batch->back())) {
+        qWarning("Failed to decode a log message from %s.", qPrintable(label_));
+        batch->pop_back();
+        continue;
+      }
+      batch->back().node.insert(0, prefix);
+      batch->back().source = source_;
+    }
+  }
+
+  if (!batch->empty()) {
+    backlog_->fetchAndAddOrdered(batch->size());
+    Q_EMIT batchRead(batch);
+  }
+
+  if (stats_changed && !stats_timer_.isActive()) {
+    stats_timer_.start();
+  }
+
+  if (backlog_->fetchAndAddOrdered(0) >= LogSource::MAX_BACKLOG) {
+    resume_timer_id_ = startTimer(RESUME_INTERVAL);
+  }
+}
+
+void RemoteRosSourceBackend::emitIngestStats()
+{
+  Q_EMIT ingestStatsUpdated(ingest_monitor_.stats());
+}
+
+void RemoteRosSourceBackend::relayFinished()
+{
+  if (stopped_ || restart_timer_id_) {
+    return;
+  }
+
+  if (connected_) {
+    connected_ = false;
+    Q_EMIT connected(false);
+  }
+
+  restart_timer_id_ = startTimer(retry_interval_);
+  retry_interval_ = std::min(2 * retry_interval_, MAX_RETRY_INTERVAL);
+}
+
+void RemoteRosSourceBackend::timerEvent(QTimerEvent *event)
+{
+  if (event->timerId() == restart_timer_id_) {
+    killTimer(restart_timer_id_);
+    restart_timer_id_ = 0;
+    if (resume_timer_id_) {
+      // Output of the last relay that is still waiting to be decoded
+      // would be lost by starting a new one.
+      restart_timer_id_ = startTimer(retry_interval_);
+    } else if (!stopped_ && process_->state() == QProcess::NotRunning) {
+      startRelay();
+    }
+  } else if (event->timerId() == resume_timer_id_ &&
+             backlog_->fetchAndAddOrdered(0) < LogSource::MAX_BACKLOG) {
+    killTimer(resume_timer_id_);
+    resume_timer_id_ = 0;
+    // Data that is already buffered does not signal readyRead again.
+    readOutput();
+  }
+}
+}  // namespace swri_console
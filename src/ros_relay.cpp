@@ -0,0 +1,177 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/ros_relay.h>
+#include <swri_console/raw_log_message.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+
+#include <boost/bind.hpp>
+#include <ros/ros.h>
+
+namespace swri_console
+{
+const char RELAY_ARGUMENT[] = "--relay";
+
+// Interval (ms) at which the relay flushes stdout, which bounds the
+// latency it adds.
+static const int FLUSH_INTERVAL = 10;
+
+// Interval (ms) at which the relay checks the master while connected,
+// and the first and longest intervals while waiting for it.
+static const int CHECK_INTERVAL = 1000;
+static const int MIN_RETRY_INTERVAL = 250;
+static const int MAX_RETRY_INTERVAL = 5000;
+
+RelayFrameReader::RelayFrameReader()
+  :
+  pos_(0)
+{
+}
+
+void RelayFrameReader::append(const char *data, size_t size)
+{
+  // Drop the frames that have been consumed before growing the buffer.
+  if (pos_ > 0) {
+    buffer_.erase(buffer_.begin(), buffer_.begin() + pos_);
+    pos_ = 0;
+  }
+  buffer_.insert(buffer_.end(),
+                 reinterpret_cast<const uint8_t*>(data),
+                 reinterpret_cast<const uint8_t*>(data) + size);
+}
+
+bool parseRelayFrame(const uint8_t *data, size_t size,
+                     uint8_t *type, const uint8_t **frame, uint32_t *frame_size)
+{
+  if (size < RELAY_HEADER_SIZE) {
+    return false;
+  }
+
+  const uint32_t length = (static_cast<uint32_t>(data[1]) |
+                           static_cast<uint32_t>(data[2]) << 8 |
+                           static_cast<uint32_t>(data[3]) << 16 |
+                           static_cast<uint32_t>(data[4]) << 24);
+  if (size - RELAY_HEADER_SIZE < length) {
+    return false;
+  }
+
+  *type = data[0];
+  *frame = data + RELAY_HEADER_SIZE;
+  *frame_size = length;
+  return true;
+}
+
+bool RelayFrameReader::next(uint8_t *type, const uint8_t **data, uint32_t *size)
+{
+  if (pos_ >= buffer_.size() ||
+      !parseRelayFrame(&buffer_[pos_], buffer_.size() - pos_, type, data, size)) {
+    return false;
+  }
+  pos_ += RELAY_HEADER_SIZE + *size;
+  return true;
+}
+
+static void writeFrame(uint8_t type, const void *data, uint32_t size)
+{
+  uint8_t header[RELAY_HEADER_SIZE] = {
+    type,
+    static_cast<uint8_t>(size),
+    static_cast<uint8_t>(size >> 8),
+    static_cast<uint8_t>(size >> 16),
+    static_cast<uint8_t>(size >> 24)
+  };
+  fwrite(header, 1, sizeof(header), stdout);
+  fwrite(data, 1, size, stdout);
+}
+
+static void relayMessage(const RawLogMessageConstPtr &msg)
+{
+  if (!msg->data.empty()) {
+    writeFrame(RELAY_MESSAGE, &msg->data[0], msg->data.size());
+  }
+}
+
+static void flushOutput(const ros::WallTimerEvent &)
+{
+  fflush(stdout);
+}
+
+int runRelay(int argc, char **argv)
+{
+  ros::init(argc, argv, "swri_console_relay",
+            ros::init_options::AnonymousName |
+            ros::init_options::NoRosout);
+
+  // stdout carries the frames, so it must be fully buffered.  It is
+  // flushed on a timer instead of per message.
+  static char output_buffer[64 * 1024];
+  setvbuf(stdout, output_buffer, _IOFBF, sizeof(output_buffer));
+
+  int retry_interval = MIN_RETRY_INTERVAL;
+  while (!ros::master::check()) {
+    usleep(retry_interval * 1000);
+    retry_interval = std::min(2 * retry_interval, MAX_RETRY_INTERVAL);
+  }
+
+  ros::start();
+  ros::NodeHandle nh;
+
+  // Messages and flushes are both handled by the spinner's single
+  // thread, so only one thread writes to stdout.
+  ros::Subscriber sub = nh.subscribe<RawLogMessage>("/rosout_agg", 10000, &relayMessage);
+  ros::WallTimer flush_timer = nh.createWallTimer(
+    ros::WallDuration(FLUSH_INTERVAL / 1000.0), &flushOutput);
+
+  const std::string uri = ros::master::getURI();
+  writeFrame(RELAY_CONNECTED, uri.data(), uri.size());
+  fflush(stdout);
+
+  ros::AsyncSpinner spinner(1);
+  spinner.start();
+
+  // The master is checked from this thread, so a slow master does not
+  // hold up messages.  The relay exits when the master is lost and is
+  // restarted by its parent, since roscpp can't re-register with a
+  // restarted master.
+  while (ros::ok() && ros::master::check()) {
+    usleep(CHECK_INTERVAL * 1000);
+  }
+
+  spinner.stop();
+  ros::shutdown();
+  fflush(stdout);
+  return 0;
+}
+}  // namespace swri_console
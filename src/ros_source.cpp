@@ -29,6 +29,7 @@
 // *****************************************************************************
 #include <swri_console/ros_source.h>
 #include <swri_console/ros_source_backend.h>
+#include <swri_console/master_monitor.h>
 
 
 namespace swri_console
@@ -36,12 +37,22 @@ namespace swri_console
 RosSource::RosSource()
   :
   backend_(NULL),
+  monitor_(NULL),
   connected_(false)
 {
 }
 
 RosSource::~RosSource()
 {
+  // The monitor may be in the middle of a check that won't return
+  // until the master answers or the check times out.
+  monitor_thread_.quit();
+  if (!monitor_thread_.wait(500)) {
+    qWarning("Master monitor thread is not closing in a timely fashion.  "
+             "We will attempt to forcibly terminate the thread.");
+    monitor_thread_.terminate();
+  }
+
   ros_thread_.quit();
   if (!ros_thread_.wait(500)) {
     qWarning("ROS thread is not closing in a timely fashion.  This seems to "
@@ -59,7 +70,7 @@ void RosSource::start()
 
   // Using the threading approach recommended in the following URL.
   // https://mayaposch.wordpress.com/2011/11/01/how-to-really-truly-use-qthreads-the-full-explanation/
-  backend_ = new RosSourceBackend();
+  backend_ = new RosSourceBackend(backlog());
   backend_->moveToThread(&ros_thread_);
 
   // The backend should delete itself once the thread has finished.
@@ -68,9 +79,24 @@ void RosSource::start()
 
   QObject::connect(backend_, SIGNAL(connected(bool, QString)),
                    this, SLOT(handleConnected(bool, QString)));
-  QObject::connect(backend_, SIGNAL(logReceived(const rosgraph_msgs::LogConstPtr &)),
-                   this, SLOT(handleLog(const rosgraph_msgs::LogConstPtr &)));
+  QObject::connect(backend_, SIGNAL(batchRead(const swri_console::LogBatchPtr &)),
+                   this, SLOT(handleBatch(const swri_console::LogBatchPtr &)));
+  QObject::connect(backend_, SIGNAL(ingestStatsUpdated(const swri_console::IngestStats &)),
+                   this, SLOT(handleIngestStats(const swri_console::IngestStats &)));
   ros_thread_.start();
+
+  // The monitor is created after the backend, which initializes ROS.
+  monitor_ = new MasterMonitor();
+  monitor_->moveToThread(&monitor_thread_);
+
+  QObject::connect(&monitor_thread_, SIGNAL(started()),
+                   monitor_, SLOT(start()));
+  QObject::connect(&monitor_thread_, SIGNAL(finished()),
+                   monitor_, SLOT(deleteLater()));
+
+  QObject::connect(monitor_, SIGNAL(masterStatusChanged(bool)),
+                   backend_, SLOT(setMasterStatus(bool)));
+  monitor_thread_.start();
 }
 
 void RosSource::handleConnected(bool is_connected, QString uri)
@@ -80,11 +106,20 @@ void RosSource::handleConnected(bool is_connected, QString uri)
   Q_EMIT connected(connected_, master_uri_);
 }
 
-void RosSource::handleLog(const rosgraph_msgs::LogConstPtr &msg)
+void RosSource::handleBatch(const swri_console::LogBatchPtr &batch)
 {
-  // Planning on changing what is done here soon, so that's why we're
-  // just rebroadcasting the signal from a slot instead of linking the
-  // incoming signal to the outgoing signal.
-  Q_EMIT logReceived(msg);
-}                          
+  deliverQueued(batch);
+}
+
+void RosSource::handleIngestStats(const swri_console::IngestStats &stats)
+{
+  // The counts only grow.
+  const uint64_t total = stats.totalLost() + stats.totalShed();
+  const uint64_t last_total = ingest_stats_.totalLost() + ingest_stats_.totalShed();
+  if (total > last_total) {
+    addDrops(total - last_total);
+  }
+  ingest_stats_ = stats;
+  Q_EMIT ingestStatsUpdated(ingest_stats_);
+}
 }  // namespace swri_console
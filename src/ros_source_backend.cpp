@@ -28,15 +28,31 @@
 //
 // *****************************************************************************
 #include <swri_console/ros_source_backend.h>
+#include <swri_console/log_decoder.h>
+#include <swri_console/settings_keys.h>
+#include <algorithm>
 #include <QCoreApplication>
+#include <QMutexLocker>
+#include <QSettings>
+#include <boost/bind.hpp>
 #include <ros/ros.h>
 
 namespace swri_console
 {
-RosSourceBackend::RosSourceBackend()
+// Minimum interval (ms) between ingestStatsUpdated() signals.
+static const int STATS_INTERVAL = 500;
+
+RosSourceBackend::RosSourceBackend(const boost::shared_ptr<QAtomicInt> &backlog)
   :
-  is_connected_(false)
+  is_connected_(false),
+  backlog_(backlog),
+  stats_timer_(this)
 {
+  stats_timer_.setSingleShot(true);
+  stats_timer_.setInterval(STATS_INTERVAL);
+  QObject::connect(&stats_timer_, SIGNAL(timeout()),
+                   this, SLOT(emitIngestStats()));
+
   // We have to store this as a local variable because ros::init()
   // takes a non-const ref object.
   int argc = QCoreApplication::argc();
@@ -44,27 +60,52 @@ RosSourceBackend::RosSourceBackend()
             "profiler",
             ros::init_options::AnonymousName |
             ros::init_options::NoRosout);
-
-  startTimer(50);
 }
 
 RosSourceBackend::~RosSourceBackend()
 {
+  if (spinner_) {
+    spinner_->stop();
+  }
   if (ros::isStarted()) {
     ros::shutdown();
     ros::waitForShutdown();
   }
 }
 
+void RosSourceBackend::setMasterStatus(bool is_up)
+{
+  if (!is_connected_ && is_up) {
+    startRos();
+  } else if (is_connected_ && !is_up) {
+    stopRos();
+  }
+}
+
 void RosSourceBackend::startRos()
 {
   ros::start();
   is_connected_ = true;
 
   ros::NodeHandle nh;
-  rosout_sub_ = nh.subscribe("/rosout_agg", 10000,
-                             &RosSourceBackend::handleLog,
-                             this);
+  ros::SubscribeOptions options;
+  QSettings settings;
+  // The full message event is needed for the publisher's name.
+  if (settings.value(SettingsKeys::RAW_ROSOUT_SUBSCRIPTION, true).toBool()) {
+    options.initByFullCallbackType<const ros::MessageEvent<RawLogMessage const>&>(
+      "/rosout_agg", 10000,
+      boost::bind(&RosSourceBackend::handleRawLog, this, _1));
+  } else {
+    options.initByFullCallbackType<const ros::MessageEvent<rosgraph_msgs::Log const>&>(
+      "/rosout_agg", 10000,
+      boost::bind(&RosSourceBackend::handleLog, this, _1));
+  }
+  options.callback_queue = &callback_queue_;
+  rosout_sub_ = nh.subscribe(options);
+
+  // A single thread keeps the messages in order.
+  spinner_.reset(new ros::AsyncSpinner(1, &callback_queue_));
+  spinner_->start();
   
   std::string uri = ros::master::getURI();
   Q_EMIT connected(true, QString::fromStdString(uri));
@@ -72,26 +113,113 @@ void RosSourceBackend::startRos()
 
 void RosSourceBackend::stopRos()
 {
+  // Stop delivering messages before the subscription goes away.
+  if (spinner_) {
+    spinner_->stop();
+    spinner_.reset();
+  }
+  rosout_sub_.shutdown();
+  callback_queue_.clear();
+
   ros::shutdown();
   is_connected_ = false;
   Q_EMIT connected(false, QString());
 }
 
-void RosSourceBackend::timerEvent(QTimerEvent *event)
+void RosSourceBackend::handleLog(const ros::MessageEvent<rosgraph_msgs::Log const> &event)
 {
-  bool master_status = ros::master::check();
+  queueLog(event.getPublisherName(), event.getConstMessage(), RawLogMessageConstPtr());
+}
 
-  if (!is_connected_ && master_status) {
-    startRos();
-  } else if (is_connected_ && !master_status) {
-    stopRos();
-  } else if (is_connected_ && master_status) {
-    ros::spinOnce();
-  }    
+void RosSourceBackend::handleRawLog(const ros::MessageEvent<RawLogMessage const> &event)
+{
+  queueLog(event.getPublisherName(), rosgraph_msgs::LogConstPtr(), event.getConstMessage());
+}
+
+void RosSourceBackend::queueLog(const std::string &publisher,
+                                const rosgraph_msgs::LogConstPtr &msg,
+                                const RawLogMessageConstPtr &raw)
+{
+  PendingLog log;
+  log.msg = msg;
+  log.raw = raw;
+  log.publisher = publisher;
+
+  // Only the first message of a batch needs to wake up the backend's
+  // thread; the rest are picked up along with it.
+  QMutexLocker lock(&pending_mutex_);
+  pending_.push_back(log);
+  if (pending_.size() == 1) {
+    QMetaObject::invokeMethod(this, "decodePendingLogs", Qt::QueuedConnection);
+  }
+}
+
+void RosSourceBackend::decodePendingLogs()
+{
+  std::vector<PendingLog> pending;
+  {
+    QMutexLocker lock(&pending_mutex_);
+    pending.swap(pending_);
+  }
+
+  // Every message of the batch is judged against the same backlog, so
+  // a large batch is shed evenly rather than only at its end.
+  const size_t backlog = pending.size() + std::max(backlog_->fetchAndAddOrdered(0), 0);
+
+  LogBatchPtr batch(new std::vector<LogEntry>(pending.size()));
+  size_t count = 0;
+  bool stats_changed = false;
+  std::string node;
+  for (size_t i = 0; i < pending.size(); i++) {
+    const rosgraph_msgs::LogConstPtr &msg = pending[i].msg;
+    uint32_t seq;
+    uint32_t sec;
+    uint32_t nsec;
+    uint8_t level;
+    if (msg) {
+      seq = msg->header.seq;
+      level = msg->level;
+      node = msg->name;
+    } else {
+      const std::vector<uint8_t> &data = pending[i].raw->data;
+      if (data.empty() ||
+          !decodeLogHeader(&data[0], data.size(), &seq, &sec, &nsec, &level, &node)) {
+        qWarning("Failed to decode a log message from /rosout_agg.");
+        continue;
+      }
+    }
+
+    stats_changed |= ingest_monitor_.trackSequence(pending[i].publisher, seq);
+    if (!ingest_monitor_.keep(node, level, backlog)) {
+      stats_changed = true;
+      continue;
+    }
+
+    if (msg) {
+      convertLogMessage(*msg, &(*batch)[count]);
+    } else {
+      const std::vector<uint8_t> &data = pending[i].raw->data;
+      if (!decodeLogMessage(&data[0], data.size(), &(*batch)[count])) {
+        qWarning("Failed to decode a log message from /rosout_agg.");
+        continue;
+      }
+    }
+    count++;
+  }
+  batch->resize(count);
+
+  if (!batch->empty()) {
+    backlog_->fetchAndAddOrdered(batch->size());
+    Q_EMIT batchRead(batch);
+  }
+
+  if (stats_changed && !stats_timer_.isActive()) {
+    stats_timer_.start();
+  }
 }
 
-void RosSourceBackend::handleLog(const rosgraph_msgs::LogConstPtr &msg)
+void RosSourceBackend::emitIngestStats()
 {
-  Q_EMIT logReceived(msg);
+  Q_EMIT ingestStatsUpdated(ingest_monitor_.stats());
 }
 }  // namespace swri_console
@@ -0,0 +1,343 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/session_file.h>
+#include <swri_console/log_decoder.h>
+
+#include <string.h>
+#include <limits>
+#include <unordered_map>
+
+#include <QBuffer>
+
+namespace swri_console
+{
+static const char SESSION_MAGIC[8] = { 'S', 'W', 'R', 'I', 'L', 'O', 'G', '\0' };
+static const uint32_t SESSION_VERSION = 2;
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+// Number of records and bytes of text buffered before they are
+// written out.
+static const size_t RECORD_BLOCK_SIZE = 16384;
+static const int TEXT_BLOCK_SIZE = 4 * 1024 * 1024;
+
+static uint64_t align8(uint64_t value)
+{
+  return (value + 7) & ~static_cast<uint64_t>(7);
+}
+
+static bool writeAt(QIODevice &file, uint64_t offset, const void *data, size_t size)
+{
+  return (file.seek(offset) &&
+          file.write(static_cast<const char*>(data), size) == static_cast<qint64>(size));
+}
+
+QString writeSessionFile(const QString &filename, const std::vector<LogEntry> &entries)
+{
+  QFile file(filename);
+  if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+    return QString("Could not open file: %1").arg(file.errorString());
+  }
+
+  QString error_msg = writeSessionData(file, entries);
+  file.close();
+  return error_msg;
+}
+
+QByteArray encodeSessionData(const std::vector<LogEntry> &entries)
+{
+  QBuffer buffer;
+  buffer.open(QBuffer::WriteOnly);
+  if (!writeSessionData(buffer, entries).isEmpty()) {
+    return QByteArray();
+  }
+  return buffer.data();
+}
+
+QString decodeSessionData(const QByteArray &data, uint16_t source,
+                          std::vector<LogEntry> *entries)
+{
+  SessionFileReader reader;
+  QString error_msg = reader.open(data);
+  if (!error_msg.isEmpty()) {
+    return error_msg;
+  }
+
+  entries->reserve(entries->size() + reader.size());
+  for (size_t i = 0; i < reader.size(); i++) {
+    entries->push_back(LogEntry());
+    if (!reader.decode(i, &entries->back())) {
+      entries->pop_back();
+      continue;
+    }
+    entries->back().source = source;
+  }
+  return QString();
+}
+
+QString writeSessionData(QIODevice &file, const std::vector<LogEntry> &entries)
+{
+  if (entries.size() > std::numeric_limits<uint32_t>::max()) {
+    return "Too many messages for a session file";
+  }
+
+  const size_t count = entries.size();
+
+  SessionFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SESSION_MAGIC, sizeof(header.magic));
+  header.version = SESSION_VERSION;
+  header.byte_order = BYTE_ORDER_MARK;
+  header.entry_count = count;
+  header.records_offset = align8(sizeof(header));
+  header.text_offset = header.records_offset + count * sizeof(SessionFileRecord);
+
+  // The size of the records is known up front, so the text can be
+  // streamed out behind them while the records are being built.  Both
+  // are written in large blocks.
+  std::unordered_map<std::string, uint32_t> string_ids;
+  std::vector<const std::string*> strings;
+
+  std::vector<SessionFileRecord> records;
+  records.reserve(RECORD_BLOCK_SIZE);
+  uint64_t records_written = 0;
+
+  QByteArray text;
+  text.reserve(TEXT_BLOCK_SIZE);
+  uint64_t text_size = 0;
+  uint64_t text_written = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    const LogEntry &item = entries[i];
+
+    SessionFileRecord record;
+    memset(&record, 0, sizeof(record));
+    record.sec = item.stamp.sec;
+    record.nsec = item.stamp.nsec;
+    record.seq = item.seq;
+    record.line = item.line;
+    record.level = item.level;
+
+    const std::string *names[3] = { &item.node, &item.file, &item.function };
+    uint32_t *ids[3] = { &record.node, &record.file, &record.function };
+    for (size_t j = 0; j < 3; j++) {
+      std::pair<std::unordered_map<std::string, uint32_t>::iterator, bool> result =
+        string_ids.insert(std::make_pair(*names[j], static_cast<uint32_t>(strings.size())));
+      if (result.second) {
+        strings.push_back(&result.first->first);
+      }
+      *ids[j] = result.first->second;
+    }
+
+    QByteArray msg = item.text.join("\n").toUtf8();
+    record.text_offset = text_size;
+    record.text_length = msg.size();
+    text.append(msg);
+    text_size += msg.size();
+    records.push_back(record);
+
+    if (text.size() >= TEXT_BLOCK_SIZE) {
+      if (!writeAt(file, header.text_offset + text_written, text.constData(), text.size())) {
+        return QString("Write failed: %1").arg(file.errorString());
+      }
+      text_written += text.size();
+      text.clear();
+    }
+
+    if (records.size() >= RECORD_BLOCK_SIZE) {
+      if (!writeAt(file, header.records_offset + records_written * sizeof(SessionFileRecord),
+                   &records[0], records.size() * sizeof(SessionFileRecord))) {
+        return QString("Write failed: %1").arg(file.errorString());
+      }
+      records_written += records.size();
+      records.clear();
+    }
+  }
+
+  if (!text.isEmpty() &&
+      !writeAt(file, header.text_offset + text_written, text.constData(), text.size())) {
+    return QString("Write failed: %1").arg(file.errorString());
+  }
+  if (!records.empty() &&
+      !writeAt(file, header.records_offset + records_written * sizeof(SessionFileRecord),
+               &records[0], records.size() * sizeof(SessionFileRecord))) {
+    return QString("Write failed: %1").arg(file.errorString());
+  }
+  header.text_size = text_size;
+
+  // String table.
+  header.strings_offset = align8(header.text_offset + text_size);
+  header.string_count = strings.size();
+  std::vector<uint64_t> string_offsets(strings.size() + 1);
+  QByteArray string_data;
+  for (size_t i = 0; i < strings.size(); i++) {
+    string_offsets[i] = string_data.size();
+    string_data.append(strings[i]->data(), strings[i]->size());
+  }
+  string_offsets[strings.size()] = string_data.size();
+
+  if (!writeAt(file, header.strings_offset,
+               &string_offsets[0], string_offsets.size() * sizeof(uint64_t)) ||
+      !writeAt(file, header.strings_offset + string_offsets.size() * sizeof(uint64_t),
+               string_data.constData(), string_data.size()) ||
+      !writeAt(file, 0, &header, sizeof(header))) {
+    return QString("Write failed: %1").arg(file.errorString());
+  }
+
+  return QString();
+}
+
+SessionFileReader::SessionFileReader()
+  :
+  data_(NULL),
+  data_size_(0),
+  header_(NULL),
+  records_(NULL),
+  text_(NULL),
+  string_offsets_(NULL),
+  strings_(NULL),
+  strings_size_(0)
+{
+}
+
+SessionFileReader::~SessionFileReader()
+{
+}
+
+// Returns true if count items of item_size bytes starting at offset
+// fit in a buffer of size bytes.
+static bool fits(uint64_t offset, uint64_t count, uint64_t item_size, uint64_t size)
+{
+  return offset <= size && count <= (size - offset) / item_size;
+}
+
+QString SessionFileReader::open(const QString &filename)
+{
+  file_.setFileName(filename);
+  if (!file_.open(QFile::ReadOnly)) {
+    return QString("Could not open file: %1").arg(file_.errorString());
+  }
+
+  data_size_ = file_.size();
+  if (data_size_ < sizeof(SessionFileHeader)) {
+    return "Not a session file";
+  }
+
+  data_ = file_.map(0, data_size_);
+  if (!data_) {
+    return QString("Could not map file: %1").arg(file_.errorString());
+  }
+
+  return validate();
+}
+
+QString SessionFileReader::open(const QByteArray &data)
+{
+  buffer_ = data;
+  data_ = reinterpret_cast<const uchar*>(buffer_.constData());
+  data_size_ = buffer_.size();
+  if (data_size_ < sizeof(SessionFileHeader)) {
+    return "Not a session file";
+  }
+
+  return validate();
+}
+
+QString SessionFileReader::validate()
+{
+  const SessionFileHeader *header = reinterpret_cast<const SessionFileHeader*>(data_);
+  if (memcmp(header->magic, SESSION_MAGIC, sizeof(SESSION_MAGIC)) != 0) {
+    return "Not a session file";
+  }
+  if (header->byte_order != BYTE_ORDER_MARK) {
+    return "Session file was written on a machine with a different byte order";
+  }
+  if (header->version != SESSION_VERSION) {
+    return QString("Unsupported session file version %1").arg(header->version);
+  }
+
+  if (header->records_offset % 8 != 0 ||
+      header->strings_offset % 8 != 0 ||
+      !fits(header->records_offset, header->entry_count, sizeof(SessionFileRecord), data_size_) ||
+      !fits(header->text_offset, header->text_size, 1, data_size_) ||
+      header->string_count >= std::numeric_limits<uint32_t>::max() ||
+      !fits(header->strings_offset, header->string_count + 1, sizeof(uint64_t), data_size_)) {
+    return "Session file is corrupt";
+  }
+
+  header_ = header;
+  records_ = reinterpret_cast<const SessionFileRecord*>(data_ + header->records_offset);
+  text_ = reinterpret_cast<const char*>(data_ + header->text_offset);
+  string_offsets_ = reinterpret_cast<const uint64_t*>(data_ + header->strings_offset);
+  const uint64_t strings_start = header->strings_offset + (header->string_count + 1) * sizeof(uint64_t);
+  strings_ = reinterpret_cast<const char*>(data_ + strings_start);
+  strings_size_ = data_size_ - strings_start;
+
+  // Only the sections' bounds are checked here, so opening a file
+  // does not touch its records.  They are checked by decode().
+  return QString();
+}
+
+bool SessionFileReader::getString(uint32_t id, std::string *str) const
+{
+  if (id >= header_->string_count) {
+    return false;
+  }
+  const uint64_t begin = string_offsets_[id];
+  const uint64_t end = string_offsets_[id + 1];
+  if (begin > end || end > strings_size_) {
+    return false;
+  }
+  str->assign(strings_ + begin, end - begin);
+  return true;
+}
+
+bool SessionFileReader::decode(size_t i, LogEntry *entry) const
+{
+  if (!header_ || i >= header_->entry_count) {
+    return false;
+  }
+
+  const SessionFileRecord &record = records_[i];
+  if (!isValidNsec(record.nsec) ||
+      !fits(record.text_offset, record.text_length, 1, header_->text_size) ||
+      !getString(record.node, &entry->node) ||
+      !getString(record.file, &entry->file) ||
+      !getString(record.function, &entry->function)) {
+    return false;
+  }
+
+  entry->stamp = ros::Time(record.sec, record.nsec);
+  entry->seq = record.seq;
+  entry->line = record.line;
+  entry->level = record.level;
+  entry->text = QString::fromUtf8(text_ + record.text_offset, record.text_length).split('\n');
+  return true;
+}
+}  // namespace swri_console
@@ -0,0 +1,140 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/session_source.h>
+#include <swri_console/session_file.h>
+
+#include <algorithm>
+
+#include <QFileInfo>
+#include <QThread>
+#include <QtConcurrentRun>
+
+namespace swri_console
+{
+// Number of records decoded by each task.
+static const size_t CHUNK_SIZE = 50000;
+
+// Interval (ms) at which finished chunks are collected.
+static const int POLL_INTERVAL = 10;
+
+SessionSource::SessionSource(const QString &filename, uint16_t source)
+  :
+  filename_(filename),
+  source_(source),
+  reader_(new SessionFileReader()),
+  next_record_(0),
+  timer_id_(0)
+{
+}
+
+SessionSource::~SessionSource()
+{
+  for (size_t i = 0; i < chunks_.size(); i++) {
+    chunks_[i].waitForFinished();
+  }
+}
+
+void SessionSource::start()
+{
+  if (timer_id_) {
+    return;
+  }
+
+  // Mapping the file and checking the header is cheap, so it is done
+  // right away.  The decoding happens on the thread pool.
+  QString error_msg = reader_->open(filename_);
+  if (!error_msg.isEmpty()) {
+    finish(false, error_msg);
+    return;
+  }
+  addBytes(QFileInfo(filename_).size());
+
+  startChunks();
+  timer_id_ = startTimer(POLL_INTERVAL);
+}
+
+void SessionSource::startChunks()
+{
+  // Only a few chunks are kept in flight, so that decoded entries do
+  // not pile up faster than the database takes them.
+  const size_t max_in_flight = 2 * std::max(QThread::idealThreadCount(), 1);
+  while (next_record_ < reader_->size() && chunks_.size() < max_in_flight) {
+    size_t end = std::min(next_record_ + CHUNK_SIZE, reader_->size());
+    chunks_.push_back(QtConcurrent::run(&SessionSource::decodeChunk,
+                                        reader_, next_record_, end, source_));
+    next_record_ = end;
+  }
+}
+
+void SessionSource::timerEvent(QTimerEvent *)
+{
+  while (!chunks_.empty() && chunks_.front().isFinished()) {
+    LogBatchPtr batch = chunks_.front().result();
+    chunks_.pop_front();
+    deliver(batch);
+  }
+
+  startChunks();
+
+  if (chunks_.empty()) {
+    killTimer(timer_id_);
+    finish(true);
+  }
+}
+
+void SessionSource::halt()
+{
+  // The chunks in flight are left to finish and be discarded.
+  next_record_ = reader_->size();
+}
+
+LogBatchPtr SessionSource::decodeChunk(ReaderPtr reader, size_t begin, size_t end, uint16_t source)
+{
+  LogBatchPtr batch(new std::vector<LogEntry>());
+  batch->reserve(end - begin);
+
+  size_t invalid = 0;
+  for (size_t i = begin; i < end; i++) {
+    batch->push_back(LogEntry());
+    if (!reader->decode(i, &batch->back())) {
+      batch->pop_back();
+      invalid++;
+      continue;
+    }
+    batch->back().source = source;
+  }
+
+  if (invalid) {
+    qWarning("Skipped %lu corrupt records in session file.",
+             static_cast<unsigned long>(invalid));
+  }
+  return batch;
+}
+}  // namespace swri_console
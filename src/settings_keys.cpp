@@ -51,4 +51,10 @@ namespace swri_console
   const QString SettingsKeys::FATAL_COLOR = "Colors/FatalColor";
   const QString SettingsKeys::COLORIZE_LOGS = "Colors/ColorizeLogs";
   const QString SettingsKeys::ALTERNATE_LOG_ROW_COLORS = "Logs/AlternateRowColors";
+  const QString SettingsKeys::COLLAPSE_MULTILINE = "Logs/CollapseMultiline";
+  const QString SettingsKeys::MAX_LINE_LENGTH = "Logs/MaxLineLength";
+  const QString SettingsKeys::PREVIEW_LARGE_BAGS = "Bags/PreviewLargeBags";
+  const QString SettingsKeys::RAW_ROSOUT_SUBSCRIPTION = "Ros/RawRosoutSubscription";
+  const QString SettingsKeys::REMOTE_MASTERS = "Ros/RemoteMasters";
+  const QString SettingsKeys::SYSLOG_ADDRESSES = "Syslog/Addresses";
 }
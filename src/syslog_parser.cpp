@@ -0,0 +1,388 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#include <swri_console/syslog_parser.h>
+#include <swri_console/scan_util.h>
+
+#include <string.h>
+#include <time.h>
+
+#include <limits>
+
+#include <rosgraph_msgs/Log.h>
+
+namespace swri_console
+{
+namespace
+{
+using namespace scan_util;
+
+// The priority of messages that do not have one: user.notice.
+const int DEFAULT_PRIORITY = 13;
+
+const char* const FACILITY_NAMES[] = {
+  "kern", "user", "mail", "daemon", "auth", "syslog", "lpr", "news",
+  "uucp", "cron", "authpriv", "ftp", "ntp", "audit", "alert", "clock",
+  "local0", "local1", "local2", "local3", "local4", "local5", "local6", "local7"
+};
+
+const char* const MONTH_NAMES[] = {
+  "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+  "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+};
+
+// The fields of a message.  Strings point into the datagram.
+struct MessageHeader
+{
+  ros::Time stamp;
+  const char *host;
+  size_t host_len;
+  const char *app;
+  size_t app_len;
+  const char *pid;
+  size_t pid_len;
+  const char *msg;
+  size_t msg_len;
+
+  MessageHeader()
+    : host(NULL), host_len(0), app(NULL), app_len(0),
+      pid(NULL), pid_len(0), msg(NULL), msg_len(0) {}
+};
+
+// Parses ".<fraction>" at p, if there is one, as nanoseconds.
+bool parseFraction(const char *&p, const char *end, uint64_t *nsec)
+{
+  *nsec = 0;
+  if (p == end || *p != '.') {
+    return true;
+  }
+  p++;
+  return parseNanoseconds(p, end, nsec);
+}
+
+// Parses "<PRI>" at p, advancing p past it if it is valid.
+bool parsePriority(const char *&p, const char *end, int *priority)
+{
+  const char *q = p;
+  uint64_t value;
+  if (!expect(q, end, "<") || !parseNumber(q, end, 3, &value) ||
+      value > 191 || !expect(q, end, ">")) {
+    return false;
+  }
+  p = q;
+  *priority = value;
+  return true;
+}
+
+// Reads a field of an RFC 5424 header and the space after it.  The
+// field is empty if it is "-".
+bool parseField(const char *&p, const char *end, const char **field, size_t *len)
+{
+  const char *start = p;
+  p = find(p, end, ' ');
+  if (p == start || !expect(p, end, " ")) {
+    return false;
+  }
+  *field = start;
+  *len = p - 1 - start;
+  if (*len == 1 && *start == '-') {
+    *len = 0;
+  }
+  return true;
+}
+
+// 2003-10-11T22:14:15.003Z or 2003-08-24T05:14:15.000003-07:00
+bool parseRfc3339(const char *p, const char *end, ros::Time *stamp)
+{
+  uint64_t year, month, day, hour, minute, second, nsec;
+  if (!parseNumber(p, end, 4, &year) || !expect(p, end, "-") ||
+      !parseNumber(p, end, 2, &month) || !expect(p, end, "-") ||
+      !parseNumber(p, end, 2, &day) || !expect(p, end, "T") ||
+      !parseNumber(p, end, 2, &hour) || !expect(p, end, ":") ||
+      !parseNumber(p, end, 2, &minute) || !expect(p, end, ":") ||
+      !parseNumber(p, end, 2, &second) || !parseFraction(p, end, &nsec)) {
+    return false;
+  }
+
+  int64_t offset = 0;
+  if (p < end && (*p == '+' || *p == '-')) {
+    const int64_t sign = (*p == '-') ? -1 : 1;
+    p++;
+    uint64_t offset_hour, offset_minute;
+    if (!parseNumber(p, end, 2, &offset_hour) || !expect(p, end, ":") ||
+        !parseNumber(p, end, 2, &offset_minute)) {
+      return false;
+    }
+    offset = sign * static_cast<int64_t>(offset_hour * 3600 + offset_minute * 60);
+  } else if (!expect(p, end, "Z")) {
+    return false;
+  }
+  if (p != end || month < 1 || month > 12 || day < 1 || day > 31) {
+    return false;
+  }
+
+  struct tm tm;
+  memset(&tm, 0, sizeof(tm));
+  tm.tm_year = year - 1900;
+  tm.tm_mon = month - 1;
+  tm.tm_mday = day;
+  tm.tm_hour = hour;
+  tm.tm_min = minute;
+  tm.tm_sec = second;
+  const int64_t t = static_cast<int64_t>(timegm(&tm)) - offset;
+  if (t < 0 || t > std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  *stamp = ros::Time(t, nsec);
+  return true;
+}
+
+// 1 2003-10-11T22:14:15.003Z host app 1234 ID47 [id@1 a="b"] message
+// (after the priority)
+bool parseRfc5424(const char *p, const char *end, MessageHeader *header)
+{
+  const char *timestamp;
+  size_t timestamp_len;
+  const char *msgid;
+  size_t msgid_len;
+  if (!expect(p, end, "1 ") ||
+      !parseField(p, end, &timestamp, &timestamp_len) ||
+      !parseField(p, end, &header->host, &header->host_len) ||
+      !parseField(p, end, &header->app, &header->app_len) ||
+      !parseField(p, end, &header->pid, &header->pid_len) ||
+      !parseField(p, end, &msgid, &msgid_len)) {
+    return false;
+  }
+  if (timestamp_len && !parseRfc3339(timestamp, timestamp + timestamp_len, &header->stamp)) {
+    return false;
+  }
+
+  // The structured data is skipped.  Its elements are in brackets,
+  // and the quoted parameter values may contain escaped brackets and
+  // quotes.
+  if (!expect(p, end, "-")) {
+    if (p == end || *p != '[') {
+      return false;
+    }
+    while (p < end && *p == '[') {
+      bool quoted = false;
+      for (p++; p < end; p++) {
+        if (quoted && *p == '\\') {
+          p++;
+          if (p == end) {
+            break;
+          }
+        } else if (*p == '"') {
+          quoted = !quoted;
+        } else if (!quoted && *p == ']') {
+          break;
+        }
+      }
+      if (!expect(p, end, "]")) {
+        return false;
+      }
+    }
+  }
+  expect(p, end, " ");
+  // The message may be marked as UTF-8.
+  expect(p, end, "\xEF\xBB\xBF");
+
+  header->msg = p;
+  header->msg_len = end - p;
+  return true;
+}
+
+// Oct 11 22:14:15 host app[1234]: message
+// (after the priority)
+bool parseRfc3164(const char *p, const char *end, const ros::Time &received,
+                  MessageHeader *header)
+{
+  int month = -1;
+  for (int i = 0; i < 12 && month < 0; i++) {
+    if (expect(p, end, MONTH_NAMES[i])) {
+      month = i;
+    }
+  }
+  if (month < 0 || !expect(p, end, " ")) {
+    return false;
+  }
+  // Days before the 10th are padded with a space.
+  expect(p, end, " ");
+
+  uint64_t day, hour, minute, second, nsec;
+  if (!parseNumber(p, end, 2, &day) || !expect(p, end, " ") ||
+      !parseNumber(p, end, 2, &hour) || !expect(p, end, ":") ||
+      !parseNumber(p, end, 2, &minute) || !expect(p, end, ":") ||
+      !parseNumber(p, end, 2, &second) || !parseFraction(p, end, &nsec) ||
+      !expect(p, end, " ")) {
+    return false;
+  }
+
+  // The timestamp is in local time and without a year.  It is taken
+  // to be the most recent one that is not in the future, give or take
+  // a day of clock skew, so messages sent on New Year's Eve and
+  // received after midnight keep their year.
+  const time_t now = received.sec;
+  struct tm now_tm;
+  localtime_r(&now, &now_tm);
+  time_t t = -1;
+  for (int years_back = 0; years_back < 2; years_back++) {
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_year = now_tm.tm_year - years_back;
+    tm.tm_mon = month;
+    tm.tm_mday = day;
+    tm.tm_hour = hour;
+    tm.tm_min = minute;
+    tm.tm_sec = second;
+    tm.tm_isdst = -1;
+    t = mktime(&tm);
+    if (t <= now + 24 * 3600) {
+      break;
+    }
+  }
+  if (t < 0 || t > std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  header->stamp = ros::Time(t, nsec);
+
+  // Local senders leave out the hostname, so the first word is only
+  // the hostname if it doesn't look like a tag ("app:" or
+  // "app[1234]:").
+  const char *word_end = find(p, end, ' ');
+  if (word_end != p && *(word_end - 1) != ':' && find(p, word_end, '[') == word_end) {
+    header->host = p;
+    header->host_len = word_end - p;
+    p = word_end;
+    expect(p, end, " ");
+  }
+
+  const char *tag_end = p;
+  while (tag_end < end && *tag_end != ':' && *tag_end != '[' && *tag_end != ' ') {
+    tag_end++;
+  }
+  if (tag_end != end && tag_end != p && *tag_end != ' ') {
+    header->app = p;
+    header->app_len = tag_end - p;
+    p = tag_end;
+    if (expect(p, end, "[")) {
+      header->pid = p;
+      p = find(p, end, ']');
+      header->pid_len = p - header->pid;
+      expect(p, end, "]");
+    }
+    expect(p, end, ":");
+    expect(p, end, " ");
+  }
+
+  header->msg = p;
+  header->msg_len = end - p;
+  return true;
+}
+}  // namespace
+
+uint8_t syslogSeverityLevel(int severity)
+{
+  switch (severity) {
+    case 0:  // emergency
+    case 1:  // alert
+    case 2:  // critical
+      return rosgraph_msgs::Log::FATAL;
+    case 3:  // error
+      return rosgraph_msgs::Log::ERROR;
+    case 4:  // warning
+      return rosgraph_msgs::Log::WARN;
+    case 5:  // notice
+    case 6:  // informational
+      return rosgraph_msgs::Log::INFO;
+    default:  // debug
+      return rosgraph_msgs::Log::DEBUG;
+  }
+}
+
+const char* syslogFacilityName(int facility)
+{
+  if (facility < 0 || facility >= static_cast<int>(sizeof(FACILITY_NAMES) / sizeof(FACILITY_NAMES[0]))) {
+    return "unknown";
+  }
+  return FACILITY_NAMES[facility];
+}
+
+void parseSyslogMessage(const char *data, size_t size,
+                        const ros::Time &received, LogEntry *entry)
+{
+  const char *p = data;
+  const char *end = data + size;
+  // Trailing newlines and NULs are framing rather than part of the
+  // message.
+  while (end > p && (end[-1] == '\n' || end[-1] == '\r' || end[-1] == '\0')) {
+    end--;
+  }
+
+  int priority = DEFAULT_PRIORITY;
+  MessageHeader header;
+  if (parsePriority(p, end, &priority)) {
+    header.stamp = received;
+    if (!parseRfc5424(p, end, &header)) {
+      header = MessageHeader();
+      if (!parseRfc3164(p, end, received, &header)) {
+        header = MessageHeader();
+      }
+    }
+  }
+  if (!header.msg) {
+    // Not recognized; the whole message after the priority is the
+    // text.
+    header.stamp = received;
+    header.msg = p;
+    header.msg_len = end - p;
+  }
+
+  const char *facility = syslogFacilityName(priority >> 3);
+
+  entry->stamp = header.stamp;
+  entry->level = syslogSeverityLevel(priority & 7);
+  entry->node.clear();
+  if (header.host_len) {
+    entry->node.assign(header.host, header.host_len);
+    entry->node.push_back(':');
+  }
+  entry->node.push_back('/');
+  if (header.app_len) {
+    entry->node.append(header.app, header.app_len);
+  } else {
+    entry->node.append(facility);
+  }
+  entry->file = facility;
+  entry->function.assign(header.pid ? header.pid : "", header.pid_len);
+  entry->line = 0;
+  entry->text = QString::fromUtf8(header.msg, header.msg_len).split('\n');
+}
+}  // namespace swri_console
@@ -0,0 +1,176 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#include <swri_console/syslog_source.h>
+#include <swri_console/syslog_source_backend.h>
+
+#include <errno.h>
+#include <netdb.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace swri_console
+{
+// Receive buffer requested for the socket, to ride out bursts while
+// the backend is busy.  The kernel caps it at net.core.rmem_max.
+static const int RECEIVE_BUFFER_SIZE = 16 * 1024 * 1024;
+
+SyslogSource::SyslogSource(const QString &address, uint16_t source, QObject *parent)
+  :
+  LogSource(parent),
+  address_(address),
+  source_(source),
+  backend_(NULL)
+{
+  // The rate is shown in the status text.
+  QObject::connect(this, SIGNAL(statsUpdated(const swri_console::LogSourceStats &)),
+                   this, SIGNAL(statusChanged()));
+}
+
+SyslogSource::~SyslogSource()
+{
+  halt();
+  thread_.quit();
+  thread_.wait();
+}
+
+void SyslogSource::start()
+{
+  if (backend_ || isFinished()) {
+    return;
+  }
+
+  // The socket is opened here so that errors are reported right away.
+  QString error_msg;
+  int fd = openSocket(&error_msg);
+  if (fd < 0) {
+    finish(false, error_msg);
+    return;
+  }
+
+  backend_ = new SyslogSourceBackend(fd, source_, backlog());
+  backend_->moveToThread(&thread_);
+
+  QObject::connect(&thread_, SIGNAL(started()),
+                   backend_, SLOT(start()));
+  QObject::connect(&thread_, SIGNAL(finished()),
+                   backend_, SLOT(deleteLater()));
+
+  QObject::connect(backend_, SIGNAL(batchRead(const swri_console::LogBatchPtr &, size_t, size_t)),
+                   this, SLOT(handleBatch(const swri_console::LogBatchPtr &, size_t, size_t)));
+  thread_.start();
+}
+
+void SyslogSource::halt()
+{
+  if (backend_ && thread_.isRunning()) {
+    // Close the socket before the thread goes away.
+    QMetaObject::invokeMethod(backend_, "stop", Qt::BlockingQueuedConnection);
+  }
+}
+
+QString SyslogSource::statusText() const
+{
+  if (isFinished()) {
+    return tr("Syslog %1: closed").arg(address_);
+  }
+
+  QString text = tr("Syslog %1: %2 msg/s").arg(address_).arg(stats().rate, 0, 'f', 0);
+  if (stats().drop_count) {
+    text += tr(", %1 dropped").arg(stats().drop_count);
+  }
+  return text;
+}
+
+void SyslogSource::handleBatch(const swri_console::LogBatchPtr &batch,
+                               size_t bytes, size_t dropped)
+{
+  addDrops(dropped);
+  deliverQueued(batch, bytes);
+}
+
+int SyslogSource::openSocket(QString *error_msg) const
+{
+  QString host;
+  QString port = address_;
+  int colon = address_.lastIndexOf(':');
+  if (colon >= 0) {
+    host = address_.left(colon);
+    port = address_.mid(colon + 1);
+  }
+  if (host.startsWith('[') && host.endsWith(']')) {
+    host = host.mid(1, host.size() - 2);
+  }
+
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_flags = AI_PASSIVE;
+
+  const QByteArray host_bytes = host.toLocal8Bit();
+  const QByteArray port_bytes = port.toLocal8Bit();
+  struct addrinfo *addresses = NULL;
+  int result = getaddrinfo(host.isEmpty() ? NULL : host_bytes.constData(),
+                           port_bytes.constData(), &hints, &addresses);
+  if (result != 0) {
+    *error_msg = QString("Could not resolve %1: %2").arg(address_).arg(gai_strerror(result));
+    return -1;
+  }
+
+  int fd = -1;
+  for (struct addrinfo *ai = addresses; ai != NULL && fd < 0; ai = ai->ai_next) {
+    fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+    if (fd < 0) {
+      *error_msg = QString("Could not open a socket: %1").arg(strerror(errno));
+      continue;
+    }
+
+    int buffer_size = RECEIVE_BUFFER_SIZE;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+#ifdef SO_RXQ_OVFL
+    // Has the kernel count the datagrams it drops (see
+    // SyslogSourceBackend).
+    int enable = 1;
+    setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable));
+#endif
+
+    if (bind(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+      *error_msg = QString("Could not listen on %1: %2").arg(address_).arg(strerror(errno));
+      close(fd);
+      fd = -1;
+    }
+  }
+  freeaddrinfo(addresses);
+  return fd;
+}
+}  // namespace swri_console
@@ -0,0 +1,204 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+
+#include <swri_console/syslog_source_backend.h>
+#include <swri_console/log_source.h>
+#include <swri_console/syslog_parser.h>
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include <QSocketNotifier>
+#include <QTimerEvent>
+#include <ros/time.h>
+
+namespace swri_console
+{
+// Datagrams taken per recvmmsg() call, and the space for each.  RFC
+// 5426 asks receivers to take messages of at least 2048 bytes; longer
+// ones are truncated.
+static const size_t DATAGRAMS_PER_CALL = 256;
+static const size_t DATAGRAM_SIZE = 8192;
+
+// Entries after which a batch is delivered even though the socket
+// still has data, so the thread gets back to its event loop.
+static const size_t MAX_BATCH_SIZE = 8192;
+
+// Interval (ms) at which reading is retried while the backlog is
+// full.
+static const int RESUME_INTERVAL = 10;
+
+SyslogSourceBackend::SyslogSourceBackend(int fd, uint16_t source,
+                                         const boost::shared_ptr<QAtomicInt> &backlog)
+  :
+  fd_(fd),
+  source_(source),
+  backlog_(backlog),
+  notifier_(NULL),
+  resume_timer_id_(0),
+  data_(DATAGRAMS_PER_CALL * DATAGRAM_SIZE),
+  control_(DATAGRAMS_PER_CALL * CMSG_SPACE(sizeof(uint32_t))),
+  iovecs_(DATAGRAMS_PER_CALL),
+  headers_(DATAGRAMS_PER_CALL),
+  drop_counter_(0)
+{
+  for (size_t i = 0; i < DATAGRAMS_PER_CALL; i++) {
+    iovecs_[i].iov_base = &data_[i * DATAGRAM_SIZE];
+    iovecs_[i].iov_len = DATAGRAM_SIZE;
+
+    memset(&headers_[i], 0, sizeof(headers_[i]));
+    headers_[i].msg_hdr.msg_iov = &iovecs_[i];
+    headers_[i].msg_hdr.msg_iovlen = 1;
+  }
+}
+
+SyslogSourceBackend::~SyslogSourceBackend()
+{
+  stop();
+}
+
+void SyslogSourceBackend::start()
+{
+  if (notifier_ || fd_ < 0) {
+    return;
+  }
+
+  notifier_ = new QSocketNotifier(fd_, QSocketNotifier::Read, this);
+  QObject::connect(notifier_, SIGNAL(activated(int)),
+                   this, SLOT(readDatagrams()));
+}
+
+void SyslogSourceBackend::stop()
+{
+  if (resume_timer_id_) {
+    killTimer(resume_timer_id_);
+    resume_timer_id_ = 0;
+  }
+  delete notifier_;
+  notifier_ = NULL;
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+void SyslogSourceBackend::readDatagrams()
+{
+  LogBatchPtr batch(new std::vector<LogEntry>());
+  size_t bytes = 0;
+  size_t dropped = 0;
+
+  while (fd_ >= 0 && batch->size() < MAX_BATCH_SIZE) {
+    // The kernel overwrites the control lengths and flags.
+    const size_t control_size = CMSG_SPACE(sizeof(uint32_t));
+    for (size_t i = 0; i < DATAGRAMS_PER_CALL; i++) {
+      headers_[i].msg_hdr.msg_control = &control_[i * control_size];
+      headers_[i].msg_hdr.msg_controllen = control_size;
+      headers_[i].msg_hdr.msg_flags = 0;
+    }
+
+    int count = recvmmsg(fd_, &headers_[0], DATAGRAMS_PER_CALL, MSG_DONTWAIT, NULL);
+    if (count <= 0) {
+      if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        qWarning("Failed to receive syslog messages: %s", strerror(errno));
+      }
+      break;
+    }
+
+    // One clock reading serves the whole call, since the datagrams
+    // arrived within a very short time of each other.
+    const ros::WallTime wall_time = ros::WallTime::now();
+    const ros::Time received(wall_time.sec, wall_time.nsec);
+
+    for (int i = 0; i < count; i++) {
+      const size_t size = std::min(static_cast<size_t>(headers_[i].msg_len), DATAGRAM_SIZE);
+      bytes += size;
+      dropped += takeDrops(&headers_[i].msg_hdr);
+
+      batch->push_back(LogEntry());
+      parseSyslogMessage(&data_[i * DATAGRAM_SIZE], size, received, &batch->back());
+      batch->back().source = source_;
+    }
+
+    if (static_cast<size_t>(count) < DATAGRAMS_PER_CALL) {
+      // Drained.  The notifier fires again for anything that arrives
+      // from now on.
+      break;
+    }
+  }
+
+  if (!batch->empty() || dropped) {
+    backlog_->fetchAndAddOrdered(batch->size());
+    Q_EMIT batchRead(batch, bytes, dropped);
+  }
+
+  if (notifier_ && backlog_->fetchAndAddOrdered(0) >= LogSource::MAX_BACKLOG) {
+    notifier_->setEnabled(false);
+    resume_timer_id_ = startTimer(RESUME_INTERVAL);
+  }
+}
+
+void SyslogSourceBackend::timerEvent(QTimerEvent *event)
+{
+  if (event->timerId() != resume_timer_id_ ||
+      backlog_->fetchAndAddOrdered(0) >= LogSource::MAX_BACKLOG) {
+    return;
+  }
+
+  killTimer(resume_timer_id_);
+  resume_timer_id_ = 0;
+  notifier_->setEnabled(true);
+}
+
+// Returns the number of datagrams the kernel dropped before this one
+// since the last call.  The kernel attaches its running count to
+// every datagram once SO_RXQ_OVFL is set and something was dropped.
+size_t SyslogSourceBackend::takeDrops(struct msghdr *header)
+{
+#ifdef SO_RXQ_OVFL
+  for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(header);
+       cmsg != NULL;
+       cmsg = CMSG_NXTHDR(header, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+      uint32_t counter;
+      memcpy(&counter, CMSG_DATA(cmsg), sizeof(counter));
+      // The counter wraps around.
+      const uint32_t dropped = counter - drop_counter_;
+      drop_counter_ = counter;
+      return dropped;
+    }
+  }
+#endif
+  return 0;
+}
+}  // namespace swri_console
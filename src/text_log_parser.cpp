@@ -0,0 +1,422 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/text_log_parser.h>
+#include <swri_console/scan_util.h>
+
+#include <string.h>
+#include <time.h>
+
+#include <limits>
+
+#include <rosgraph_msgs/Log.h>
+
+namespace swri_console
+{
+namespace
+{
+using namespace scan_util;
+
+// The fields of a record's first line.  Strings point into the
+// buffer being parsed.
+struct RecordHeader
+{
+  ros::Time stamp;
+  uint8_t level;
+  const char *node;
+  size_t node_len;
+  const char *file;
+  size_t file_len;
+  const char *function;
+  size_t function_len;
+  uint32_t line;
+  const char *msg;
+  size_t msg_len;
+
+  RecordHeader()
+    : level(0), node(NULL), node_len(0), file(NULL), file_len(0),
+      function(NULL), function_len(0), line(0), msg(NULL), msg_len(0) {}
+};
+
+uint8_t parseLevel(const char *str, size_t len)
+{
+  switch (len) {
+    case 4:
+      if (memcmp(str, "INFO", 4) == 0) {
+        return rosgraph_msgs::Log::INFO;
+      } else if (memcmp(str, "WARN", 4) == 0) {
+        return rosgraph_msgs::Log::WARN;
+      }
+      break;
+    case 5:
+      if (memcmp(str, "DEBUG", 5) == 0) {
+        return rosgraph_msgs::Log::DEBUG;
+      } else if (memcmp(str, "ERROR", 5) == 0) {
+        return rosgraph_msgs::Log::ERROR;
+      } else if (memcmp(str, "FATAL", 5) == 0) {
+        return rosgraph_msgs::Log::FATAL;
+      }
+      break;
+    case 7:
+      if (memcmp(str, "WARNING", 7) == 0) {
+        return rosgraph_msgs::Log::WARN;
+      }
+      break;
+    case 8:
+      if (memcmp(str, "CRITICAL", 8) == 0) {
+        return rosgraph_msgs::Log::FATAL;
+      }
+      break;
+  }
+  return 0;
+}
+
+// Parses "<sec>.<fraction>" at p, advancing p past it.  Fails if sec
+// does not fit in a ros::Time.
+bool parseStamp(const char *&p, const char *end, ros::Time *stamp)
+{
+  uint64_t sec;
+  if (!parseNumber(p, end, 10, &sec) ||
+      sec > std::numeric_limits<uint32_t>::max() ||
+      p == end || *p != '.') {
+    return false;
+  }
+  p++;
+
+  uint64_t nsec;
+  if (!parseNanoseconds(p, end, &nsec)) {
+    return false;
+  }
+
+  *stamp = ros::Time(sec, nsec);
+  return true;
+}
+
+// 1530000000.123456789 INFO /node [file.cpp:12(function)] [topics: /rosout] message
+bool parseRosoutLine(const char *p, const char *end, RecordHeader *header)
+{
+  if (!parseStamp(p, end, &header->stamp) || !expect(p, end, " ")) {
+    return false;
+  }
+
+  const char *level = p;
+  p = find(p, end, ' ');
+  header->level = parseLevel(level, p - level);
+  if (!header->level || !expect(p, end, " ")) {
+    return false;
+  }
+
+  header->node = p;
+  p = find(p, end, ' ');
+  header->node_len = p - header->node;
+  if (!expect(p, end, " [")) {
+    return false;
+  }
+
+  // The location ends at the first ")] [topics: ".  Everything is
+  // optional from here on, since the message is what matters most.
+  const char *location = p;
+  const char *topics = NULL;
+  for (const char *q = find(p, end, ')'); q != end; q = find(q + 1, end, ')')) {
+    const char *r = q;
+    if (expect(r, end, ")] [topics: ")) {
+      topics = r;
+      break;
+    }
+  }
+
+  if (topics) {
+    // The location is "file:line(function)".  Look for the first
+    // ":<digits>(", since both file and function may contain colons
+    // and parentheses.
+    const char *location_end = topics - 12;
+    for (const char *colon = find(location, location_end, ':');
+         colon != location_end;
+         colon = find(colon + 1, location_end, ':')) {
+      const char *q = colon + 1;
+      uint64_t value;
+      if (parseNumber(q, location_end, 10, &value) && expect(q, location_end, "(")) {
+        header->file = location;
+        header->file_len = colon - location;
+        header->line = value;
+        header->function = q;
+        header->function_len = location_end - q;
+        break;
+      }
+    }
+
+    p = topics;
+    const char *close = find(p, end, ']');
+    p = close;
+    if (!expect(p, end, "]")) {
+      p = end;
+    }
+    expect(p, end, " ");
+  } else {
+    // Keep the rest of the line, including the "[".
+    p = location - 1;
+  }
+
+  header->msg = p;
+  header->msg_len = end - p;
+  return true;
+}
+
+// [rosout][INFO] 2018-06-26 12:00:00,123: message
+bool parseRospyLine(const char *p, const char *end, RecordHeader *header)
+{
+  if (!expect(p, end, "[")) {
+    return false;
+  }
+  p = find(p, end, ']');
+  if (!expect(p, end, "][")) {
+    return false;
+  }
+
+  const char *level = p;
+  p = find(p, end, ']');
+  header->level = parseLevel(level, p - level);
+  if (!header->level || !expect(p, end, "] ")) {
+    return false;
+  }
+
+  uint64_t year, month, day, hour, minute, second, msec;
+  if (!parseNumber(p, end, 4, &year) || !expect(p, end, "-") ||
+      !parseNumber(p, end, 2, &month) || !expect(p, end, "-") ||
+      !parseNumber(p, end, 2, &day) || !expect(p, end, " ") ||
+      !parseNumber(p, end, 2, &hour) || !expect(p, end, ":") ||
+      !parseNumber(p, end, 2, &minute) || !expect(p, end, ":") ||
+      !parseNumber(p, end, 2, &second) || !expect(p, end, ",") ||
+      !parseNumber(p, end, 3, &msec) || !expect(p, end, ":")) {
+    return false;
+  }
+  expect(p, end, " ");
+
+  // The python logging module writes local time.
+  struct tm tm;
+  memset(&tm, 0, sizeof(tm));
+  tm.tm_year = year - 1900;
+  tm.tm_mon = month - 1;
+  tm.tm_mday = day;
+  tm.tm_hour = hour;
+  tm.tm_min = minute;
+  tm.tm_sec = second;
+  tm.tm_isdst = -1;
+  time_t t = mktime(&tm);
+  if (t < 0 || static_cast<uint64_t>(t) > std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  header->stamp = ros::Time(t, msec * 1000000);
+
+  header->msg = p;
+  header->msg_len = end - p;
+  return true;
+}
+
+// [ INFO] [1530000000.123456789]: message
+bool parseRosconsoleLine(const char *p, const char *end, RecordHeader *header)
+{
+  if (!expect(p, end, "[")) {
+    return false;
+  }
+  while (p < end && *p == ' ') {
+    p++;
+  }
+
+  const char *level = p;
+  p = find(p, end, ']');
+  header->level = parseLevel(level, p - level);
+  if (!header->level || !expect(p, end, "] [") || !parseStamp(p, end, &header->stamp)) {
+    return false;
+  }
+
+  // With simulated time, the wall time follows the stamp.
+  p = find(p, end, ']');
+  if (!expect(p, end, "]:")) {
+    return false;
+  }
+  expect(p, end, " ");
+
+  header->msg = p;
+  header->msg_len = end - p;
+  return true;
+}
+
+bool parseRecordHeader(const char *begin, const char *end, RecordHeader *header)
+{
+  if (begin == end) {
+    return false;
+  }
+  if (isDigit(*begin)) {
+    return parseRosoutLine(begin, end, header);
+  }
+  if (*begin == '[') {
+    *header = RecordHeader();
+    if (parseRosconsoleLine(begin, end, header)) {
+      return true;
+    }
+    *header = RecordHeader();
+    return parseRospyLine(begin, end, header);
+  }
+  return false;
+}
+
+// Returns the end of the line starting at p, excluding the newline
+// and any carriage return.
+const char *lineEnd(const char *p, const char *end, const char **next)
+{
+  const char *newline = find(p, end, '\n');
+  *next = newline == end ? end : newline + 1;
+  if (newline != p && *(newline - 1) == '\r') {
+    newline--;
+  }
+  return newline;
+}
+}  // namespace
+
+size_t findTextLogRecord(const char *data, size_t size, size_t pos)
+{
+  const char *end = data + size;
+  const char *p = data + pos;
+
+  // Move to the start of a line.
+  if (pos > 0 && pos < size && data[pos - 1] != '\n') {
+    p = find(p, end, '\n');
+    if (p != end) {
+      p++;
+    }
+  }
+
+  while (p < end) {
+    const char *next;
+    const char *line_end = lineEnd(p, end, &next);
+    RecordHeader header;
+    if (parseRecordHeader(p, line_end, &header)) {
+      return p - data;
+    }
+    p = next;
+  }
+  return size;
+}
+
+size_t parseTextLog(const char *data, size_t size,
+                    size_t begin, size_t end,
+                    const std::string &default_node,
+                    std::vector<LogEntry> *entries)
+{
+  const char *buffer_end = data + size;
+  const char *p = data + begin;
+  size_t orphan_lines = 0;
+
+  LogEntry *current = NULL;
+  QByteArray text;
+
+  while (p < buffer_end) {
+    const char *next;
+    const char *line_end = lineEnd(p, buffer_end, &next);
+
+    RecordHeader header;
+    if (parseRecordHeader(p, line_end, &header)) {
+      if (current) {
+        current->text = QString::fromUtf8(text.constData(), text.size()).split('\n');
+        current = NULL;
+      }
+
+      // Records are owned by the range they start in.
+      if (static_cast<size_t>(p - data) >= end) {
+        break;
+      }
+
+      entries->push_back(LogEntry());
+      current = &entries->back();
+      current->stamp = header.stamp;
+      current->level = header.level;
+      if (header.node_len) {
+        current->node.assign(header.node, header.node_len);
+      } else {
+        current->node = default_node;
+      }
+      if (header.file_len) {
+        current->file.assign(header.file, header.file_len);
+      }
+      if (header.function_len) {
+        current->function.assign(header.function, header.function_len);
+      }
+      current->line = header.line;
+      text = QByteArray(header.msg, header.msg_len);
+    } else if (current) {
+      text.append('\n');
+      text.append(p, line_end - p);
+    } else if (static_cast<size_t>(p - data) >= end) {
+      break;
+    } else if (line_end != p) {
+      orphan_lines++;
+    }
+
+    p = next;
+  }
+
+  if (current) {
+    current->text = QString::fromUtf8(text.constData(), text.size()).split('\n');
+  }
+
+  return orphan_lines;
+}
+
+std::string nodeNameFromLogFile(const std::string &filename)
+{
+  std::string name = filename;
+
+  size_t slash = name.find_last_of('/');
+  if (slash != std::string::npos) {
+    name = name.substr(slash + 1);
+  }
+
+  if (name.size() > 4 && name.compare(name.size() - 4, 4, ".log") == 0) {
+    name = name.substr(0, name.size() - 4);
+  }
+
+  // roslaunch appends "-<n>" and sometimes "-stdout" to node names.
+  if (name.size() > 7 && name.compare(name.size() - 7, 7, "-stdout") == 0) {
+    name = name.substr(0, name.size() - 7);
+  }
+  size_t dash = name.find_last_of('-');
+  if (dash != std::string::npos && dash + 1 < name.size()) {
+    bool digits = true;
+    for (size_t i = dash + 1; i < name.size(); i++) {
+      digits &= isDigit(name[i]);
+    }
+    if (digits) {
+      name = name.substr(0, dash);
+    }
+  }
+
+  return "/" + name;
+}
+}  // namespace swri_console
@@ -0,0 +1,151 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/text_log_source.h>
+#include <swri_console/text_log_parser.h>
+
+#include <algorithm>
+
+#include <QThread>
+#include <QtConcurrentRun>
+
+namespace swri_console
+{
+// Approximate number of bytes parsed by each task.
+static const size_t RANGE_SIZE = 8 * 1024 * 1024;
+
+// Interval (ms) at which parsed ranges are collected.
+static const int POLL_INTERVAL = 10;
+
+TextLogSource::TextLogSource(const QString &filename, uint16_t source)
+  :
+  filename_(filename),
+  source_(source),
+  default_node_(nodeNameFromLogFile(filename.toStdString())),
+  file_(new MappedFile()),
+  next_offset_(0),
+  timer_id_(0)
+{
+  file_->data = NULL;
+  file_->size = 0;
+}
+
+TextLogSource::~TextLogSource()
+{
+  for (size_t i = 0; i < ranges_.size(); i++) {
+    ranges_[i].batch.waitForFinished();
+  }
+}
+
+void TextLogSource::start()
+{
+  if (timer_id_) {
+    return;
+  }
+
+  file_->file.setFileName(filename_);
+  if (!file_->file.open(QFile::ReadOnly)) {
+    finish(false, QString("Could not open file: %1").arg(file_->file.errorString()));
+    return;
+  }
+
+  file_->size = file_->file.size();
+  if (file_->size > 0) {
+    file_->data = reinterpret_cast<const char*>(file_->file.map(0, file_->size));
+    if (!file_->data) {
+      finish(false, QString("Could not map file: %1").arg(file_->file.errorString()));
+      return;
+    }
+  }
+
+  startRanges();
+  timer_id_ = startTimer(POLL_INTERVAL);
+}
+
+void TextLogSource::startRanges()
+{
+  // Only a few ranges are kept in flight, so that parsed entries do
+  // not pile up faster than the database takes them.
+  const size_t max_in_flight = 2 * std::max(QThread::idealThreadCount(), 1);
+  while (next_offset_ < file_->size && ranges_.size() < max_in_flight) {
+    // Ranges have to end where a record starts, so that the
+    // continuation lines of a record stay with it.
+    size_t end = file_->size;
+    if (file_->size - next_offset_ > RANGE_SIZE) {
+      end = findTextLogRecord(file_->data, file_->size, next_offset_ + RANGE_SIZE);
+    }
+
+    Range range;
+    range.batch = QtConcurrent::run(&TextLogSource::parseRange,
+                                    file_, next_offset_, end,
+                                    default_node_, source_);
+    range.size = end - next_offset_;
+    ranges_.push_back(range);
+    next_offset_ = end;
+  }
+}
+
+void TextLogSource::timerEvent(QTimerEvent *)
+{
+  while (!ranges_.empty() && ranges_.front().batch.isFinished()) {
+    Range range = ranges_.front();
+    ranges_.pop_front();
+    deliver(range.batch.result(), range.size);
+  }
+
+  startRanges();
+
+  if (ranges_.empty()) {
+    killTimer(timer_id_);
+    finish(true);
+  }
+}
+
+void TextLogSource::halt()
+{
+  // The ranges in flight are left to finish and be discarded.
+  next_offset_ = file_->size;
+}
+
+LogBatchPtr TextLogSource::parseRange(MappedFilePtr file, size_t begin, size_t end,
+                                      std::string default_node, uint16_t source)
+{
+  LogBatchPtr batch(new std::vector<LogEntry>());
+  size_t orphans = parseTextLog(file->data, file->size, begin, end, default_node, batch.get());
+  if (orphans && begin == 0) {
+    qWarning("Skipped %lu lines before the first log record.",
+             static_cast<unsigned long>(orphans));
+  }
+
+  for (size_t i = 0; i < batch->size(); i++) {
+    (*batch)[i].source = source;
+  }
+  return batch;
+}
+}  // namespace swri_console
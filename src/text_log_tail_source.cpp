@@ -0,0 +1,330 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <swri_console/text_log_tail_source.h>
+#include <swri_console/text_log_parser.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include <QDir>
+#include <QSocketNotifier>
+
+namespace swri_console
+{
+// How long (ms) a held back record waits for continuation lines.
+static const int FLUSH_DELAY = 30;
+
+// Size of the buffers used to read events and file data.
+static const size_t READ_SIZE = 64 * 1024;
+
+static bool isLogFile(const std::string &name)
+{
+  return name.size() > 4 && name.compare(name.size() - 4, 4, ".log") == 0;
+}
+
+TextLogTailSource::TextLogTailSource(const QString &directory, uint16_t source,
+                                     QObject *parent)
+  :
+  LogSource(parent),
+  directory_(directory),
+  source_(source),
+  inotify_fd_(-1),
+  notifier_(NULL)
+{
+  flush_timer_.setSingleShot(true);
+  flush_timer_.setInterval(FLUSH_DELAY);
+  QObject::connect(&flush_timer_, SIGNAL(timeout()),
+                   this, SLOT(flushPending()));
+}
+
+TextLogTailSource::~TextLogTailSource()
+{
+  for (std::map<std::string, TailedFile>::iterator it = files_.begin();
+       it != files_.end(); ++it) {
+    close(it->second.fd);
+  }
+  if (inotify_fd_ >= 0) {
+    close(inotify_fd_);
+  }
+}
+
+void TextLogTailSource::start()
+{
+  if (inotify_fd_ >= 0 || isFinished()) {
+    return;
+  }
+
+  inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd_ < 0) {
+    finish(false, QString("Could not initialize inotify: %1").arg(strerror(errno)));
+    return;
+  }
+
+  // Watching the directory reports changes to every file in it, so a
+  // single watch covers the existing files as well as new ones.
+  const uint32_t mask = IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_MOVED_FROM |
+    IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+  if (inotify_add_watch(inotify_fd_, directory_.toLocal8Bit().constData(), mask) < 0) {
+    QString error_msg = QString("Could not watch %1: %2").arg(directory_).arg(strerror(errno));
+    close(inotify_fd_);
+    inotify_fd_ = -1;
+    finish(false, error_msg);
+    return;
+  }
+
+  QStringList names = QDir(directory_).entryList(QStringList() << "*.log", QDir::Files);
+  for (int i = 0; i < names.size(); i++) {
+    openFile(names[i].toLocal8Bit().constData(), true);
+  }
+
+  notifier_ = new QSocketNotifier(inotify_fd_, QSocketNotifier::Read, this);
+  QObject::connect(notifier_, SIGNAL(activated(int)),
+                   this, SLOT(readEvents()));
+}
+
+void TextLogTailSource::openFile(const std::string &name, bool from_end)
+{
+  std::string path = directory_.toLocal8Bit().constData() + std::string("/") + name;
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    qWarning("Could not open %s: %s", path.c_str(), strerror(errno));
+    return;
+  }
+
+  TailedFile &file = files_[name];
+  file.fd = fd;
+  file.offset = 0;
+  file.node = nodeNameFromLogFile(name);
+  file.pending.clear();
+
+  struct stat st;
+  if (from_end && fstat(fd, &st) == 0) {
+    file.offset = st.st_size;
+  }
+}
+
+void TextLogTailSource::closeFile(const std::string &name, const LogBatchPtr &batch)
+{
+  std::map<std::string, TailedFile>::iterator it = files_.find(name);
+  if (it == files_.end()) {
+    return;
+  }
+
+  // The descriptor still refers to the old file after it has been
+  // moved or deleted, so whatever was written last can be read.
+  TailedFile &file = it->second;
+  readFile(file, batch);
+  if (!file.pending.empty() && file.pending[file.pending.size() - 1] != '\n') {
+    file.pending.push_back('\n');
+  }
+  parsePending(file, true, batch);
+  close(it->second.fd);
+  files_.erase(it);
+}
+
+void TextLogTailSource::readEvents()
+{
+  LogBatchPtr batch(new std::vector<LogEntry>());
+
+  // The buffer must be aligned for inotify_event.
+  static const size_t EVENT_BUFFER_SIZE = READ_SIZE / sizeof(uint64_t);
+  uint64_t buffer[EVENT_BUFFER_SIZE];
+
+  while (inotify_fd_ >= 0) {
+    ssize_t len = read(inotify_fd_, buffer, sizeof(buffer));
+    if (len <= 0) {
+      break;
+    }
+
+    const char *p = reinterpret_cast<const char*>(buffer);
+    const char *end = p + len;
+    while (p < end) {
+      const struct inotify_event *event = reinterpret_cast<const struct inotify_event*>(p);
+      p += sizeof(struct inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        // Events were lost; check every file for new data.
+        for (std::map<std::string, TailedFile>::iterator it = files_.begin();
+             it != files_.end(); ++it) {
+          readFile(it->second, batch);
+        }
+        continue;
+      }
+
+      if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+        closeAll(batch);
+        deliver(batch);
+        finish(false, "The directory was removed.");
+        return;
+      }
+
+      if (event->len == 0) {
+        continue;
+      }
+      std::string name(event->name);
+      if (!isLogFile(name)) {
+        continue;
+      }
+
+      if (event->mask & IN_MODIFY) {
+        std::map<std::string, TailedFile>::iterator it = files_.find(name);
+        if (it != files_.end()) {
+          readFile(it->second, batch);
+        } else {
+          // Created before following began, but empty until now.
+          openFile(name, false);
+          if (files_.count(name)) {
+            readFile(files_[name], batch);
+          }
+        }
+      } else if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+        // A file replacing one we are following (e.g. after rotation)
+        // is read from the start.
+        closeFile(name, batch);
+        openFile(name, false);
+        if (files_.count(name)) {
+          readFile(files_[name], batch);
+        }
+      } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        closeFile(name, batch);
+      }
+    }
+  }
+
+  deliver(batch);
+}
+
+void TextLogTailSource::readFile(TailedFile &file, const LogBatchPtr &batch)
+{
+  struct stat st;
+  if (fstat(file.fd, &st) == 0 && static_cast<size_t>(st.st_size) < file.offset) {
+    // Truncated; start over.
+    file.offset = 0;
+    file.pending.clear();
+  }
+
+  char buffer[READ_SIZE];
+  while (true) {
+    ssize_t len = pread(file.fd, buffer, sizeof(buffer), file.offset);
+    if (len <= 0) {
+      break;
+    }
+    file.pending.append(buffer, len);
+    file.offset += len;
+    addBytes(len);
+  }
+
+  parsePending(file, false, batch);
+}
+
+void TextLogTailSource::parsePending(TailedFile &file, bool flush, const LogBatchPtr &batch)
+{
+  const char *data = file.pending.data();
+
+  // A partial line waits for the rest of it.
+  size_t complete = file.pending.rfind('\n');
+  complete = (complete == std::string::npos) ? 0 : complete + 1;
+  if (complete == 0) {
+    return;
+  }
+
+  // Lines before the first record are continuations of a record that
+  // was already flushed, and can't be attached to it anymore.
+  size_t first = findTextLogRecord(data, complete, 0);
+
+  // Otherwise the last record is held back, unless the partial line
+  // already shows that the next one has started.
+  size_t end = complete;
+  if (!flush) {
+    const size_t size = file.pending.size();
+    size_t last = first;
+    for (size_t pos = first; pos < size; pos = findTextLogRecord(data, size, pos + 1)) {
+      last = pos;
+    }
+    end = std::min(last, complete);
+  }
+
+  if (first < end) {
+    size_t start = batch->size();
+    parseTextLog(data, complete, first, end, file.node, batch.get());
+    for (size_t i = start; i < batch->size(); i++) {
+      (*batch)[i].source = source_;
+    }
+  }
+  file.pending.erase(0, std::max(first, end));
+
+  if (!flush && !file.pending.empty() && !flush_timer_.isActive()) {
+    flush_timer_.start();
+  }
+}
+
+void TextLogTailSource::flushPending()
+{
+  LogBatchPtr batch(new std::vector<LogEntry>());
+  for (std::map<std::string, TailedFile>::iterator it = files_.begin();
+       it != files_.end(); ++it) {
+    parsePending(it->second, true, batch);
+  }
+  deliver(batch);
+}
+
+void TextLogTailSource::halt()
+{
+  if (inotify_fd_ < 0) {
+    return;
+  }
+
+  // What is held back is delivered before the source finishes.
+  LogBatchPtr batch(new std::vector<LogEntry>());
+  closeAll(batch);
+  deliver(batch);
+}
+
+void TextLogTailSource::closeAll(const LogBatchPtr &batch)
+{
+  while (!files_.empty()) {
+    closeFile(files_.begin()->first, batch);
+  }
+  flush_timer_.stop();
+
+  // This is called from the notifier's own signal.
+  notifier_->setEnabled(false);
+  notifier_->deleteLater();
+  notifier_ = NULL;
+  close(inotify_fd_);
+  inotify_fd_ = -1;
+}
+}  // namespace swri_console
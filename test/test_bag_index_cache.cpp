@@ -0,0 +1,224 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <gtest/gtest.h>
+
+#include <swri_console/bag_index_cache.h>
+
+#include <stdlib.h>
+
+#include <string>
+
+#include <QByteArray>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+
+using namespace swri_console;
+
+// Runs each test with an empty cache directory and a fake bag file,
+// so that it does not touch the user's cache.
+class BagIndexCache : public testing::Test
+{
+ protected:
+  virtual void SetUp()
+  {
+    char root[] = "/tmp/swri_console_test_XXXXXX";
+    ASSERT_TRUE(mkdtemp(root) != NULL);
+    root_ = root;
+    // QDesktopServices::CacheLocation is under XDG_CACHE_HOME.
+    setenv("XDG_CACHE_HOME", (root_ + "/cache").toUtf8().constData(), 1);
+
+    bag_filename_ = root_ + "/test.bag";
+    ASSERT_TRUE(writeFile(bag_filename_, QByteArray(10000, 'b')));
+
+    index_.topic = "/rosout_agg";
+    index_.nodes.push_back("/talker");
+    index_.nodes.push_back("/listener");
+    for (uint16_t i = 0; i < 100; i++) {
+      BagIndexRecord record = BagIndexRecord();
+      record.time = 1000 + i;
+      record.stamp = 2000 + i;
+      record.node = i % 2;
+      record.level = 1 << (i % 5);
+      index_.records.push_back(record);
+    }
+  }
+
+  virtual void TearDown()
+  {
+    removeDirectory(root_);
+  }
+
+  static bool writeFile(const QString &filename, const QByteArray &data)
+  {
+    QFile file(filename);
+    return file.open(QFile::WriteOnly | QFile::Truncate) && file.write(data) == data.size();
+  }
+
+  static void removeDirectory(const QString &path)
+  {
+    QDir dir(path);
+    QStringList entries = dir.entryList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden);
+    for (int i = 0; i < entries.size(); i++) {
+      QString entry = dir.filePath(entries[i]);
+      if (QFileInfo(entry).isDir()) {
+        removeDirectory(entry);
+      } else {
+        QFile::remove(entry);
+      }
+    }
+    dir.rmdir(path);
+  }
+
+  // Returns the name of the only cache file.
+  QString cacheFilename() const
+  {
+    QStringList filenames;
+    QDirIterator it(root_ + "/cache", QStringList() << "*.idx", QDir::Files,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+      filenames << it.next();
+    }
+    return filenames.size() == 1 ? filenames[0] : QString();
+  }
+
+  QByteArray readCache() const
+  {
+    QFile file(cacheFilename());
+    file.open(QFile::ReadOnly);
+    return file.readAll();
+  }
+
+  QString root_;
+  QString bag_filename_;
+  BagMessageIndex index_;
+};
+
+TEST_F(BagIndexCache, RoundTrip)
+{
+  BagMessageIndex loaded;
+  EXPECT_FALSE(loadBagMessageIndex(bag_filename_, &loaded));
+
+  ASSERT_TRUE(saveBagMessageIndex(bag_filename_, index_));
+  ASSERT_FALSE(cacheFilename().isEmpty());
+  ASSERT_TRUE(loadBagMessageIndex(bag_filename_, &loaded));
+
+  EXPECT_EQ(index_.topic, loaded.topic);
+  EXPECT_EQ(index_.nodes, loaded.nodes);
+  ASSERT_EQ(index_.records.size(), loaded.records.size());
+  for (size_t i = 0; i < loaded.records.size(); i++) {
+    EXPECT_EQ(index_.records[i].time, loaded.records[i].time);
+    EXPECT_EQ(index_.records[i].stamp, loaded.records[i].stamp);
+    EXPECT_EQ(index_.records[i].node, loaded.records[i].node);
+    EXPECT_EQ(index_.records[i].level, loaded.records[i].level);
+  }
+}
+
+TEST_F(BagIndexCache, RejectsChangedBag)
+{
+  ASSERT_TRUE(saveBagMessageIndex(bag_filename_, index_));
+
+  // Same size, different header.
+  QByteArray bag(10000, 'b');
+  bag[0] = 'x';
+  ASSERT_TRUE(writeFile(bag_filename_, bag));
+  BagMessageIndex loaded;
+  EXPECT_FALSE(loadBagMessageIndex(bag_filename_, &loaded));
+
+  ASSERT_TRUE(saveBagMessageIndex(bag_filename_, index_));
+  EXPECT_TRUE(loadBagMessageIndex(bag_filename_, &loaded));
+
+  // Appended to.
+  QFile file(bag_filename_);
+  ASSERT_TRUE(file.open(QFile::WriteOnly | QFile::Append));
+  file.write("more");
+  file.close();
+  EXPECT_FALSE(loadBagMessageIndex(bag_filename_, &loaded));
+
+  EXPECT_FALSE(loadBagMessageIndex(root_ + "/missing.bag", &loaded));
+}
+
+TEST_F(BagIndexCache, RejectsTruncatedCache)
+{
+  ASSERT_TRUE(saveBagMessageIndex(bag_filename_, index_));
+  const QString cache_filename = cacheFilename();
+  const QByteArray cache = readCache();
+
+  for (int size = 0; size < cache.size(); size++) {
+    ASSERT_TRUE(writeFile(cache_filename, cache.left(size)));
+    BagMessageIndex loaded;
+    EXPECT_FALSE(loadBagMessageIndex(bag_filename_, &loaded)) << "size " << size;
+  }
+}
+
+TEST_F(BagIndexCache, RejectsCorruptCache)
+{
+  ASSERT_TRUE(saveBagMessageIndex(bag_filename_, index_));
+  const QString cache_filename = cacheFilename();
+  const QByteArray cache = readCache();
+
+  BagMessageIndex loaded;
+  QByteArray bad_magic = cache;
+  bad_magic[0] = 'X';
+  ASSERT_TRUE(writeFile(cache_filename, bad_magic));
+  EXPECT_FALSE(loadBagMessageIndex(bag_filename_, &loaded));
+
+  // A record count that is far larger than the file must be rejected
+  // before anything is allocated for it.  It is the last field of the
+  // header, which is followed by the bag's path.
+  const QByteArray path = QFileInfo(bag_filename_).canonicalFilePath().toUtf8();
+  const int header_size = cache.indexOf(path);
+  ASSERT_GT(header_size, 8);
+  QByteArray bad_count = cache;
+  for (int i = header_size - 8; i < header_size; i++) {
+    bad_count[i] = static_cast<char>(0x7F);
+  }
+  ASSERT_TRUE(writeFile(cache_filename, bad_count));
+  EXPECT_FALSE(loadBagMessageIndex(bag_filename_, &loaded));
+
+  // Records must refer to a node and be in time order.
+  BagMessageIndex bad_node = index_;
+  bad_node.records[50].node = 2;
+  ASSERT_TRUE(saveBagMessageIndex(bag_filename_, bad_node));
+  EXPECT_FALSE(loadBagMessageIndex(bag_filename_, &loaded));
+
+  BagMessageIndex bad_order = index_;
+  bad_order.records[50].time = 0;
+  ASSERT_TRUE(saveBagMessageIndex(bag_filename_, bad_order));
+  EXPECT_FALSE(loadBagMessageIndex(bag_filename_, &loaded));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
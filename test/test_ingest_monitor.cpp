@@ -0,0 +1,136 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <gtest/gtest.h>
+
+#include <swri_console/ingest_monitor.h>
+
+#include <rosgraph_msgs/Log.h>
+
+using namespace swri_console;
+
+TEST(IngestMonitor, TracksSequenceGaps)
+{
+  IngestMonitor monitor;
+  EXPECT_FALSE(monitor.trackSequence("/rosout", 10));
+  EXPECT_FALSE(monitor.trackSequence("/rosout", 11));
+  EXPECT_TRUE(monitor.trackSequence("/rosout", 15));
+  EXPECT_FALSE(monitor.trackSequence("/rosout", 16));
+
+  // Publishers are tracked separately.
+  EXPECT_FALSE(monitor.trackSequence("/other/rosout", 100));
+  EXPECT_TRUE(monitor.trackSequence("/other/rosout", 102));
+
+  EXPECT_EQ(3u, monitor.stats().lost.find("/rosout")->second);
+  EXPECT_EQ(1u, monitor.stats().lost.find("/other/rosout")->second);
+  EXPECT_EQ(4u, monitor.stats().totalLost());
+}
+
+TEST(IngestMonitor, IgnoresRestartedPublisher)
+{
+  IngestMonitor monitor;
+  monitor.trackSequence("/rosout", 1000);
+  EXPECT_FALSE(monitor.trackSequence("/rosout", 0));
+  EXPECT_FALSE(monitor.trackSequence("/rosout", 1));
+  EXPECT_FALSE(monitor.trackSequence("/rosout", 1));
+  EXPECT_EQ(0u, monitor.stats().totalLost());
+}
+
+TEST(IngestMonitor, HandlesSequenceWraparound)
+{
+  IngestMonitor monitor;
+  monitor.trackSequence("/rosout", 0xFFFFFFFE);
+  EXPECT_FALSE(monitor.trackSequence("/rosout", 0xFFFFFFFF));
+  EXPECT_FALSE(monitor.trackSequence("/rosout", 0));
+  EXPECT_TRUE(monitor.trackSequence("/rosout", 3));
+  EXPECT_EQ(2u, monitor.stats().totalLost());
+}
+
+TEST(IngestMonitor, KeepsEverythingBelowThreshold)
+{
+  IngestMonitor monitor;
+  for (size_t i = 0; i < 1000; i++) {
+    EXPECT_TRUE(monitor.keep("/node", rosgraph_msgs::Log::DEBUG,
+                             IngestMonitor::SHED_THRESHOLD - 1));
+  }
+  EXPECT_EQ(0u, monitor.stats().totalShed());
+}
+
+TEST(IngestMonitor, AlwaysKeepsWarnings)
+{
+  IngestMonitor monitor;
+  const uint8_t levels[] = {
+    rosgraph_msgs::Log::WARN, rosgraph_msgs::Log::ERROR, rosgraph_msgs::Log::FATAL };
+  for (size_t i = 0; i < sizeof(levels); i++) {
+    EXPECT_TRUE(monitor.keep("/node", levels[i], IngestMonitor::DROP_THRESHOLD * 10));
+  }
+  EXPECT_EQ(0u, monitor.stats().totalShed());
+}
+
+TEST(IngestMonitor, SamplesInfoAndDebug)
+{
+  // At the threshold every 2nd INFO and every 4th DEBUG message is
+  // kept.
+  IngestMonitor monitor;
+  size_t info_kept = 0;
+  size_t debug_kept = 0;
+  for (size_t i = 0; i < 400; i++) {
+    info_kept += monitor.keep("/info", rosgraph_msgs::Log::INFO, IngestMonitor::SHED_THRESHOLD);
+    debug_kept += monitor.keep("/debug", rosgraph_msgs::Log::DEBUG, IngestMonitor::SHED_THRESHOLD);
+  }
+  EXPECT_EQ(200u, info_kept);
+  EXPECT_EQ(100u, debug_kept);
+  EXPECT_EQ(200u, monitor.stats().shed.find("/info")->second);
+  EXPECT_EQ(300u, monitor.stats().shed.find("/debug")->second);
+
+  // The interval grows with the backlog.
+  IngestMonitor busy;
+  info_kept = 0;
+  for (size_t i = 0; i < 400; i++) {
+    info_kept += busy.keep("/info", rosgraph_msgs::Log::INFO,
+                           IngestMonitor::SHED_THRESHOLD + 2 * IngestMonitor::SHED_STEP);
+  }
+  EXPECT_EQ(100u, info_kept);
+}
+
+TEST(IngestMonitor, DropsInfoAndDebugAboveDropThreshold)
+{
+  IngestMonitor monitor;
+  for (size_t i = 0; i < 100; i++) {
+    EXPECT_FALSE(monitor.keep("/node", rosgraph_msgs::Log::INFO, IngestMonitor::DROP_THRESHOLD));
+    EXPECT_FALSE(monitor.keep("/node", rosgraph_msgs::Log::DEBUG, IngestMonitor::DROP_THRESHOLD));
+  }
+  EXPECT_EQ(200u, monitor.stats().totalShed());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,196 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <gtest/gtest.h>
+
+#include <swri_console/log_decoder.h>
+#include <swri_console/log_database.h>
+
+#include <string>
+#include <vector>
+
+using namespace swri_console;
+
+// Builds a serialized rosgraph_msgs/Log the way roscpp lays it out.
+class LogMessageWriter
+{
+ public:
+  LogMessageWriter() {}
+
+  std::vector<uint8_t> write(uint32_t seq, uint32_t sec, uint32_t nsec,
+                             uint8_t level, const std::string &name,
+                             const std::string &msg)
+  {
+    data_.clear();
+    writeUInt32(seq);
+    writeUInt32(sec);
+    writeUInt32(nsec);
+    writeString("");
+    data_.push_back(level);
+    writeString(name);
+    writeString(msg);
+    writeString("file.cpp");
+    writeString("function");
+    writeUInt32(42);
+    writeUInt32(2);
+    writeString("/rosout");
+    writeString("/chatter");
+    return data_;
+  }
+
+ private:
+  void writeUInt32(uint32_t value)
+  {
+    for (int i = 0; i < 4; i++) {
+      data_.push_back((value >> (8 * i)) & 0xFF);
+    }
+  }
+
+  void writeString(const std::string &str)
+  {
+    writeUInt32(str.size());
+    data_.insert(data_.end(), str.begin(), str.end());
+  }
+
+  std::vector<uint8_t> data_;
+};
+
+TEST(LogDecoder, DecodesMessage)
+{
+  std::vector<uint8_t> data = LogMessageWriter().write(
+    7, 1530000000, 123456789, rosgraph_msgs::Log::WARN, "/talker", "one\ntwo");
+
+  LogEntry entry;
+  ASSERT_TRUE(decodeLogMessage(&data[0], data.size(), &entry));
+  EXPECT_EQ(7u, entry.seq);
+  EXPECT_EQ(1530000000u, entry.stamp.sec);
+  EXPECT_EQ(123456789u, entry.stamp.nsec);
+  EXPECT_EQ(rosgraph_msgs::Log::WARN, entry.level);
+  EXPECT_EQ("/talker", entry.node);
+  EXPECT_EQ("file.cpp", entry.file);
+  EXPECT_EQ("function", entry.function);
+  EXPECT_EQ(42u, entry.line);
+  ASSERT_EQ(2, entry.text.size());
+  EXPECT_EQ("one", entry.text[0].toStdString());
+  EXPECT_EQ("two", entry.text[1].toStdString());
+}
+
+TEST(LogDecoder, RejectsTruncatedMessage)
+{
+  std::vector<uint8_t> data = LogMessageWriter().write(
+    1, 100, 0, rosgraph_msgs::Log::INFO, "/talker", "hello");
+
+  // Every proper prefix of the message must be rejected without
+  // reading past its end.
+  for (size_t size = 0; size < data.size(); size++) {
+    std::vector<uint8_t> prefix(data.begin(), data.begin() + size);
+    LogEntry entry;
+    EXPECT_EQ(DECODE_INVALID,
+              decodeLogMessage(prefix.empty() ? NULL : &prefix[0], prefix.size(),
+                               LogDecodeFilter(), &entry)) << "size " << size;
+  }
+}
+
+TEST(LogDecoder, RejectsCorruptStringLength)
+{
+  std::vector<uint8_t> data = LogMessageWriter().write(
+    1, 100, 0, rosgraph_msgs::Log::INFO, "/talker", "hello");
+
+  // The node name's length follows the header (12 bytes), the empty
+  // frame_id (4 bytes) and the level (1 byte).
+  data[17] = 0xFF;
+  data[18] = 0xFF;
+  data[19] = 0xFF;
+  data[20] = 0xFF;
+
+  LogEntry entry;
+  EXPECT_FALSE(decodeLogMessage(&data[0], data.size(), &entry));
+}
+
+TEST(LogDecoder, RejectsInvalidNsec)
+{
+  std::vector<uint8_t> data = LogMessageWriter().write(
+    1, 0xFFFFFFFF, 1000000000, rosgraph_msgs::Log::INFO, "/talker", "hello");
+
+  LogEntry entry;
+  EXPECT_EQ(DECODE_INVALID, decodeLogMessage(&data[0], data.size(), LogDecodeFilter(), &entry));
+
+  uint32_t seq;
+  uint32_t sec;
+  uint32_t nsec;
+  uint8_t level;
+  std::string node;
+  EXPECT_FALSE(decodeLogHeader(&data[0], data.size(), &seq, &sec, &nsec, &level, &node));
+}
+
+TEST(LogDecoder, AppliesFilter)
+{
+  std::vector<uint8_t> data = LogMessageWriter().write(
+    1, 100, 0, rosgraph_msgs::Log::INFO, "/talker", "hello");
+
+  LogDecodeFilter filter;
+  LogEntry entry;
+  filter.min_level = rosgraph_msgs::Log::WARN;
+  EXPECT_EQ(DECODE_REJECTED, decodeLogMessage(&data[0], data.size(), filter, &entry));
+
+  filter.min_level = rosgraph_msgs::Log::INFO;
+  filter.nodes.insert("/listener");
+  EXPECT_EQ(DECODE_REJECTED, decodeLogMessage(&data[0], data.size(), filter, &entry));
+
+  filter.nodes.insert("/talker");
+  EXPECT_EQ(DECODE_ACCEPTED, decodeLogMessage(&data[0], data.size(), filter, &entry));
+}
+
+TEST(LogDecoder, DecodesHeader)
+{
+  std::vector<uint8_t> data = LogMessageWriter().write(
+    9, 200, 300, rosgraph_msgs::Log::ERROR, "/talker", "hello");
+
+  uint32_t seq;
+  uint32_t sec;
+  uint32_t nsec;
+  uint8_t level;
+  std::string node;
+  ASSERT_TRUE(decodeLogHeader(&data[0], data.size(), &seq, &sec, &nsec, &level, &node));
+  EXPECT_EQ(9u, seq);
+  EXPECT_EQ(200u, sec);
+  EXPECT_EQ(300u, nsec);
+  EXPECT_EQ(rosgraph_msgs::Log::ERROR, level);
+  EXPECT_EQ("/talker", node);
+
+  // The header decoder only needs the data up to the node name.
+  EXPECT_TRUE(decodeLogHeader(&data[0], 17 + 4 + 7, &seq, &sec, &nsec, &level, &node));
+  EXPECT_FALSE(decodeLogHeader(&data[0], 17 + 4 + 6, &seq, &sec, &nsec, &level, &node));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
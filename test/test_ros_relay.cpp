@@ -0,0 +1,146 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <gtest/gtest.h>
+
+#include <swri_console/ros_relay.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace swri_console;
+
+static std::string frame(uint8_t type, const std::string &data)
+{
+  std::string result;
+  result.push_back(type);
+  for (int i = 0; i < 4; i++) {
+    result.push_back(static_cast<char>((data.size() >> (8 * i)) & 0xFF));
+  }
+  return result + data;
+}
+
+static std::string frameData(const uint8_t *data, uint32_t size)
+{
+  return std::string(reinterpret_cast<const char*>(data), size);
+}
+
+TEST(RosRelay, ParsesFrame)
+{
+  const std::string data = frame(RELAY_CONNECTED, "http://master:11311") + "extra";
+
+  uint8_t type;
+  const uint8_t *payload;
+  uint32_t size;
+  ASSERT_TRUE(parseRelayFrame(reinterpret_cast<const uint8_t*>(data.data()), data.size(),
+                              &type, &payload, &size));
+  EXPECT_EQ(RELAY_CONNECTED, type);
+  EXPECT_EQ("http://master:11311", frameData(payload, size));
+}
+
+TEST(RosRelay, RejectsIncompleteFrame)
+{
+  const std::string data = frame(RELAY_MESSAGE, "payload");
+  for (size_t size = 0; size < data.size(); size++) {
+    uint8_t type;
+    const uint8_t *payload;
+    uint32_t payload_size;
+    EXPECT_FALSE(parseRelayFrame(reinterpret_cast<const uint8_t*>(data.data()), size,
+                                 &type, &payload, &payload_size)) << "size " << size;
+  }
+
+  // A corrupt length must not wrap around the end of the buffer.
+  const std::string corrupt = std::string("\x02\xff\xff\xff\xff", 5) + "payload";
+  uint8_t type;
+  const uint8_t *payload;
+  uint32_t payload_size;
+  EXPECT_FALSE(parseRelayFrame(reinterpret_cast<const uint8_t*>(corrupt.data()), corrupt.size(),
+                               &type, &payload, &payload_size));
+}
+
+TEST(RosRelay, ReadsFramesFromStream)
+{
+  const std::string stream =
+    frame(RELAY_CONNECTED, "http://master:11311") +
+    frame(RELAY_MESSAGE, "") +
+    frame(RELAY_MESSAGE, std::string(70000, 'x')) +
+    frame(RELAY_MESSAGE, "last");
+
+  // Frames must come out the same however the stream is split up by
+  // the reads.
+  const size_t chunk_sizes[] = { 1, 3, 7, 4096, stream.size() };
+  for (size_t c = 0; c < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); c++) {
+    RelayFrameReader reader;
+    std::vector<std::pair<uint8_t, std::string> > frames;
+    for (size_t pos = 0; pos < stream.size(); pos += chunk_sizes[c]) {
+      reader.append(stream.data() + pos, std::min(chunk_sizes[c], stream.size() - pos));
+
+      uint8_t type;
+      const uint8_t *data;
+      uint32_t size;
+      while (reader.next(&type, &data, &size)) {
+        frames.push_back(std::make_pair(type, frameData(data, size)));
+      }
+    }
+
+    ASSERT_EQ(4u, frames.size()) << "chunk size " << chunk_sizes[c];
+    EXPECT_EQ(RELAY_CONNECTED, frames[0].first);
+    EXPECT_EQ("http://master:11311", frames[0].second);
+    EXPECT_EQ(RELAY_MESSAGE, frames[1].first);
+    EXPECT_EQ("", frames[1].second);
+    EXPECT_EQ(std::string(70000, 'x'), frames[2].second);
+    EXPECT_EQ("last", frames[3].second);
+  }
+}
+
+TEST(RosRelay, WaitsForTruncatedFrame)
+{
+  RelayFrameReader reader;
+  const std::string data = frame(RELAY_MESSAGE, "payload");
+  reader.append(data.data(), data.size() - 1);
+
+  uint8_t type;
+  const uint8_t *payload;
+  uint32_t size;
+  EXPECT_FALSE(reader.next(&type, &payload, &size));
+  EXPECT_FALSE(reader.next(&type, &payload, &size));
+
+  reader.append(data.data() + data.size() - 1, 1);
+  ASSERT_TRUE(reader.next(&type, &payload, &size));
+  EXPECT_EQ("payload", frameData(payload, size));
+  EXPECT_FALSE(reader.next(&type, &payload, &size));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,183 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <gtest/gtest.h>
+
+#include <swri_console/session_file.h>
+
+#include <string.h>
+#include <vector>
+
+using namespace swri_console;
+
+static LogEntry makeEntry(uint32_t sec, uint32_t nsec, const std::string &node,
+                          const QString &text)
+{
+  LogEntry entry;
+  entry.stamp = ros::Time(sec, nsec);
+  entry.level = rosgraph_msgs::Log::INFO;
+  entry.node = node;
+  entry.file = "file.cpp";
+  entry.function = "function";
+  entry.line = sec;
+  entry.seq = sec * 10;
+  entry.text = text.split('\n');
+  return entry;
+}
+
+// Entries in arrival order, which is not sorted by stamp.
+static std::vector<LogEntry> makeEntries()
+{
+  std::vector<LogEntry> entries;
+  entries.push_back(makeEntry(30, 0, "/a", "third"));
+  entries.push_back(makeEntry(10, 500, "/b", "first\nsecond line"));
+  entries.push_back(makeEntry(20, 999999999, "/a", ""));
+  return entries;
+}
+
+static SessionFileHeader readHeader(const QByteArray &data)
+{
+  SessionFileHeader header;
+  memcpy(&header, data.constData(), sizeof(header));
+  return header;
+}
+
+// Returns the offset of a field of record i.
+static size_t recordOffset(const QByteArray &data, size_t i, size_t field)
+{
+  return readHeader(data).records_offset + i * sizeof(SessionFileRecord) + field;
+}
+
+TEST(SessionFile, RoundTrip)
+{
+  std::vector<LogEntry> entries = makeEntries();
+  QByteArray data = encodeSessionData(entries);
+  ASSERT_FALSE(data.isEmpty());
+
+  std::vector<LogEntry> decoded;
+  ASSERT_TRUE(decodeSessionData(data, 3, &decoded).isEmpty());
+  ASSERT_EQ(entries.size(), decoded.size());
+  for (size_t i = 0; i < entries.size(); i++) {
+    EXPECT_EQ(entries[i].stamp, decoded[i].stamp);
+    EXPECT_EQ(entries[i].level, decoded[i].level);
+    EXPECT_EQ(entries[i].node, decoded[i].node);
+    EXPECT_EQ(entries[i].file, decoded[i].file);
+    EXPECT_EQ(entries[i].function, decoded[i].function);
+    EXPECT_EQ(entries[i].line, decoded[i].line);
+    EXPECT_EQ(entries[i].seq, decoded[i].seq);
+    EXPECT_EQ(entries[i].text.join("\n").toStdString(),
+              decoded[i].text.join("\n").toStdString());
+    EXPECT_EQ(3, decoded[i].source);
+  }
+}
+
+TEST(SessionFile, EmptySession)
+{
+  QByteArray data = encodeSessionData(std::vector<LogEntry>());
+  SessionFileReader reader;
+  ASSERT_TRUE(reader.open(data).isEmpty());
+  EXPECT_EQ(0u, reader.size());
+  LogEntry entry;
+  EXPECT_FALSE(reader.decode(0, &entry));
+}
+
+TEST(SessionFile, RejectsTruncatedData)
+{
+  QByteArray data = encodeSessionData(makeEntries());
+
+  // A truncated file must either be rejected when it is opened or
+  // only yield records that lie inside of it.
+  for (int size = 0; size < data.size(); size++) {
+    SessionFileReader reader;
+    if (!reader.open(data.left(size)).isEmpty()) {
+      continue;
+    }
+    for (size_t i = 0; i < reader.size(); i++) {
+      LogEntry entry;
+      reader.decode(i, &entry);
+    }
+    EXPECT_GE(size, static_cast<int>(readHeader(data).strings_offset)) << "size " << size;
+  }
+
+  std::vector<LogEntry> entries;
+  EXPECT_FALSE(decodeSessionData(data.left(sizeof(SessionFileHeader) - 1), 0, &entries).isEmpty());
+  EXPECT_FALSE(decodeSessionData(data.left(data.size() / 2), 0, &entries).isEmpty());
+  EXPECT_TRUE(entries.empty());
+}
+
+TEST(SessionFile, RejectsBadHeader)
+{
+  QByteArray data = encodeSessionData(makeEntries());
+  SessionFileReader reader;
+
+  QByteArray bad_magic = data;
+  bad_magic[0] = 'X';
+  EXPECT_FALSE(reader.open(bad_magic).isEmpty());
+
+  QByteArray bad_version = data;
+  bad_version.data()[offsetof(SessionFileHeader, version)] = 99;
+  EXPECT_FALSE(reader.open(bad_version).isEmpty());
+
+  QByteArray bad_count = data;
+  bad_count.data()[offsetof(SessionFileHeader, entry_count) + 3] = 1;
+  EXPECT_FALSE(reader.open(bad_count).isEmpty());
+}
+
+TEST(SessionFile, SkipsCorruptRecords)
+{
+  QByteArray data = encodeSessionData(makeEntries());
+
+  // An out of range nsec in the first record and a bad node id in the
+  // second one.
+  uint32_t nsec = 1000000000;
+  memcpy(data.data() + recordOffset(data, 0, offsetof(SessionFileRecord, nsec)),
+         &nsec, sizeof(nsec));
+  uint32_t node = 1000;
+  memcpy(data.data() + recordOffset(data, 1, offsetof(SessionFileRecord, node)),
+         &node, sizeof(node));
+
+  SessionFileReader reader;
+  ASSERT_TRUE(reader.open(data).isEmpty());
+  LogEntry entry;
+  EXPECT_FALSE(reader.decode(0, &entry));
+  EXPECT_FALSE(reader.decode(1, &entry));
+  EXPECT_TRUE(reader.decode(2, &entry));
+  EXPECT_FALSE(reader.decode(3, &entry));
+
+  std::vector<LogEntry> entries;
+  EXPECT_TRUE(decodeSessionData(data, 0, &entries).isEmpty());
+  ASSERT_EQ(1u, entries.size());
+  EXPECT_EQ(ros::Time(20, 999999999), entries[0].stamp);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,211 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <gtest/gtest.h>
+
+#include <swri_console/syslog_parser.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+
+using namespace swri_console;
+
+// 2003-12-01 00:00:00 UTC
+static const ros::Time RECEIVED(1070236800, 0);
+
+class SyslogParser : public testing::Test
+{
+ protected:
+  virtual void SetUp()
+  {
+    // BSD timestamps are in local time.
+    setenv("TZ", "UTC", 1);
+    tzset();
+  }
+
+  LogEntry parse(const std::string &msg, const ros::Time &received = RECEIVED)
+  {
+    LogEntry entry;
+    parseSyslogMessage(msg.data(), msg.size(), received, &entry);
+    return entry;
+  }
+
+  static std::string text(const LogEntry &entry)
+  {
+    return entry.text.join("\n").toStdString();
+  }
+};
+
+TEST_F(SyslogParser, ParsesRfc5424)
+{
+  LogEntry entry = parse(
+    "<165>1 2003-10-11T22:14:15.003Z mymachine.example.com evntslog - ID47 "
+    "[exampleSDID@32473 iut=\"3\" eventSource=\"Application\" eventID=\"1011\"] "
+    "\xEF\xBB\xBF" "An application event log entry...");
+  EXPECT_EQ(ros::Time(1065910455, 3000000), entry.stamp);
+  EXPECT_EQ(rosgraph_msgs::Log::INFO, entry.level);
+  EXPECT_EQ("mymachine.example.com:/evntslog", entry.node);
+  EXPECT_EQ("local4", entry.file);
+  EXPECT_EQ("", entry.function);
+  EXPECT_EQ("An application event log entry...", text(entry));
+
+  entry = parse("<165>1 2003-08-24T05:14:15.000003-07:00 192.0.2.1 myproc 8710 - - "
+                "%% It's time to make the do-nuts.");
+  EXPECT_EQ(ros::Time(1061727255, 3000), entry.stamp);
+  EXPECT_EQ("192.0.2.1:/myproc", entry.node);
+  EXPECT_EQ("8710", entry.function);
+  EXPECT_EQ("%% It's time to make the do-nuts.", text(entry));
+}
+
+TEST_F(SyslogParser, ParsesRfc5424WithoutOptionalFields)
+{
+  // Quoted structured data values may contain escaped brackets.
+  LogEntry entry = parse("<191>1 - - - - - [a b=\"x\\]y\"][c] hi\n");
+  EXPECT_EQ(RECEIVED, entry.stamp);
+  EXPECT_EQ(rosgraph_msgs::Log::DEBUG, entry.level);
+  EXPECT_EQ("/local7", entry.node);
+  EXPECT_EQ("hi", text(entry));
+}
+
+TEST_F(SyslogParser, ParsesRfc3164)
+{
+  LogEntry entry = parse("<34>Oct 11 22:14:15 mymachine su: 'su root' failed for lonvick\n");
+  EXPECT_EQ(ros::Time(1065910455, 0), entry.stamp);
+  EXPECT_EQ(rosgraph_msgs::Log::FATAL, entry.level);
+  EXPECT_EQ("mymachine:/su", entry.node);
+  EXPECT_EQ("auth", entry.file);
+  EXPECT_EQ("'su root' failed for lonvick", text(entry));
+
+  // Local senders leave out the hostname.
+  entry = parse("<11>Feb  5 17:32:18 motor[77]: overcurrent\nline2");
+  EXPECT_EQ(rosgraph_msgs::Log::ERROR, entry.level);
+  EXPECT_EQ("/motor", entry.node);
+  EXPECT_EQ("user", entry.file);
+  EXPECT_EQ("77", entry.function);
+  EXPECT_EQ("overcurrent\nline2", text(entry));
+
+  entry = parse("<13>Feb  5 17:32:18 10.0.0.99 Use the BFG!");
+  EXPECT_EQ("10.0.0.99:/user", entry.node);
+  EXPECT_EQ("Use the BFG!", text(entry));
+}
+
+TEST_F(SyslogParser, PicksYearOfRfc3164Timestamps)
+{
+  // A message from New Year's Eve that arrives after midnight keeps
+  // its year, and one that is a little ahead of the receiver is not
+  // moved back a year.
+  const ros::Time new_year(1072915200, 0);
+  EXPECT_EQ(ros::Time(1072915140, 0), parse("<14>Dec 31 23:59:00 host app: x", new_year).stamp);
+  EXPECT_EQ(ros::Time(1072915260, 0), parse("<14>Jan  1 00:01:00 host app: x", new_year).stamp);
+}
+
+TEST_F(SyslogParser, KeepsUnrecognizedMessages)
+{
+  LogEntry entry = parse("no priority at all");
+  EXPECT_EQ(RECEIVED, entry.stamp);
+  EXPECT_EQ(rosgraph_msgs::Log::INFO, entry.level);
+  EXPECT_EQ("/user", entry.node);
+  EXPECT_EQ("no priority at all", text(entry));
+
+  EXPECT_EQ("<192>out of range", text(parse("<192>out of range")));
+  EXPECT_EQ("<1234>too long", text(parse("<1234>too long")));
+  EXPECT_EQ("<12", text(parse("<12")));
+
+  // A message with a valid priority but a corrupt header is kept
+  // whole after the priority.
+  entry = parse("<12>1 2003-13-11T22:14:15Z host app - - - bad month");
+  EXPECT_EQ(RECEIVED, entry.stamp);
+  EXPECT_EQ(rosgraph_msgs::Log::WARN, entry.level);
+  EXPECT_EQ("1 2003-13-11T22:14:15Z host app - - - bad month", text(entry));
+
+  entry = parse("<12>1 2200-01-01T00:00:00Z host app - - - does not fit in a ros::Time");
+  EXPECT_EQ(RECEIVED, entry.stamp);
+
+  // A BSD timestamp a little ahead of a receiver at the end of
+  // ros::Time's range.
+  const ros::Time last(4294967295u, 0);
+  EXPECT_EQ(last, parse("<12>Feb  7 23:00:00 host app: does not fit either", last).stamp);
+
+  entry = parse("<12>1 2003-10-11T22:14:15.1234567890Z host app - - - too many digits");
+  EXPECT_EQ(RECEIVED, entry.stamp);
+
+  entry = parse("<12>Oct 11 22:14 host app: no seconds");
+  EXPECT_EQ(RECEIVED, entry.stamp);
+  EXPECT_EQ("Oct 11 22:14 host app: no seconds", text(entry));
+
+  entry = parse("<12>1 - host app - - [unterminated hi");
+  EXPECT_EQ("1 - host app - - [unterminated hi", text(entry));
+}
+
+TEST_F(SyslogParser, HandlesTruncatedMessages)
+{
+  // Every prefix of a message must parse without reading past its end.
+  const std::string messages[] = {
+    "<165>1 2003-08-24T05:14:15.000003-07:00 192.0.2.1 myproc 8710 - "
+    "[a b=\"x\\]y\"] msg",
+    "<34>Oct 11 22:14:15.5 mymachine su[12]: msg"
+  };
+  for (size_t m = 0; m < sizeof(messages) / sizeof(messages[0]); m++) {
+    for (size_t size = 0; size <= messages[m].size(); size++) {
+      // Copy the prefix, so that reading past it is caught by tools
+      // like valgrind and ASan.
+      char *data = static_cast<char*>(malloc(size + 1));
+      memcpy(data, messages[m].data(), size);
+      LogEntry entry;
+      parseSyslogMessage(data, size, RECEIVED, &entry);
+      free(data);
+      EXPECT_FALSE(entry.node.empty());
+    }
+  }
+}
+
+TEST_F(SyslogParser, MapsSeverityAndFacility)
+{
+  EXPECT_EQ(rosgraph_msgs::Log::FATAL, syslogSeverityLevel(0));
+  EXPECT_EQ(rosgraph_msgs::Log::FATAL, syslogSeverityLevel(2));
+  EXPECT_EQ(rosgraph_msgs::Log::ERROR, syslogSeverityLevel(3));
+  EXPECT_EQ(rosgraph_msgs::Log::WARN, syslogSeverityLevel(4));
+  EXPECT_EQ(rosgraph_msgs::Log::INFO, syslogSeverityLevel(5));
+  EXPECT_EQ(rosgraph_msgs::Log::INFO, syslogSeverityLevel(6));
+  EXPECT_EQ(rosgraph_msgs::Log::DEBUG, syslogSeverityLevel(7));
+
+  EXPECT_STREQ("kern", syslogFacilityName(0));
+  EXPECT_STREQ("local7", syslogFacilityName(23));
+  EXPECT_STREQ("unknown", syslogFacilityName(24));
+  EXPECT_STREQ("unknown", syslogFacilityName(-1));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
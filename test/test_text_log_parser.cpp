@@ -0,0 +1,190 @@
+// *****************************************************************************
+//
+// Copyright (c) 2015, Southwest Research Institute® (SwRI®)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Southwest Research Institute® (SwRI®) nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL Southwest Research Institute® BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+// DAMAGE.
+//
+// *****************************************************************************
+#include <gtest/gtest.h>
+
+#include <swri_console/text_log_parser.h>
+
+#include <ctype.h>
+
+#include <string>
+#include <vector>
+
+using namespace swri_console;
+
+static const char ROSOUT_LOG[] =
+  "1530000000.123456789 INFO /talker [talker.cpp:12(main)] [topics: /rosout, /chatter] hello\n"
+  "1530000001.5 WARN /listener [a:b.py:7(f(x))] [topics: /rosout] first\n"
+  "second line\r\n"
+  "\n"
+  "1530000002.000000001 ERROR /talker [] no location\n";
+
+static size_t parse(const std::string &text, std::vector<LogEntry> *entries)
+{
+  return parseTextLog(text.data(), text.size(), 0, text.size(), "/default", entries);
+}
+
+static std::string text(const LogEntry &entry)
+{
+  return entry.text.join("\n").toStdString();
+}
+
+TEST(TextLogParser, ParsesRosoutLog)
+{
+  std::vector<LogEntry> entries;
+  EXPECT_EQ(0u, parse(ROSOUT_LOG, &entries));
+  ASSERT_EQ(3u, entries.size());
+
+  EXPECT_EQ(ros::Time(1530000000, 123456789), entries[0].stamp);
+  EXPECT_EQ(rosgraph_msgs::Log::INFO, entries[0].level);
+  EXPECT_EQ("/talker", entries[0].node);
+  EXPECT_EQ("talker.cpp", entries[0].file);
+  EXPECT_EQ("main", entries[0].function);
+  EXPECT_EQ(12u, entries[0].line);
+  EXPECT_EQ("hello", text(entries[0]));
+
+  // File and function names may contain colons and parentheses, and
+  // continuation lines belong to the record before them.
+  EXPECT_EQ(ros::Time(1530000001, 500000000), entries[1].stamp);
+  EXPECT_EQ(rosgraph_msgs::Log::WARN, entries[1].level);
+  EXPECT_EQ("a:b.py", entries[1].file);
+  EXPECT_EQ("f(x)", entries[1].function);
+  EXPECT_EQ(7u, entries[1].line);
+  EXPECT_EQ("first\nsecond line\n", text(entries[1]));
+
+  EXPECT_EQ(ros::Time(1530000002, 1), entries[2].stamp);
+  EXPECT_EQ(rosgraph_msgs::Log::ERROR, entries[2].level);
+  EXPECT_EQ("", entries[2].file);
+  EXPECT_EQ("[] no location", text(entries[2]));
+}
+
+TEST(TextLogParser, ParsesRosconsoleAndRospyLines)
+{
+  std::vector<LogEntry> entries;
+  EXPECT_EQ(1u, parse("orphan line\n"
+                      "[ WARN] [1530000000.250000000]: rosconsole\n"
+                      "[DEBUG] [1530000000.5, 12.0]: sim time\n"
+                      "[rosout][CRITICAL] 2018-06-26 12:00:00,123: rospy\n",
+                      &entries));
+  ASSERT_EQ(3u, entries.size());
+
+  EXPECT_EQ(ros::Time(1530000000, 250000000), entries[0].stamp);
+  EXPECT_EQ(rosgraph_msgs::Log::WARN, entries[0].level);
+  EXPECT_EQ("/default", entries[0].node);
+  EXPECT_EQ("rosconsole", text(entries[0]));
+
+  EXPECT_EQ(ros::Time(1530000000, 500000000), entries[1].stamp);
+  EXPECT_EQ(rosgraph_msgs::Log::DEBUG, entries[1].level);
+  EXPECT_EQ("sim time", text(entries[1]));
+
+  // rospy writes local time, so only the milliseconds are fixed.
+  EXPECT_EQ(123000000u, entries[2].stamp.nsec);
+  EXPECT_EQ(rosgraph_msgs::Log::FATAL, entries[2].level);
+  EXPECT_EQ("/default", entries[2].node);
+  EXPECT_EQ("rospy", text(entries[2]));
+}
+
+TEST(TextLogParser, RejectsMalformedHeaders)
+{
+  // None of these start a record, so they are all orphan lines.
+  std::vector<LogEntry> entries;
+  EXPECT_EQ(9u, parse("4294967296.0 INFO /node [] sec does not fit\n"
+                      "99999999999.0 INFO /node [] too many digits\n"
+                      "1530000000.1234567890 INFO /node [] too many fraction digits\n"
+                      "1530000000 INFO /node [] no fraction\n"
+                      "1530000000.1 NOTICE /node [] unknown level\n"
+                      "1530000000.1 INFO /node\n"
+                      "[ INFO] [1530000000.1]\n"
+                      "[INFO] [4294967296.0]: sec does not fit\n"
+                      "[rosout][INFO] 2018-06-26 12:00:00: no milliseconds\n",
+                      &entries));
+  EXPECT_TRUE(entries.empty());
+
+  EXPECT_EQ(0u, parse("4294967295.999999999 INFO /node [] largest stamp\n", &entries));
+  ASSERT_EQ(1u, entries.size());
+  EXPECT_EQ(ros::Time(4294967295u, 999999999), entries[0].stamp);
+}
+
+TEST(TextLogParser, HandlesTruncatedInput)
+{
+  // A file that is still being written can end anywhere.  Every
+  // prefix must parse without reading past its end.
+  const std::string log(ROSOUT_LOG);
+  for (size_t size = 0; size <= log.size(); size++) {
+    // Copy the prefix, so that reading past it is caught by tools
+    // like valgrind and ASan.
+    std::vector<char> prefix(log.begin(), log.begin() + size);
+    const char *data = prefix.empty() ? NULL : &prefix[0];
+    std::vector<LogEntry> entries;
+    parseTextLog(data, size, 0, size, "/default", &entries);
+    EXPECT_LE(entries.size(), 3u);
+    EXPECT_LE(findTextLogRecord(data, size, size / 2), size);
+  }
+}
+
+TEST(TextLogParser, ParsesRangesIndependently)
+{
+  // Splitting the buffer at findTextLogRecord() and parsing each
+  // range separately gives the same entries as parsing all of it.
+  const std::string log = std::string("leading garbage\n") + ROSOUT_LOG + ROSOUT_LOG;
+
+  std::vector<LogEntry> expected;
+  EXPECT_EQ(1u, parse(log, &expected));
+  ASSERT_EQ(6u, expected.size());
+
+  for (size_t split = 0; split <= log.size(); split++) {
+    const size_t middle = findTextLogRecord(log.data(), log.size(), split);
+    ASSERT_LE(middle, log.size());
+    ASSERT_TRUE(middle == log.size() || isdigit(log[middle]));
+
+    std::vector<LogEntry> entries;
+    size_t orphans = parseTextLog(log.data(), log.size(), 0, middle, "/default", &entries);
+    orphans += parseTextLog(log.data(), log.size(), middle, log.size(), "/default", &entries);
+    EXPECT_EQ(1u, orphans);
+    ASSERT_EQ(expected.size(), entries.size()) << "split " << split;
+    for (size_t i = 0; i < entries.size(); i++) {
+      EXPECT_EQ(expected[i].stamp, entries[i].stamp);
+      EXPECT_EQ(text(expected[i]), text(entries[i]));
+    }
+  }
+}
+
+TEST(TextLogParser, NodeNameFromLogFile)
+{
+  EXPECT_EQ("/talker", nodeNameFromLogFile("talker-1.log"));
+  EXPECT_EQ("/talker", nodeNameFromLogFile("/home/user/.ros/log/latest/talker-1-stdout.log"));
+  EXPECT_EQ("/rosout", nodeNameFromLogFile("rosout.log"));
+  EXPECT_EQ("/my-node", nodeNameFromLogFile("my-node.log"));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}